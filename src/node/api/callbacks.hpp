@@ -25,6 +25,8 @@ struct TransactionIds;
 }
 struct PrintNodeVersion {
 };
+struct AccountCacheStats;
+struct SyncPipelineStats;
 
 
 class Header;
@@ -58,6 +60,8 @@ using TxCb = std::function<void(const tl::expected<API::Transaction, int32_t>&)>
 using LatestTxsCb = std::function<void(const tl::expected<API::TransactionsByBlocks, int32_t>&)>;
 using TransactionMinfeeCb = std::function<void(const tl::expected<API::TransactionMinfee, int32_t>&)>;
 using BlockCb = std::function<void(const tl::expected<API::Block, int32_t>&)>;
+using AccountCacheStatsCb = std::function<void(const AccountCacheStats&)>;
+using SyncPipelineStatsCb = std::function<void(const SyncPipelineStats&)>;
 using HistoryCb = std::function<void(const tl::expected<API::AccountHistory, int32_t>&)>;
 using RichlistCb = std::function<void(const tl::expected<API::Richlist, int32_t>&)>;
 
@@ -176,6 +176,9 @@ void HTTPEndpoint::work()
 
     indexGenerator.section("Debug Endpoints");
     get("/debug/header_download", inspect_eventloop, jsonmsg::header_download, true);
+    get("/debug/block_download", inspect_eventloop, jsonmsg::block_download, true);
+    get("/debug/account_cache", get_account_cache_stats, true);
+    get("/debug/sync_pipeline", get_sync_pipeline_stats, true);
     app.ws<int>("/ws/chain_delta", {
                                        .open = [](auto* ws) {
                                            ws->subscribe(API::Block::WEBSOCKET_EVENT);
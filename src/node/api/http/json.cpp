@@ -6,9 +6,14 @@
 #include "chainserver/transaction_ids.hpp"
 #include "communication/mining_task.hpp"
 #include "crypto/crypto.hpp"
+#include "chainserver/state/transactions/block_pipeline.hpp"
+#include "db/account_state_cache.hpp"
+#include "eventloop/address_manager/address_manager_impl.hpp"
 #include "eventloop/eventloop.hpp"
+#include "eventloop/sync/block_download/block_download.hpp"
 #include "eventloop/sync/header_download/header_download.hpp"
 #include "eventloop/sync/sync.hpp"
+#include "eventloop/types/conref_impl.hpp"
 #include "general/errors.hpp"
 #include "general/hex.hpp"
 #include "general/is_testnet.hpp"
@@ -66,6 +71,36 @@ struct Inspector {
         }
         return j.dump(1);
     }
+    static auto block_download(const Eventloop& e)
+    {
+        auto& d { e.blockDownload };
+        json j;
+        j["active"] = d.initialized;
+        j["windowLength"] = d.focus.get_width();
+        j["config"] = json {
+            { "minWindowLength", d.minWindowLength },
+            { "maxWindowLength", d.MAXWINDOWLENGTH },
+            { "maxRequests", e.max_requests() }
+        };
+        json peers = json::array();
+        for (auto cr : e.connections.initialized()) {
+            auto& s { BlockDownload::data(cr).stats };
+            peers.push_back(json {
+                { "id", cr.id() },
+                { "endpoint", cr.str() },
+                { "measured", s.measured() },
+                { "latencyMillis", s.latency_millis() },
+                { "blocksPerSecond", s.blocks_per_second() },
+                { "bytesPerSecond", s.bytes_per_second() },
+                { "requestLength", s.request_length() },
+                { "pendingBlocks", s.pending_blocks() },
+                { "replies", s.replies_count() },
+                { "expired", s.expired_count() },
+                { "blocksReceived", s.blocks_received() } });
+        }
+        j["peers"] = peers;
+        return j.dump(1);
+    }
     static std::string endpoint_timers(const Eventloop& c)
     {
         auto now = steady_clock::now();
@@ -503,6 +538,11 @@ std::string serialize(const std::vector<API::Peerinfo>& connected)
             { "worksumHex", item.chainstate.descripted()->worksum().to_string() },
             { "grid", grid_json(item.chainstate.descripted()->grid()) }
         };
+        elem["send"] = json {
+            { "bytesQueued", item.sendStats.bytesQueued },
+            { "writeCalls", item.sendStats.writeCalls },
+            { "lowHeadroomMillis", item.sendStats.lowHeadroomMillis }
+        };
         j.push_back(elem);
     }
     return j.dump(1);
@@ -572,6 +612,42 @@ nlohmann::json to_json(const API::Round16Bit& e)
     };
 };
 
+nlohmann::json to_json(const AccountCacheStats& s)
+{
+    auto lookups { s.hits + s.misses };
+    return json {
+        { "size", s.size },
+        { "capacity", s.capacity },
+        { "hits", s.hits },
+        { "misses", s.misses },
+        { "hitRate", lookups == 0 ? 0.0 : double(s.hits) / double(lookups) }
+    };
+}
+
+nlohmann::json to_json(const SyncPipelineStats& s)
+{
+    auto rate { [](uint64_t n, uint64_t micros) { return micros == 0 ? 0.0 : double(n) * 1e6 / double(micros); } };
+    return json {
+        { "check", json {
+                       { "blocks", s.blocksChecked },
+                       { "micros", s.checkMicros },
+                       { "blocksPerSecond", rate(s.blocksChecked, s.checkMicros) } } },
+        { "prevalidate", json {
+                             { "chunks", s.chunks },
+                             { "signatures", s.signaturesPrevalidated },
+                             { "unresolved", s.signaturesUnresolved },
+                             { "queueDepth", s.queueDepth },
+                             { "maxQueueDepth", s.maxQueueDepth } } },
+        { "apply", json {
+                       { "blocks", s.blocksApplied },
+                       { "micros", s.applyMicros },
+                       { "stallMicros", s.stallMicros },
+                       { "blocksPerSecond", rate(s.blocksApplied, s.applyMicros) } } },
+        { "commit", json {
+                        { "micros", s.commitMicros } } }
+    };
+}
+
 nlohmann::json to_json(const PrintNodeVersion&)
 {
     return json {
@@ -615,6 +691,10 @@ std::string header_download(const Eventloop& e)
 {
     return Inspector::header_download(e);
 }
+std::string block_download(const Eventloop& e)
+{
+    return Inspector::block_download(e);
+}
 
 std::string ip_counter(const Conman& e)
 {
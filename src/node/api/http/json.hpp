@@ -33,6 +33,8 @@ nlohmann::json to_json(const std::optional<SignedSnapshot>&);
 nlohmann::json to_json(const chainserver::TransactionIds&);
 nlohmann::json to_json(const API::Round16Bit&);
 nlohmann::json to_json(const API::Rollback&);
+nlohmann::json to_json(const AccountCacheStats&);
+nlohmann::json to_json(const SyncPipelineStats&);
 
 template <typename T>
 inline nlohmann::json to_json(const std::vector<T>& e, const auto& map)
@@ -135,6 +137,7 @@ std::string serialize(const std::vector<API::Peerinfo>& banned);
 std::string endpoints(const Eventloop&);
 std::string connect_timers(const Eventloop&);
 std::string header_download(const Eventloop&);
+std::string block_download(const Eventloop&);
 std::string ip_counter(const Conman&);
 
 
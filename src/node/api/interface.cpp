@@ -3,6 +3,8 @@
 #include "asyncio/conman.hpp"
 #include "block/header/header_impl.hpp"
 #include "chainserver/server.hpp"
+#include "chainserver/state/transactions/block_pipeline.hpp"
+#include "db/account_state_cache.hpp"
 #include "eventloop/eventloop.hpp"
 #include "global/globals.hpp"
 
@@ -304,6 +306,16 @@ void get_account_richlist(RichlistCb f)
     global().pcs->api_get_richlist(f);
 }
 
+void get_account_cache_stats(AccountCacheStatsCb cb)
+{
+    cb(global().pcs->get_account_cache_stats());
+}
+
+void get_sync_pipeline_stats(SyncPipelineStatsCb cb)
+{
+    cb(global().pcs->get_sync_pipeline_stats());
+}
+
 void inspect_conman(std::function<void(const Conman& e)>&& cb)
 {
     global().pcm->async_inspect(std::move(cb));
@@ -59,6 +59,10 @@ void get_signed_snapshot(Eventloop::SignedSnapshotCb&& cb);
 // sync functions
 void get_headerdownload(HeaderdownloadCb f);
 
+// debug functions
+void get_account_cache_stats(AccountCacheStatsCb cb);
+void get_sync_pipeline_stats(SyncPipelineStatsCb cb);
+
 // account functions
 void get_account_balance(const API::AccountIdOrAddress& address, BalanceCb cb);
 void get_account_history(const Address& address, uint64_t end, HistoryCb cb);
@@ -1,7 +1,9 @@
 #include "stratum_server.hpp"
 
 #include "api/interface.hpp"
+#include "block/body/view.hpp"
 #include "block/header/header_impl.hpp"
+#include "general/is_testnet.hpp"
 #include "general/tcp_util.hpp"
 #include "nlohmann/json.hpp"
 #include <cassert>
@@ -39,11 +41,12 @@ namespace messages {
             , nonce(hex_to_arr<4>(params[3].get<std::string>()))
         {
         }
-        void apply_to(const std::array<uint8_t, 4>& extra2prefix, Block& b) const
+        void apply_to(const std::array<uint8_t, 4>& extra2prefix, Job& j) const
         {
+            auto& b { j.block };
             std::copy(extra2prefix.begin(), extra2prefix.end(), b.body.data().begin());
             std::copy(extranonce2.begin(), extranonce2.end(), b.body.data().begin() + 4);
-            b.header.set_merkleroot(b.body_view().merkle_root(b.height));
+            b.header.set_merkleroot(BodyView::seeded_merkle_root(j.merkleTop, b.body.data().data(), b.height));
             b.header.set_nonce(nonce);
             b.header.set_timestamp(ntime);
         }
@@ -71,16 +74,23 @@ namespace messages {
         uint32_t nbits;
         uint32_t ntime;
         bool clean { false };
-        MiningNotify(std::string jobId, const Block& b, bool clean)
+        MiningNotify(std::string jobId, const Job& j, bool clean)
             : jobId(std::move(jobId))
-            , prevHash { b.header.prevhash() }
-            , merklePrefix(b.body_view().merkle_prefix())
-            , version(b.header.version())
-            , nbits(hton32(b.header.target_v2().binary()))
-            , ntime(b.header.timestamp())
+            , prevHash { j.block.header.prevhash() }
+            , merklePrefix(merkle_prefix(j.merkleTop))
+            , version(j.block.header.version())
+            , nbits(hton32(j.block.header.target_v2().binary()))
+            , ntime(j.block.header.timestamp())
             , clean(clean)
         {
         }
+        static std::vector<uint8_t> merkle_prefix(const std::vector<Hash>& merkleTop)
+        {
+            std::vector<uint8_t> res;
+            for (auto& h : merkleTop)
+                res.insert(res.end(), h.begin(), h.end());
+            return res;
+        }
         std::string to_string()
         {
             return pool_null_message("mining.notify",
@@ -110,9 +120,9 @@ namespace messages {
 
     struct MiningSetDifficulty {
         double difficulty;
-        MiningSetDifficulty(const Block& b)
+        MiningSetDifficulty(double difficulty)
+            : difficulty(difficulty)
         {
-            difficulty = b.header.target_v2().difficulty();
         }
         std::string to_string()
         {
@@ -159,6 +169,8 @@ namespace messages {
         static StratumError BadAddress(int64_t id) { return { id, 30, "User format must be <Address>[.<Workername>]"s }; }
         static StratumError Unauthorized(int64_t id) { return { id, 24, "Unauthorized worker."s }; }
         static StratumError JobNotFound(int64_t id) { return { id, 21, "Job not found"s }; }
+        static StratumError Duplicate(int64_t id) { return { id, 22, "Duplicate share"s }; }
+        static StratumError LowDifficulty(int64_t id) { return { id, 23, "Low difficulty share"s }; }
     };
 
     OK SubscribeResponse(const std::array<uint8_t, 4>& extra2prefix, int64_t id)
@@ -201,8 +213,16 @@ namespace {
     }
 }
 
+Job::Job(Block b)
+    : block(std::move(b))
+    , merkleTop(block.body_view().merkle_top())
+{
+}
+
 Connection::Connection(std::shared_ptr<uvw::tcp_handle> newHandle, StratumServer& server)
     : extra2prefix(next_extra2prefix())
+    , vardiff(server.shareDifficulty, server.shareInterval, steady_clock::now())
+    , stats(steady_clock::now())
     , handle(std::move(newHandle))
     , server(server)
 {
@@ -223,6 +243,7 @@ void Connection::on_message(std::string_view msg)
 void Connection::on_append_result(int64_t stratumId, tl::expected<void, int32_t> result)
 {
     if (result.has_value()) {
+        stats.blocks += 1;
         write() << messages::OK(stratumId);
     } else {
         write() << messages::StratumError(stratumId, 40, Error(result.error()).strerror());
@@ -242,28 +263,82 @@ void Connection::handle_message(messages::MiningSubmit&& m)
         shutdown();
         return;
     }
-    auto b { server.get_block(authorized->address, m.jobId) };
-    if (!b) {
+    auto j { server.get_job(authorized->address, m.jobId) };
+    if (!j) {
         write() << StratumError::JobNotFound(m.id);
         return;
     }
-    m.apply_to(extra2prefix, *b);
-    put_chain_append({ *b },
-        [&, p = shared_from_this(), id = m.id](const tl::expected<void, int32_t>& res) {
-            server.on_append_result({ .p = p, .stratumId = id, .result { res } });
-        });
+    m.apply_to(extra2prefix, *j);
+    auto& b { j->block };
+    if (submitted.contains(b.header)) {
+        stats.rejected += 1;
+        write() << StratumError::Duplicate(m.id);
+        return;
+    }
+
+    // validate locally, only blocks go to the chain server
+    double difficulty { announcedDifficulty };
+    if (previous) {
+        if (previous->shares > 0 && steady_clock::now() < previous->until) {
+            difficulty = std::min(difficulty, previous->difficulty);
+            previous->shares -= 1;
+        } else
+            previous.reset();
+    }
+    auto result { check_share(b.header, b.height, difficulty) };
+    if (result == ShareResult::Low) {
+        stats.rejected += 1;
+        write() << StratumError::LowDifficulty(m.id);
+        return;
+    }
+    submitted.insert(b.header);
+    stats.accept(difficulty);
+    if (result == ShareResult::Block) {
+        put_chain_append({ std::move(b) },
+            [&, p = shared_from_this(), id = m.id](const tl::expected<void, int32_t>& res) {
+                server.on_append_result({ .p = p, .stratumId = id, .result { res } });
+            });
+    } else {
+        write() << OK(m.id);
+    }
+    if (vardiff.on_share(steady_clock::now()))
+        on_retarget();
 }
 
-void Connection::send_work(std::string jobId, const Block& block, bool clean)
+void Connection::send_work(std::string jobId, const Job& job, bool clean)
 {
-    write() << MiningSetDifficulty(block)
-            << MiningNotify(jobId, block, clean || fresh);
+    if (submitted.size() > 0 && submitted.begin()->prevhash() != job.block.header.prevhash())
+        submitted.clear();
+    if (vardiff.on_idle(steady_clock::now()))
+        spdlog::debug("Stratum worker {} retargeted to difficulty {} without shares", authorized ? authorized->worker : "", vardiff.difficulty());
+
+    // share difficulty is bounded by the block difficulty
+    auto blockDifficulty { job.block.header.target(job.block.height, is_testnet()).difficulty() };
+    const double difficulty { std::min(vardiff.difficulty(), blockDifficulty) };
+    if (!fresh && difficulty != announcedDifficulty)
+        previous = Grace { announcedDifficulty, steady_clock::now() + Grace::DURATION };
+    announcedDifficulty = difficulty;
+    lastJobId = jobId;
+    write() << MiningSetDifficulty(announcedDifficulty)
+            << MiningNotify(std::move(jobId), job, clean || fresh);
     fresh = false;
 }
 
+void Connection::on_retarget()
+{
+    auto now { steady_clock::now() };
+    spdlog::debug("Stratum worker {} retargeted to difficulty {}: {} shares accepted, {} rejected, {} blocks, {:.4g} H/s",
+        authorized->worker, vardiff.difficulty(), stats.accepted, stats.rejected, stats.blocks, stats.hashrate(now));
+    // announce the new difficulty with the latest job
+    if (auto j { server.find_job(authorized->address, lastJobId) })
+        send_work(lastJobId, *j, false);
+}
+
 Connection::~Connection()
 {
     if (authorized) {
+        spdlog::info("Stratum worker {} disconnected: {} shares accepted, {} rejected, {} blocks, {:.4g} H/s",
+            authorized->worker, stats.accepted, stats.rejected, stats.blocks, stats.hashrate(steady_clock::now()));
         server.unlink_authorized(authorized->address, this);
     }
 }
@@ -326,14 +401,13 @@ void StratumServer::handle_event(SubscriptionFeed&& fe)
 
     // register block
     auto jobId { serialize_hex(fe.t.block.header.hash()) };
-    Block* b { ad.add_block(jobId, std::move(fe.t.block)) };
-    if (b == nullptr)
+    auto* j { ad.add_job(jobId, std::move(fe.t.block)) };
+    if (j == nullptr)
         return;
-    const auto& block { *b };
 
     // dispatch block
     for (auto* c : ad.connections) {
-        c->send_work(jobId, block, ad.clean);
+        c->send_work(jobId, *j, ad.clean);
     }
 }
 
@@ -405,15 +479,17 @@ void StratumServer::acceptor(EndpointAddress endpointAddress)
     check_result(tcp->listen());
 }
 
-StratumServer::StratumServer(EndpointAddress endpointAddress)
-    : loop(uvw::loop::create())
+StratumServer::StratumServer(const Config::StratumPool& c)
+    : shareDifficulty(c.shareDifficulty)
+    , shareInterval(c.shareInterval)
+    , loop(uvw::loop::create())
     , async(loop->resource<uvw::async_handle>())
 {
-    spdlog::info("Starting Stratum server on {}", endpointAddress.to_string());
+    spdlog::info("Starting Stratum server on {}", c.bind.to_string());
     async->on<uvw::async_event>([&](uvw::async_event&, uvw::async_handle&) {
         handle_events();
     });
-    acceptor(endpointAddress);
+    acceptor(c.bind);
     t = std::thread([&]() { loop->run(); });
 }
 
@@ -430,36 +506,41 @@ void StratumServer::push(Event e)
     async->send();
 }
 
-Block* StratumServer::AddressData::find_block(const std::string& jobId)
+const stratum::Job* StratumServer::AddressData::find_job(const std::string& jobId)
 {
-    auto iter { blocks.find(jobId) };
-    if (iter == blocks.end())
+    auto iter { jobs.find(jobId) };
+    if (iter == jobs.end())
         return nullptr;
     return &iter->second;
 }
-Block* StratumServer::AddressData::add_block(const std::string& jobId, Block&& b)
+const stratum::Job* StratumServer::AddressData::add_job(const std::string& jobId, Block&& b)
 {
-    // delete old blocks when new block is available
-    if (!blocks.empty() && blocks.begin()->second.header.prevhash() != b.header.prevhash()) {
-        blocks.clear();
+    // delete old jobs when new block is available
+    if (!jobs.empty() && jobs.begin()->second.block.header.prevhash() != b.header.prevhash()) {
+        jobs.clear();
     }
-
-    auto [b_iter, inserted] { blocks.try_emplace(jobId, std::move(b)) };
-    if (!inserted)
+    if (jobs.contains(jobId))
         return nullptr;
-    return &b_iter->second;
+
+    auto [j_iter, inserted] { jobs.try_emplace(jobId, std::move(b)) };
+    return &j_iter->second;
 }
 
-std::optional<Block> StratumServer::get_block(Address a, std::string jobId)
+std::optional<stratum::Job> StratumServer::get_job(Address a, std::string jobId)
 {
-    auto iter = addressData.find(a);
-    assert(iter != addressData.end());
-    if (auto b { iter->second.find_block(jobId) }; b != nullptr) {
-        return *b;
+    if (auto j { find_job(a, jobId) }; j != nullptr) {
+        return *j;
     }
     return {};
 }
 
+const stratum::Job* StratumServer::find_job(const Address& a, const std::string& jobId)
+{
+    auto iter = addressData.find(a);
+    assert(iter != addressData.end());
+    return iter->second.find_job(jobId);
+}
+
 void StratumServer::shutdown()
 {
     push(ShutdownEvent {});
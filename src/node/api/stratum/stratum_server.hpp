@@ -2,6 +2,8 @@
 #include "api/types/all.hpp"
 #include "chainserver/mining_subscription.hpp"
 #include "communication/mining_task.hpp"
+#include "config/config.hpp"
+#include "vardiff.hpp"
 #include <list>
 #include <memory>
 #include <set>
@@ -23,6 +25,15 @@ namespace messages {
     struct MiningSubmit;
 }
 
+// A block handed out to miners. The topmost merkle nodes do not depend
+// on the extranonce in the body's seed bytes, so they are computed once
+// and a share only needs the final root hash.
+struct Job {
+    Job(Block);
+    Block block;
+    std::vector<Hash> merkleTop;
+};
+
 class Connection : public std::enable_shared_from_this<Connection> {
     struct Writer {
         Connection& c;
@@ -47,7 +58,8 @@ private:
     void handle_message(messages::MiningSubscribe&& s);
     void handle_message(messages::MiningSubmit&& m);
     void handle_message(messages::MiningAuthorize&& m);
-    void send_work(std::string jobId, const Block& block, bool clean);
+    void send_work(std::string jobId, const Job& job, bool clean);
+    void on_retarget();
     void shutdown();
     void write_line(const std::string& line);
     void process_line();
@@ -60,6 +72,24 @@ private:
     bool fresh { true };
     const std::array<uint8_t,4> extra2prefix;
     std::optional<Authorized> authorized;
+
+    // share difficulty
+    Vardiff vardiff;
+    ShareStats stats;
+    double announcedDifficulty { 0.0 };
+    // shares for the previous difficulty may still be in flight after a
+    // change, they are accepted for a short time or a few shares
+    struct Grace {
+        static constexpr std::chrono::seconds DURATION { 5 };
+        static constexpr size_t SHARES { 8 };
+        double difficulty;
+        steady_clock::time_point until;
+        size_t shares { SHARES };
+    };
+    std::optional<Grace> previous;
+    std::string lastJobId;
+    std::set<Header> submitted; // since the last new block, to detect duplicates
+
     std::string stratumLine;
     std::shared_ptr<uvw::tcp_handle> handle;
     StratumServer& server;
@@ -77,13 +107,13 @@ class StratumServer {
         AddressData(std::function<Subscription()>);
         void clear()
         {
-            blocks.clear();
+            jobs.clear();
             clean = true;
         }
-        Block* find_block(const std::string& jobId);
-        Block* add_block(const std::string& jobId, Block&& b);
+        const stratum::Job* find_job(const std::string& jobId);
+        const stratum::Job* add_job(const std::string& jobId, Block&& b);
         private:
-        std::map<std::string, Block> blocks;
+        std::map<std::string, stratum::Job> jobs;
     };
     struct SubscriptionFeed {
         Address address;
@@ -107,9 +137,10 @@ class StratumServer {
     void link_authorized(const Address&, stratum::Connection*);
     void unlink_authorized(const Address&, stratum::Connection*);
 
-    std::optional<Block> get_block(Address,std::string jobId);
+    std::optional<stratum::Job> get_job(Address,std::string jobId);
+    const stratum::Job* find_job(const Address&, const std::string& jobId);
 public:
-    StratumServer(EndpointAddress endpointAddress);
+    StratumServer(const Config::StratumPool&);
     ~StratumServer();
     void shutdown();
     void request_mining();
@@ -117,6 +148,8 @@ public:
     void on_append_result(AppendResult);
 
 private:
+    const double shareDifficulty;
+    const uint32_t shareInterval;
     std::map<Address, AddressData> addressData;
     std::list<std::shared_ptr<stratum::Connection>> connections;
     const std::shared_ptr<uvw::loop> loop;
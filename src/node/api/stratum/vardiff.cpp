@@ -0,0 +1,70 @@
+#include "vardiff.hpp"
+#include "block/header/difficulty.hpp"
+#include "block/header/header_impl.hpp"
+#include "general/is_testnet.hpp"
+#include <algorithm>
+
+namespace stratum {
+
+ShareResult check_share(const Header& h, NonzeroHeight height, double shareDifficulty)
+{
+    auto version { POWVersion::from_params(height, h.version(), is_testnet()) };
+    if (!version)
+        return ShareResult::Block; // let the chain server report the error
+    const HeaderView hv { h };
+    auto check { hv.validPOW_share(hv.hash(), *version, TargetV2(shareDifficulty)) };
+    if (check.block)
+        return ShareResult::Block;
+    return check.share ? ShareResult::Share : ShareResult::Low;
+}
+
+Vardiff::Vardiff(double difficulty, uint32_t interval, steady_clock::time_point now)
+    : current(std::max(difficulty, 1.0))
+    , interval(interval)
+    , windowStart(now)
+{
+}
+
+bool Vardiff::on_share(steady_clock::time_point now)
+{
+    windowShares += 1;
+    if (windowShares >= RETARGETSHARES || now - windowStart >= RETARGETINTERVALS * interval)
+        return retarget(now);
+    return false;
+}
+
+bool Vardiff::on_idle(steady_clock::time_point now)
+{
+    if (now - windowStart >= RETARGETINTERVALS * interval)
+        return retarget(now);
+    return false;
+}
+
+bool Vardiff::retarget(steady_clock::time_point now)
+{
+    using namespace std::chrono;
+    const double elapsed { std::max(duration<double>(now - windowStart).count(), 0.001) };
+    double factor { windowShares * duration<double>(interval).count() / elapsed };
+    const size_t shares { windowShares };
+    windowStart = now;
+    windowShares = 0;
+
+    // no shares: lower quickly, otherwise limit the step
+    factor = std::clamp(factor, 0.25, shares < RETARGETSHARES ? 4.0 : 16.0);
+    if (factor > 0.8 && factor < 1.25)
+        return false;
+    auto d { std::max(current * factor, 1.0) };
+    if (d == current)
+        return false;
+    current = d;
+    return true;
+}
+
+double ShareStats::hashrate(steady_clock::time_point now) const
+{
+    const double seconds { std::chrono::duration<double>(now - since).count() };
+    if (seconds <= 0)
+        return 0;
+    return work / seconds;
+}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "block/chain/height.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+class Header;
+namespace stratum {
+using steady_clock = std::chrono::steady_clock;
+
+enum class ShareResult {
+    Low, // does not meet the share target
+    Share, // meets the share target only
+    Block // meets the block target, must be forwarded to the chain server
+};
+
+// Checks a submitted header against the share difficulty on the stratum
+// thread. The share difficulty must not exceed the block difficulty.
+[[nodiscard]] ShareResult check_share(const Header&, NonzeroHeight, double shareDifficulty);
+
+// Share difficulty of a connection, retargeted such that shares arrive
+// about every `interval` seconds.
+class Vardiff {
+public:
+    static constexpr size_t RETARGETSHARES { 16 }; // retarget after this many shares
+    static constexpr uint32_t RETARGETINTERVALS { 6 }; // or after this many intervals
+    Vardiff(double difficulty, uint32_t interval, steady_clock::time_point now);
+
+    double difficulty() const { return current; }
+
+    // returns true if the difficulty changed
+    bool on_share(steady_clock::time_point now);
+    bool on_idle(steady_clock::time_point now); // lowers the difficulty if shares are overdue
+
+private:
+    bool retarget(steady_clock::time_point now);
+    double current;
+    const std::chrono::seconds interval;
+    steady_clock::time_point windowStart;
+    size_t windowShares { 0 };
+};
+
+struct ShareStats {
+    ShareStats(steady_clock::time_point since)
+        : since(since)
+    {
+    }
+    void accept(double difficulty)
+    {
+        accepted += 1;
+        work += difficulty;
+    }
+    // expected hashes per second, a share of difficulty d takes d hashes on average
+    double hashrate(steady_clock::time_point now) const;
+
+    size_t accepted { 0 };
+    size_t rejected { 0 };
+    size_t blocks { 0 };
+    double work { 0.0 }; // sum of accepted share difficulties
+    steady_clock::time_point since;
+};
+}
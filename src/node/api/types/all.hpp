@@ -1,6 +1,7 @@
 #pragma once
 
 #include "accountid_or_address.hpp"
+#include "asyncio/send_stats.hpp"
 #include "block/body/primitives.hpp"
 #include "block/chain/history/index.hpp"
 #include "block/chain/signed_snapshot.hpp"
@@ -159,6 +160,7 @@ struct Peerinfo {
     SignedSnapshot::Priority theirSnapshotPriority;
     SignedSnapshot::Priority acknowledgedSnapshotPriority;
     uint32_t since;
+    SendStats sendStats;
 };
 
 struct Network {
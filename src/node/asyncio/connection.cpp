@@ -12,8 +12,9 @@ void Connection::write_cb(int status)
 {
     {
         std::unique_lock<std::mutex> lock(mutex);
-        bufferedbytes -= buffers.front().buf.len;
-        buffers.erase(buffers.begin());
+        bufferedbytes -= writing.front().bytes;
+        writing.pop_front();
+        update_headroom();
     }
     if (state != State::CONNECTED && state != State::HANDSHAKE)
         return;
@@ -51,6 +52,7 @@ void Connection::read_cb(ssize_t nread, const uv_buf_t* /*buf*/)
                     assert(hb.pos == 24);
                     assert(handshakedata->handshakesent == false);
                     peerVersion = hb.version(inbound);
+                    peerFeatures = hb.features();
                     if (!peerVersion.initialized()) {
                         close(EHANDSHAKE);
                         return;
@@ -69,6 +71,7 @@ void Connection::read_cb(ssize_t nread, const uv_buf_t* /*buf*/)
         } else {
             if (hb.pos == hb.size(inbound)) {
                 peerVersion = hb.version(inbound);
+                peerFeatures = hb.features();
                 if (!peerVersion.initialized()) {
                     close(EHANDSHAKE);
                     return;
@@ -100,19 +103,25 @@ void Connection::read_cb(ssize_t nread, const uv_buf_t* /*buf*/)
             return;
         }
     }
-    if (stagebuffer.body.bytes.size() != 0 && stagebuffer.pos == 8 + stagebuffer.body.bytes.size()) {
-        if (stagebuffer.finished()) {
-            spdlog::debug("Received complete message");
-
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-                readbuffers.push_back(std::move(stagebuffer));
-                stagebuffer.pos = 0;
-            }
-            eventloop_notify();
-        } else {
-            stagebuffer.realloc();
+    if (stagebuffer.full() && !stagebuffer.finished())
+        stagebuffer.grow();
+    if (stagebuffer.finished()) {
+        spdlog::debug("Received complete message");
+        // verify and parse here to keep this work off the eventloop thread
+        if (!stagebuffer.verify()) {
+            close(ECHECKSUM);
+            return;
+        }
+        try {
+            auto m { stagebuffer.parse() };
+            std::unique_lock<std::mutex> lock(mutex);
+            readmessages.push_back(std::move(m));
+        } catch (Error e) {
+            close(e.e);
+            return;
         }
+        stagebuffer.clear();
+        eventloop_notify();
     }
 }
 void Connection::alloc_cb(size_t /*suggested_size*/, uv_buf_t* buf)
@@ -155,7 +164,6 @@ Connection::Connection(Conman& conman, bool inbound, std::optional<uint32_t> rec
     , connected_since(now_timestamp())
     , conman(conman)
     , handshakedata(new Handshakedata())
-    , buffercursor(buffers.end())
 {
     if (idcounter == 0)
         idcounter = 1; // id shall never be 0
@@ -188,7 +196,8 @@ void Connection::send_handshake()
     }
     uint32_t nver{hton32(NodeVersion::our_version().to_uint32())};
     memcpy(data + 14, &nver, 4);
-    memset(data + 18, 0, 4);
+    uint32_t features { hton32(our_features()) };
+    memcpy(data + 18, &features, 4);
     if (!inbound) {
         uint16_t portBe = hton16(conman.bindAddress.port);
         memcpy(data + 22, &portBe, 2);
@@ -209,19 +218,58 @@ int Connection::send_buffers()
 {
     std::unique_lock<std::mutex> lock(mutex);
     assert(tcp);
-    while (buffercursor != buffers.end()) {
-        buffercursor->write_t.data = this;
-        if (int r = uv_write(&buffercursor->write_t, tcp->to_stream_ptr(),
-                &buffercursor->buf, 1, [](uv_write_t* req, int status) {
-                    Connection& con = (*reinterpret_cast<Connection*>(req->data));
-                    con.write_cb(status);
-                }))
-            return r;
-        ++buffercursor;
+    if (queued.empty())
+        return 0;
+    auto& req { writing.emplace_back() };
+    std::vector<uv_buf_t> bufs;
+    bufs.reserve(queued.size());
+    req.data.reserve(queued.size());
+    for (auto& b : queued) {
+        bufs.push_back(uv_buf_init(b.data.get(), b.len));
+        req.bytes += b.len;
+        req.data.push_back(std::move(b.data));
+    }
+    queued.clear();
+    req.write_t.data = this;
+    if (int r = uv_write(&req.write_t, tcp->to_stream_ptr(),
+            bufs.data(), bufs.size(), [](uv_write_t* req, int status) {
+                Connection& con = (*reinterpret_cast<Connection*>(req->data));
+                con.write_cb(status);
+            })) {
+        bufferedbytes -= req.bytes;
+        writing.pop_back();
+        update_headroom();
+        return r;
     }
+    sendStats.writeCalls += 1;
     return 0;
 }
 
+void Connection::update_headroom()
+{
+    using namespace std::chrono;
+    const bool low { bufferedbytes > MAXBUFFER / 2 };
+    if (low == lowHeadroomSince.has_value())
+        return;
+    auto now { steady_clock::now() };
+    if (low) {
+        lowHeadroomSince = now;
+    } else {
+        sendStats.lowHeadroomMillis += duration_cast<milliseconds>(now - *lowHeadroomSince).count();
+        lowHeadroomSince.reset();
+    }
+}
+
+SendStats Connection::send_stats()
+{
+    using namespace std::chrono;
+    std::unique_lock<std::mutex> lock(mutex);
+    auto s { sendStats };
+    if (lowHeadroomSince)
+        s.lowHeadroomMillis += duration_cast<milliseconds>(steady_clock::now() - *lowHeadroomSince).count();
+    return s;
+}
+
 int Connection::accept()
 {
     int i;
@@ -329,10 +377,10 @@ void Connection::close(int errcode)
     std::unique_lock<std::mutex> lock(mutex);
 
     // delete unsent buffers
-    while (buffercursor != buffers.end()) {
-        bufferedbytes -= buffercursor->buf.len;
-        buffers.erase(buffercursor++);
-    }
+    for (auto& b : queued)
+        bufferedbytes -= b.len;
+    queued.clear();
+    update_headroom();
 
     if (tcp)
         uv_close(tcp->to_handle_ptr(), [](uv_handle_t* handle) {
@@ -348,11 +396,11 @@ void Connection::close(int errcode)
 //////////////////////////////
 
 // CALLED BY OTHER THREAD
-std::vector<Rcvbuffer> Connection::extractMessages()
+std::vector<messages::Msg> Connection::extractMessages()
 {
     std::unique_lock<std::mutex> lock(mutex);
-    std::vector<Rcvbuffer> tmp;
-    tmp.swap(readbuffers);
+    std::vector<messages::Msg> tmp;
+    tmp.swap(readmessages);
     return tmp;
 }
 
@@ -362,15 +410,15 @@ std::string Connection::to_string() const
 }
 
 // CALLED BY OTHER THREAD
-void Connection::async_send(std::unique_ptr<char[]> data, size_t size)
+void Connection::async_send(std::shared_ptr<char[]> data, size_t size)
 {
     std::unique_lock<std::mutex> lock(mutex);
     if (state == State::CLOSING)
         return;
-    buffers.emplace_back(std::move(data), size);
+    queued.push_back({ std::move(data), uint32_t(size) });
     bufferedbytes += size;
-    if (buffercursor == buffers.end())
-        --buffercursor;
+    sendStats.bytesQueued += size;
+    update_headroom();
     if (bufferedbytes >= MAXBUFFER) {
         async_close(EBUFFERFULL);
     }
@@ -383,6 +431,11 @@ void Connection::asyncsend(Sndbuffer&& msg)
     async_send(std::move(msg.ptr), msg.fullsize());
 }
 
+void Connection::asyncsend(const SharedSndbuffer& msg)
+{
+    async_send(msg.data(), msg.fullsize());
+}
+
 void Connection::async_close(int32_t errcode) { conman.async_close(shared_from_this(), errcode); }
 
 void Connection::eventloop_notify()
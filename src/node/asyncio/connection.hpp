@@ -3,6 +3,7 @@
 #include "communication/buffers/recvbuffer.hpp"
 #include "communication/buffers/sndbuffer.hpp"
 #include "conman.hpp"
+#include "send_stats.hpp"
 #include "eventloop/types/conref_declaration.hpp"
 
 class Connection final : public std::enable_shared_from_this<Connection> {
@@ -87,14 +88,14 @@ private:
     // Conman using delete It must be created with new
     friend class Conman;
     struct Writebuffer {
+        std::shared_ptr<char[]> data; // possibly shared with other connections
+        uint32_t len;
+    };
+    // queued buffers are coalesced into a single uv_write
+    struct WriteRequest {
         uv_write_t write_t;
-        uv_buf_t buf;
-        Writebuffer(std::unique_ptr<char[]>&& data, size_t size)
-        {
-            buf.len = size;
-            buf.base = data.release();
-        }
-        ~Writebuffer() { delete[] buf.base; }
+        std::vector<std::shared_ptr<char[]>> data;
+        size_t bytes { 0 };
     };
     struct Handshakedata {
         std::array<uint8_t, 25> recvbuf; // 14 bytes for "WARTHOG GRUNT!" and 4
@@ -111,6 +112,7 @@ private:
         uint8_t pos = 0;
         bool handshakesent = false;
         NodeVersion version(bool inbound);
+        uint32_t features() const { return readuint32(recvbuf.data() + 18); }
         uint16_t port(bool inbound)
         {
             assert(inbound);
@@ -138,19 +140,29 @@ private:
 
     //////////////////////////////
     // mutex protected methods
-    void async_send(std::unique_ptr<char[]> data, size_t size);
+    void async_send(std::shared_ptr<char[]> data, size_t size);
 
 public:
+    // feature bits exchanged in the 4 reserved handshake bytes after the
+    // version, older nodes send zeros
+    static constexpr uint32_t FEATURE_COMPACTBATCH = 1;
+    static constexpr uint32_t FEATURE_COMPACTBLOCK = 2;
+    static constexpr uint32_t FEATURE_TXRECON = 4;
+    static constexpr uint32_t our_features() { return FEATURE_COMPACTBATCH | FEATURE_COMPACTBLOCK | FEATURE_TXRECON; }
+
     enum class State { CONNECTING,
         HANDSHAKE,
         CONNECTED,
         CLOSING,
     };
-    std::vector<Rcvbuffer> extractMessages();
+    std::vector<messages::Msg> extractMessages();
     void asyncsend(Sndbuffer&& msg);
+    void asyncsend(const SharedSndbuffer& msg);
     void async_close(int errcode);
     [[nodiscard]] EndpointAddress peer_address() { return peerAddress; }
     [[nodiscard]] NodeVersion peer_version() const { return peerVersion; }
+    [[nodiscard]] bool peer_supports(uint32_t feature) const { return (peerFeatures & feature) != 0; }
+    [[nodiscard]] SendStats send_stats();
     [[nodiscard]] EndpointAddress peer_endpoint() { return EndpointAddress { peerAddress.ipv4, peerEndpointPort }; }
 
     Connection(Conman& conman, bool inbound, std::optional<uint32_t> reconnectSeconds = {});
@@ -164,6 +176,7 @@ private:
     void send_handshake();
     void send_handshake_ack();
     int send_buffers();
+    void update_headroom(); // requires mutex
 
     //////////////////////////////
     // Connection initialization
@@ -195,6 +208,7 @@ private:
     Rcvbuffer stagebuffer;
     std::unique_ptr<Handshakedata> handshakedata;
     NodeVersion peerVersion;
+    uint32_t peerFeatures { 0 };
     int64_t logrow = -1;
     State state = State::CONNECTING;
     EndpointAddress peerAddress;
@@ -205,9 +219,11 @@ private:
     //////////////////////////////
     // Mutex locked members
     std::mutex mutex;
-    std::list<Writebuffer> buffers; // FIFO queue
+    std::vector<Writebuffer> queued; // not yet passed to libuv
+    std::list<WriteRequest> writing; // FIFO queue of pending writes
     std::set<EndpointAddress> reconnect;
     uint32_t bufferedbytes = 0;
-    std::list<Writebuffer>::iterator buffercursor;
-    std::vector<Rcvbuffer> readbuffers;
+    SendStats sendStats;
+    std::optional<std::chrono::steady_clock::time_point> lowHeadroomSince;
+    std::vector<messages::Msg> readmessages; // verified and parsed
 };
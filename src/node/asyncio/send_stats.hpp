@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+
+// Counters of a connection's send path
+struct SendStats {
+    uint64_t bytesQueued { 0 };
+    uint64_t writeCalls { 0 }; // uv_write calls, each is one writev unless the socket is congested
+    uint64_t lowHeadroomMillis { 0 }; // time spent with more than half of MAXBUFFER queued
+};
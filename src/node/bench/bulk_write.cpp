@@ -0,0 +1,147 @@
+// Measures how many full blocks per second BlockApplier applies with
+// each of the ChainDB bulk write strategies: per-row statements,
+// multi-row VALUES statements and json_each() batches. Synthetic testnet
+// blocks of about 35 KB pay to new accounts and transfer between
+// existing accounts. Signatures are not checked (the blocks are below
+// the assume-valid height) such that the database writes dominate.
+// Every block is applied and committed in its own transaction.
+#include "api/types/all.hpp"
+#include "block/block.hpp"
+#include "block/body/view.hpp"
+#include "block/chain/header_chain.hpp"
+#include "block/header/generator.hpp"
+#include "block/header/header_impl.hpp"
+#include "chainserver/state/transactions/block_applier.hpp"
+#include "crypto/hasher_sha256.hpp"
+#include "db/chain_db.hpp"
+#include "general/is_testnet.hpp"
+#include "general/params.hpp"
+#include "general/worker_pool.hpp"
+#include "general/writer.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+namespace {
+constexpr size_t ACCOUNTS = 10000; // existing before the first block
+constexpr size_t NEWACCOUNTS = 10; // per block
+constexpr size_t TRANSFERS = (MAXBLOCKSIZE - 10 - 2 - 16 - 4 - NEWACCOUNTS * 20) / 99;
+constexpr uint32_t WARMUP = 50;
+constexpr uint32_t BLOCKS = 300;
+using BulkWrites = ChainDB::BulkWrites;
+using namespace chainserver;
+
+Address address(uint64_t i)
+{
+    Hash h { HasherSHA256() << i };
+    Address a;
+    memcpy(a.data(), h.data(), a.size());
+    return a;
+}
+
+struct Fixture {
+    Fixture(const std::filesystem::path& path, BulkWrites bulkWrites)
+        : db(path.string())
+    {
+        db.set_bulk_writes(bulkWrites);
+        {
+            std::vector<std::tuple<AddressView, Funds, AccountId>> entries;
+            std::vector<Address> addresses;
+            addresses.reserve(ACCOUNTS);
+            for (size_t i = 0; i < ACCOUNTS; ++i)
+                entries.push_back({ addresses.emplace_back(address(i)), Funds::from_value(100000000000).value(), db.next_state_id() + i });
+            auto t { db.transaction() };
+            db.insert_state_entries(entries);
+            t.commit();
+        }
+
+        // headers only link, bodies are not committed to by merkle roots
+        Batch headers;
+        std::vector<Hash> hashes { Hash::genesis() };
+        for (uint32_t i = 1; i <= WARMUP + BLOCKS; ++i) {
+            Hash merkleroot { HasherSHA256() << uint64_t(i) };
+            HeaderGenerator hg(hashes.back(), merkleroot, TargetV2(1.0), 1700000000 + 20 * i, NonzeroHeight(i));
+            auto header { hg.serialize(0) };
+            headers.append(header);
+            hashes.push_back(header.hash());
+        }
+        stage = Headerchain(HeaderchainSkeleton({}, headers));
+
+        std::mt19937_64 rng { 42 };
+        uint64_t nAccounts { ACCOUNTS };
+        auto t { db.transaction() };
+        for (uint32_t i = 1; i <= WARMUP + BLOCKS; ++i) {
+            const NonzeroHeight h { i };
+            const PinHeight pinHeight { PinFloor(PrevHeight(h)) };
+            std::vector<uint8_t> body(10 + 2 + NEWACCOUNTS * 20 + 16 + 4 + 99 * TRANSFERS);
+            Writer w(body.data(), body.size());
+            w.skip(10);
+            w << uint16_t(NEWACCOUNTS);
+            for (size_t j = 0; j < NEWACCOUNTS; ++j)
+                w << address(nAccounts + j);
+            w << AccountId(1) << h.reward().E8() << uint32_t(TRANSFERS);
+            for (size_t j = 0; j < TRANSFERS; ++j) {
+                // the first transfers fund the new accounts
+                AccountId from { rng() % ACCOUNTS + 1 };
+                AccountId to { j < NEWACCOUNTS ? nAccounts + j + 1 : rng() % nAccounts + 1 };
+                if (to == from)
+                    to = AccountId(from.value() % ACCOUNTS + 1);
+                auto pn { PinNonce::make_pin_nonce(NonceId(uint32_t(i * TRANSFERS + j)), h, pinHeight).value() };
+                auto fee { CompactUInt::compact(Funds::from_value(1000).value()) };
+                auto amount { Funds::from_value(rng() % 1000000 + 1).value() };
+                w << from << pn << fee << to << amount;
+                w.skip(65); // signature
+            }
+            assert(w.remaining() == 0);
+            nAccounts += NEWACCOUNTS;
+            db.insert_protect({ .height = h, .header = headers[i - 1], .body = BodyContainer(std::move(body)) });
+        }
+        t.commit();
+    }
+    ChainDB db;
+    Headerchain stage;
+};
+
+double run(const std::string& name, BulkWrites bulkWrites, WorkerPool& pool)
+{
+    auto dir { std::filesystem::temp_directory_path() / ("warthog-bench-bulk-write-" + name) };
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    double blocksPerSecond;
+    {
+        Fixture f(dir / "chain.db3", bulkWrites);
+        std::set<TransactionId, ByPinHeight> baseTxIds;
+        BlockApplier ba { f.db, f.stage, baseTxIds, pool, false, Height(WARMUP + BLOCKS) };
+        using namespace std::chrono;
+        duration<double> elapsed { 0 };
+        for (uint32_t i = 1; i <= WARMUP + BLOCKS; ++i) {
+            const NonzeroHeight h { i };
+            auto [blockId, b] { f.db.get_block(f.stage.hash_at(h)).value() };
+            auto start { steady_clock::now() };
+            auto t { f.db.transaction() };
+            (void)ba.apply_block(b.body_view(), b.header, h, blockId);
+            t.commit();
+            if (i > WARMUP)
+                elapsed += steady_clock::now() - start;
+        }
+        blocksPerSecond = BLOCKS / elapsed.count();
+    }
+    std::filesystem::remove_all(dir);
+    std::cout << name << ": " << blocksPerSecond << " blocks/s" << std::endl;
+    return blocksPerSecond;
+}
+}
+
+int main()
+{
+    enable_testnet();
+    WorkerPool pool;
+    std::cout << "Applying " << BLOCKS << " synthetic blocks with " << TRANSFERS
+              << " transfers and " << NEWACCOUNTS << " new accounts each" << std::endl;
+    auto rows { run("per-row", BulkWrites::PerRow, pool) };
+    auto multi { run("multi-row", BulkWrites::MultiRow, pool) };
+    auto json { run("json_each", BulkWrites::JsonEach, pool) };
+    std::cout << "speedup multi-row: " << multi / rows << "x, json_each: " << json / rows << "x" << std::endl;
+}
@@ -0,0 +1,167 @@
+// Measures insert/evict churn of the mempool transaction index at a
+// steady size of 100k entries. The multi-index Txmap is compared to the
+// previous layout, a std::map with std::set indices by pin and by hash
+// and a sorted vector ordered by fee. Both must evict and order the
+// same transactions.
+#include "crypto/crypto.hpp"
+#include "crypto/hasher_sha256.hpp"
+#include "mempool/txmap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+
+namespace {
+using namespace mempool;
+constexpr size_t SIZE = 100000;
+constexpr size_t CHURN = 300000; // inserts at full size, each evicts one
+constexpr uint32_t PINSTEP = 32;
+constexpr size_t PINEVERY = 150000; // inserts per pin height advance
+
+class Generator {
+public:
+    Generator(const RecoverableSignature& signature)
+        : signature(signature)
+    {
+    }
+    Entry next()
+    {
+        n += 1;
+        if (n % PINEVERY == 0)
+            pin += PINSTEP;
+        TransactionId txid { AccountId(rng() % 20000), PinHeight(Height(pin + PINSTEP * (rng() % 4))), NonceId(uint32_t(n)) };
+        auto fee { CompactUInt::compact(Funds::from_value(rng() % 100000000).value()) };
+        Hash h { HasherSHA256() << n };
+        return { txid, EntryValue { std::array<uint8_t, 3> {}, fee, Address(std::array<uint8_t, 20> {}),
+                           Funds::zero(), signature, h, Height(pin) } };
+    }
+    uint32_t pin_floor() const { return pin; }
+
+private:
+    std::mt19937_64 rng { 42 };
+    RecoverableSignature signature;
+    uint64_t n { 0 };
+    uint32_t pin { PINSTEP };
+};
+
+// index layout before Txmap
+class Legacy {
+    using map_t = std::map<TransactionId, EntryValue>;
+    using iter_t = map_t::const_iterator;
+    struct ByPin {
+        using is_transparent = std::true_type;
+        bool operator()(iter_t i1, Height h2) const { return i1->first.pinHeight < h2; }
+        bool operator()(iter_t i1, iter_t i2) const
+        {
+            if (i1->first.pinHeight == i2->first.pinHeight)
+                return i1->first < i2->first;
+            return i1->first.pinHeight < i2->first.pinHeight;
+        }
+    };
+    struct ByHash {
+        bool operator()(iter_t i1, iter_t i2) const { return i1->second.hash < i2->second.hash; }
+    };
+
+public:
+    void insert(const Entry& e)
+    {
+        iter_t iter { map.emplace(e).first };
+        byPin.insert(iter);
+        byHash.insert(iter);
+        byFee.insert(std::lower_bound(byFee.begin(), byFee.end(), iter, [](iter_t i1, iter_t i2) {
+            return i1->second.fee > i2->second.fee;
+        }),
+            iter);
+    }
+    void erase_smallest() { erase(byFee.back()); }
+    void erase_before(Height h)
+    {
+        auto end { byPin.lower_bound(h) };
+        for (auto iter { byPin.begin() }; iter != end;)
+            erase(*(iter++));
+    }
+    size_t size() const { return map.size(); }
+    std::vector<TransactionId> order() const
+    {
+        std::vector<TransactionId> out;
+        for (auto iter : byFee)
+            out.push_back(iter->first);
+        return out;
+    }
+
+private:
+    void erase(iter_t iter)
+    {
+        byPin.erase(iter);
+        byHash.erase(iter);
+        std::erase(byFee, iter);
+        map.erase(iter);
+    }
+    map_t map;
+    std::set<iter_t, ByPin> byPin;
+    std::set<iter_t, ByHash> byHash;
+    std::vector<iter_t> byFee;
+};
+
+class Multi {
+public:
+    void insert(const Entry& e) { txs.insert(e); }
+    void erase_smallest() { txs.erase(txs.smallest()); }
+    void erase_before(Height h)
+    {
+        for (auto s : txs.pinned_before(h))
+            txs.erase(s);
+    }
+    size_t size() const { return txs.size(); }
+    std::vector<TransactionId> order() const
+    {
+        std::vector<TransactionId> out;
+        for (auto s : txs.by_fee())
+            out.push_back(txs[s].first);
+        return out;
+    }
+
+private:
+    Txmap txs;
+};
+
+template <typename Index>
+std::vector<TransactionId> run(const std::string& name, const RecoverableSignature& signature)
+{
+    Generator g(signature);
+    Index index;
+    for (size_t i = 0; i < SIZE; ++i)
+        index.insert(g.next());
+    auto start { std::chrono::steady_clock::now() };
+    uint32_t pinFloor { g.pin_floor() };
+    for (size_t i = 0; i < CHURN; ++i) {
+        index.insert(g.next());
+        if (g.pin_floor() != pinFloor) {
+            pinFloor = g.pin_floor();
+            index.erase_before(Height(pinFloor));
+        }
+        while (index.size() > SIZE)
+            index.erase_smallest();
+    }
+    std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+    std::cout << name << ": " << CHURN / elapsed.count() << " inserts/s, "
+              << index.size() << " entries" << std::endl;
+    return index.order();
+}
+}
+
+int main()
+{
+    ECC_Start();
+    Hash h { HasherSHA256() << uint64_t(0) };
+    auto signature { PrivKey().sign(h) };
+    std::cout << "Churning " << CHURN << " transactions through a mempool of " << SIZE << std::endl;
+    auto legacy { run<Legacy>("map and sets", signature) };
+    auto multi { run<Multi>("multi-index", signature) };
+    ECC_Stop();
+    if (legacy != multi) {
+        std::cout << "fee order differs" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,66 @@
+// Measures how many stratum shares per second the stratum thread can
+// validate locally. Headers with random nonces are checked against a
+// share difficulty where nearly every header is a share and against a
+// share difficulty where nearly every header is rejected, both cost one
+// hash computation. The vardiff retargeting is simulated for a
+// miner with fixed hashrate to see where the share difficulty settles.
+#include "api/stratum/vardiff.hpp"
+#include "block/header/generator.hpp"
+#include "block/header/header_impl.hpp"
+#include "crypto/hasher_sha256.hpp"
+#include "general/params.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+constexpr size_t SHARES = 20000;
+constexpr double BLOCKDIFFICULTY = 1e12;
+constexpr double HASHRATE = 1e6; // simulated miner
+constexpr uint32_t INTERVAL = 10;
+using namespace stratum;
+
+void validate(double shareDifficulty)
+{
+    const NonzeroHeight height { Height(JANUSV8BLOCKV3START + 1000).nonzero_assert() };
+    Hash prev { HasherSHA256() << uint64_t(1) };
+    Hash merkleroot { HasherSHA256() << uint64_t(2) };
+    HeaderGenerator hg(prev, merkleroot, TargetV2(BLOCKDIFFICULTY), 1700000000, height);
+    std::mt19937 rng { 42 };
+    size_t counts[3] {};
+    auto start { std::chrono::steady_clock::now() };
+    for (size_t i = 0; i < SHARES; ++i) {
+        auto r { check_share(hg.serialize(rng()), height, shareDifficulty) };
+        counts[size_t(r)] += 1;
+    }
+    std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+    std::cout << "share difficulty " << shareDifficulty << ": " << SHARES / elapsed.count()
+              << " shares/s validated, " << counts[size_t(ShareResult::Low)] << " low, "
+              << counts[size_t(ShareResult::Share)] << " shares, "
+              << counts[size_t(ShareResult::Block)] << " blocks" << std::endl;
+}
+
+void simulate_vardiff()
+{
+    std::mt19937_64 rng { 42 };
+    auto t { steady_clock::time_point {} };
+    Vardiff v(10000, INTERVAL, t);
+    const auto end { t + std::chrono::hours(2) };
+    size_t retargets { 0 };
+    while (t < end) {
+        // shares arrive at rate hashrate / difficulty
+        std::exponential_distribution<double> wait(HASHRATE / v.difficulty());
+        t += std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(wait(rng)));
+        retargets += v.on_share(t);
+    }
+    std::cout << "vardiff settled at " << v.difficulty() << " after " << retargets << " retargets, aiming at "
+              << HASHRATE * INTERVAL << std::endl;
+}
+}
+
+int main()
+{
+    validate(1.0);
+    validate(1e6);
+    simulate_vardiff();
+}
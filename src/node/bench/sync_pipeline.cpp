@@ -0,0 +1,175 @@
+// Measures how many blocks per second the sequential block application
+// can process when transfer signatures are recovered per block, like
+// before, and when BlockPipeline recovers them chunk-wise ahead of
+// application. Synthetic testnet blocks with signed transfers between
+// existing accounts are stored in a temporary chain database and loaded
+// from there in both runs. Application itself is simulated by hashing a
+// block sized buffer.
+#include "block/block.hpp"
+#include "block/body/parse.hpp"
+#include "block/body/view.hpp"
+#include "block/chain/header_chain.hpp"
+#include "block/chain/history/history.hpp"
+#include "block/header/generator.hpp"
+#include "block/header/header_impl.hpp"
+#include "chainserver/state/transactions/block_pipeline.hpp"
+#include "crypto/crypto.hpp"
+#include "crypto/hasher_sha256.hpp"
+#include "db/chain_db.hpp"
+#include "general/is_testnet.hpp"
+#include "general/worker_pool.hpp"
+#include "general/writer.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+namespace {
+constexpr uint32_t BLOCKS = 1024; // fits into one incomplete header batch
+constexpr size_t TRANSFERS = 8; // per block
+constexpr size_t ACCOUNTS = 16;
+constexpr size_t APPLYBYTES = 16 * 1024; // hashed per simulated block application
+using namespace chainserver;
+
+struct Fixture {
+    Fixture(const std::filesystem::path& path)
+        : db(path.string())
+    {
+        std::mt19937_64 rng { 42 };
+        std::vector<PrivKey> keys(ACCOUNTS);
+        std::vector<AccountId> ids;
+        std::vector<Address> addresses;
+        {
+            auto t { db.transaction() };
+            for (auto& k : keys) {
+                auto& a { addresses.emplace_back(k.pubkey().address()) };
+                auto id { ids.emplace_back(db.next_state_id()) };
+                db.insertStateEntry(a, Funds::from_value(100000000000).value(), id);
+            }
+            t.commit();
+        }
+
+        // headers only link, bodies are not committed to by merkle roots
+        Batch headers;
+        std::vector<Hash> hashes { Hash::genesis() };
+        for (uint32_t i = 1; i <= BLOCKS; ++i) {
+            Hash merkleroot { HasherSHA256() << uint64_t(i) };
+            HeaderGenerator hg(hashes.back(), merkleroot, TargetV2(1.0), 1700000000 + 20 * i, NonzeroHeight(i));
+            auto header { hg.serialize(0) };
+            headers.append(header);
+            hashes.push_back(header.hash());
+        }
+        stage = Headerchain(HeaderchainSkeleton({}, headers));
+
+        auto t { db.transaction() };
+        for (uint32_t i = 1; i <= BLOCKS; ++i) {
+            const NonzeroHeight h { i };
+            const PinHeight pinHeight { PinFloor(PrevHeight(h)) };
+            std::vector<uint8_t> body(10 + 2 + 16 + 4 + 99 * TRANSFERS);
+            Writer w(body.data(), body.size());
+            w.skip(10);
+            w << uint16_t(0) << ids[0] << h.reward().E8() << uint32_t(TRANSFERS);
+            for (size_t j = 0; j < TRANSFERS; ++j) {
+                size_t from { rng() % ACCOUNTS }, to { (from + 1 + rng() % (ACCOUNTS - 1)) % ACCOUNTS };
+                auto pn { PinNonce::make_pin_nonce(NonceId(uint32_t(i * TRANSFERS + j)), h, pinHeight).value() };
+                auto fee { CompactUInt::compact(Funds::from_value(1000).value()) };
+                auto amount { Funds::from_value(rng() % 1000000).value() };
+                Hash txhash { HasherSHA256() << hashes[pinHeight.value()] << pinHeight << pn.id
+                                             << pn.reserved << fee.uncompact() << addresses[to] << amount };
+                w << ids[from] << pn << fee << ids[to] << amount << keys[from].sign(txhash);
+            }
+            assert(w.remaining() == 0);
+            db.insert_protect({ .height = h, .header = headers[i - 1], .body = BodyContainer(std::move(body)) });
+        }
+        t.commit();
+    }
+    ChainDB db;
+    Headerchain stage;
+};
+
+void apply(const StoredBlock&)
+{
+    static std::vector<uint8_t> data(APPLYBYTES, 1);
+    Hash h { HasherSHA256() << data };
+    data[0] = h[0];
+}
+
+double run(const std::string& name, auto process)
+{
+    auto start { std::chrono::steady_clock::now() };
+    size_t valid { process() };
+    std::chrono::duration<double> elapsed { std::chrono::steady_clock::now() - start };
+    auto blocksPerSecond { BLOCKS / elapsed.count() };
+    std::cout << name << ": " << blocksPerSecond << " blocks/s, " << valid << " valid signatures" << std::endl;
+    return blocksPerSecond;
+}
+
+// loads, resolves and verifies each block right before applying it
+size_t per_block(Fixture& f, WorkerPool& pool)
+{
+    size_t nValid { 0 };
+    for (uint32_t i = 1; i <= BLOCKS; ++i) {
+        const NonzeroHeight h { i };
+        auto p { f.db.get_block(f.stage.hash_at(h)) };
+        auto& block { p.value().second };
+        BodyView bv(block.body_view());
+        std::vector<TransferInternal> transfers;
+        std::vector<Address> addresses;
+        addresses.reserve(2 * bv.getNTransfers());
+        for (auto t : bv.transfers()) {
+            auto& ti { transfers.emplace_back(t.fromAccountId(), t.compact_fee_trow(),
+                t.toAccountId(), t.amount_throw(), t.pin_nonce(), t.signature()) };
+            ti.fromAddress = addresses.emplace_back(f.db.lookup_account(ti.fromAccountId)->address);
+            ti.toAddress = addresses.emplace_back(f.db.lookup_account(ti.toAccountId)->address);
+        }
+        std::vector<uint8_t> valid(transfers.size());
+        pool.parallel_for(transfers.size(), [&](size_t j) {
+            try {
+                transfers[j].verify(f.stage, h, true);
+                valid[j] = 1;
+            } catch (Error) {
+            }
+        });
+        for (auto v : valid)
+            nValid += v;
+        apply(block);
+    }
+    return nValid;
+}
+
+size_t pipelined(Fixture& f, WorkerPool& pool, SyncPipelineCounters& counters)
+{
+    size_t nValid { 0 };
+    BlockPipeline pipeline(f.db, f.stage, pool, counters, NonzeroHeight(1u), Height(0));
+    while (auto item { pipeline.next() }) {
+        for (auto v : item->validSignatures)
+            nValid += v;
+        apply(item->block);
+    }
+    return nValid;
+}
+}
+
+int main()
+{
+    ECC_Start();
+    enable_testnet();
+    auto dir { std::filesystem::temp_directory_path() / "warthog-bench-sync-pipeline" };
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        Fixture f(dir / "chain.db3");
+        WorkerPool pool;
+        SyncPipelineCounters counters;
+        std::cout << "Applying " << BLOCKS << " synthetic blocks with " << TRANSFERS
+                  << " transfers each using " << pool.size() << " pool threads" << std::endl;
+        auto sequential { run("per-block", [&]() { return per_block(f, pool); }) };
+        auto pipeline { run("pipelined", [&]() { return pipelined(f, pool, counters); }) };
+        auto stats { counters.stats() };
+        std::cout << "speedup: " << pipeline / sequential << "x, stall "
+                  << stats.stallMicros / 1000 << " ms, max queue depth " << stats.maxQueueDepth
+                  << ", queue depth after run " << stats.queueDepth << std::endl;
+    }
+    std::filesystem::remove_all(dir);
+    ECC_Stop();
+}
@@ -2,6 +2,7 @@
 #include "block/body/account_id.hpp"
 #include "general/funds.hpp"
 #include "general/reader.hpp"
+#include <span>
 
 class RollbackView {
 public:
@@ -25,7 +26,7 @@ public:
     private:
         const uint8_t* pos;
     };
-    RollbackView(std::vector<uint8_t>& bytes)
+    RollbackView(std::span<const uint8_t> bytes)
         : bytes(bytes)
     {
         if ((bytes.size() % 16) != 8) {
@@ -37,7 +38,7 @@ public:
     AccountBalance accountBalance(size_t i) { return bytes.data() + 8 + i * 16; }
 
 private:
-    std::vector<uint8_t>& bytes;
+    std::span<const uint8_t> bytes;
 };
 
 class RollbackGenerator {
@@ -2,7 +2,13 @@
 #include "block/header/difficulty_scale.hpp"
 #include "general/is_testnet.hpp"
 #include "general/now.hpp"
+#include "general/worker_pool.hpp"
 #include "spdlog/spdlog.h"
+#include <algorithm>
+
+namespace {
+constexpr size_t POWCHUNKPERTHREAD = 4; // headers per pool thread in one parallel check
+}
 
 HeaderVerifier::HeaderVerifier(const SharedBatch& b)
     : nextTarget(TargetV1())
@@ -58,17 +64,57 @@ HeaderVerifier::HeaderVerifier(const SharedBatch& b)
     }
 }
 
-tl::expected<HeaderVerifier, ChainError> HeaderVerifier::copy_apply(const std::optional<SignedSnapshot>& sp, const HeaderRange& hrange) const
+tl::expected<HeaderVerifier, ChainError> HeaderVerifier::copy_apply(const std::optional<SignedSnapshot>& sp, const HeaderRange& hrange, WorkerPool& pool) const
 {
     HeaderVerifier res { *this };
     assert(hrange.begin_height() == length + 1);
+
+    // The checks depending on previous headers are cheap and run
+    // sequentially, the expensive proof of work checks are collected
+    // and run in parallel afterwards.
+    struct PendingPOW {
+        HeaderView hv;
+        Hash hash;
+        POWVersion version;
+        NonzeroHeight height;
+    };
+    std::vector<PendingPOW> pending;
+    std::optional<ChainError> error;
     for (auto h : hrange) {
-        auto e { res.prepare_append(sp, h) };
-        if (!e.has_value()) {
-            return tl::make_unexpected(ChainError(e.error(), h.height));
+        auto hash { h.hash() };
+        auto v { res.check_link_and_target(h, h.height) };
+        if (!v.has_value()) {
+            error = ChainError(v.error(), h.height);
+            break;
         }
-        res.append(h.height, e.value());
+        // proof of work of this header takes precedence over the errors below
+        pending.push_back({ h, hash, *v, h.height });
+        if (auto e { res.check_pin_and_time(sp, h, hash) }; e.is_error()) {
+            error = ChainError(e, h.height);
+            break;
+        }
+        res.append(h.height, { h, hash });
     }
+
+    // Chunks of a few headers per thread are checked one after another
+    // such that a batch with invalid proof of work is rejected after
+    // few hash computations. The error is reported at the lowest height
+    // like in sequential verification.
+    const size_t chunk { POWCHUNKPERTHREAD * std::max(pool.size(), size_t(1)) };
+    std::vector<uint8_t> validPOW(pending.size());
+    for (size_t begin = 0; begin < pending.size(); begin += chunk) {
+        const size_t n { std::min(chunk, pending.size() - begin) };
+        pool.parallel_for(n, [&](size_t i) {
+            auto& p { pending[begin + i] };
+            validPOW[begin + i] = p.hv.validPOW(p.hash, p.version);
+        });
+        for (size_t i = begin; i < begin + n; ++i) {
+            if (!validPOW[i])
+                return tl::make_unexpected(ChainError(EPOW, pending[i].height));
+        }
+    }
+    if (error)
+        return tl::make_unexpected(*error);
     return res;
 }
 
@@ -132,7 +178,23 @@ void HeaderVerifier::append(NonzeroHeight newlength, const PreparedAppend& p)
 auto HeaderVerifier::prepare_append(const std::optional<SignedSnapshot>& sp, HeaderView hv) const -> tl::expected<PreparedAppend, int32_t>
 {
     auto hash { hv.hash() };
-    NonzeroHeight appendHeight { height() + 1 };
+    auto powVersion { check_link_and_target(hv, (height() + 1).nonzero_assert()) };
+    if (!powVersion.has_value())
+        return tl::make_unexpected(powVersion.error());
+
+    // Check POW
+    if (!hv.validPOW(hash, *powVersion)) {
+        return tl::make_unexpected(EPOW);
+    }
+
+    if (auto e { check_pin_and_time(sp, hv, hash) }; e.is_error())
+        return tl::make_unexpected(e.e);
+    return PreparedAppend { hv, hash };
+}
+
+auto HeaderVerifier::check_link_and_target(HeaderView hv, NonzeroHeight appendHeight) const -> tl::expected<POWVersion, int32_t>
+{
+    assert(appendHeight == height() + 1);
 
     // Check header link
     if (hv.prevhash() != finalHash)
@@ -147,15 +209,14 @@ auto HeaderVerifier::prepare_append(const std::optional<SignedSnapshot>& sp, Hea
     // Check difficulty
     if (hv.target(appendHeight, is_testnet()) != nextTarget)
         return tl::make_unexpected(EDIFFICULTY);
+    return *powVersion;
+}
 
-    // Check POW
-    if (!hv.validPOW(hash, *powVersion)) {
-        return tl::make_unexpected(EPOW);
-    }
-
+Error HeaderVerifier::check_pin_and_time(const std::optional<SignedSnapshot>& sp, HeaderView hv, const Hash& hash) const
+{
     // Check signed pin
     if (sp && length + 1 == sp->priority.height && sp->hash != hash)
-        return tl::make_unexpected(ELEADERMISMATCH);
+        return ELEADERMISMATCH;
 
     const uint32_t t = hv.timestamp();
 
@@ -163,13 +224,13 @@ auto HeaderVerifier::prepare_append(const std::optional<SignedSnapshot>& sp, Hea
     // Check no time drops (should be automatically valid if no future times)
     if (!timeValidator.valid(t)
         || latestRetargetTime >= t)
-        return tl::make_unexpected(ETIMESTAMP);
+        return ETIMESTAMP;
 
     // Check no future block times
     // LATER: use network time
     if (t > now_timestamp() + TOLERANCEMINUTES * 60)
-        return tl::make_unexpected(ECLOCKTOLERANCE);
-    return PreparedAppend { hv, hash };
+        return ECLOCKTOLERANCE;
+    return {};
 }
 
 HeaderVerifier::HeaderVerifier(const Headerchain& hc, Height length)
@@ -11,6 +11,7 @@ struct MiningData {
 };
 
 class ExtendableHeaderchain;
+class WorkerPool;
 
 class HeaderVerifier {
 
@@ -22,7 +23,9 @@ public:
     HeaderVerifier();
     HeaderVerifier(const Headerchain& hc, Height length);
     HeaderVerifier(const HeaderVerifier&, const Batch&, Height heightOffset);
-    tl::expected<HeaderVerifier, ChainError> copy_apply(const std::optional<SignedSnapshot>& sp, const HeaderRange&) const;
+    // proof of work of the range is checked in parallel on the pool,
+    // chunk by chunk until the first invalid header
+    tl::expected<HeaderVerifier, ChainError> copy_apply(const std::optional<SignedSnapshot>& sp, const HeaderRange&, WorkerPool&) const;
     HeaderVerifier(const SharedBatch&);
     // void clear();
     [[nodiscard]] auto prepare_append(const std::optional<SignedSnapshot>& sp, HeaderView hv) const -> tl::expected<PreparedAppend, int32_t>;
@@ -38,6 +41,11 @@ public:
 protected:
     void initialize(const Headerchain& hc, Height length);
 
+private:
+    // checks before and after proof of work in prepare_append
+    [[nodiscard]] auto check_link_and_target(HeaderView hv, NonzeroHeight appendHeight) const -> tl::expected<POWVersion, int32_t>;
+    [[nodiscard]] Error check_pin_and_time(const std::optional<SignedSnapshot>& sp, HeaderView hv, const Hash& hash) const;
+
 private: // data
     Height length { 0 };
     //
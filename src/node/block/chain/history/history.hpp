@@ -30,7 +30,8 @@ struct TransferInternal {
     AddressView fromAddress { nullptr };
     AddressView toAddress { nullptr };
     RecoverableSignature signature;
-    VerifiedTransfer verify(const Headerchain&, NonzeroHeight) const;
+    // signatures of assumed valid blocks are not checked
+    VerifiedTransfer verify(const Headerchain&, NonzeroHeight, bool checkSignature = true) const;
     TransferInternal(AccountId from, CompactUInt compactFee, AccountId to,
         Funds amount, PinNonce pinNonce, View<65> signdata)
         : fromAccountId(from)
@@ -45,7 +46,7 @@ struct TransferInternal {
 
 class VerifiedTransfer {
     friend struct TransferInternal;
-    VerifiedTransfer(const TransferInternal&, PinHeight pinHeight, HashView pinHash);
+    VerifiedTransfer(const TransferInternal&, PinHeight pinHeight, HashView pinHash, bool checkSignature);
     Address recover_address() const
     {
         return ti.signature.recover_pubkey(hash).address();
@@ -3,42 +3,76 @@
 #include "block/chain/height.hpp"
 #include "block/chain/history/index.hpp"
 #include <algorithm>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+// Entries are kept in shared immutable chunks such that copies are
+// cheap and can be handed to other threads as a snapshot.
 template <typename HeightType, typename T>
 struct Heights {
-    Heights(std::vector<T> data = {})
-        : data(std::move(data)) {};
+    static constexpr size_t CHUNKSIZE = 4096;
     const T& at(NonzeroHeight h) const
     {
-        return data.at((h - 1).value());
+        const size_t i { (h - 1).value() };
+        if (i >= size())
+            throw std::out_of_range("Height " + std::to_string(h.value()) + " out of range");
+        if (i < chunks.size() * CHUNKSIZE)
+            return (*chunks[i / CHUNKSIZE])[i % CHUNKSIZE];
+        return tail[i % CHUNKSIZE];
     }
     void shrink(Height newlength)
     {
-        assert(size() >= newlength.value());
-        data.erase(data.begin() + newlength.value(), data.end());
+        const size_t n { newlength.value() };
+        assert(size() >= n);
+        const size_t nChunks { n / CHUNKSIZE };
+        if (nChunks < chunks.size()) {
+            auto& c { *chunks[nChunks] };
+            tail.assign(c.begin(), c.begin() + n % CHUNKSIZE);
+            chunks.erase(chunks.begin() + nChunks, chunks.end());
+        } else {
+            tail.erase(tail.begin() + n % CHUNKSIZE, tail.end());
+        }
     }
     void append(T v)
     {
-        data.push_back(std::move(v));
+        tail.push_back(std::move(v));
+        if (tail.size() == CHUNKSIZE) {
+            chunks.push_back(std::make_shared<const std::vector<T>>(std::move(tail)));
+            tail.clear();
+        }
     }
     [[nodiscard]] HeightType height(const T& t) const
     {
-        auto iter = std::upper_bound(data.begin(), data.end(),
-            t);
-        assert(iter != data.begin());
-        return HeightType(uint32_t((iter - 1) - data.begin() + 1));
+        // index of first entry greater than t
+        auto chunkIter = std::upper_bound(chunks.begin(), chunks.end(), t,
+            [](const T& t, const auto& c) { return t < c->front(); });
+        size_t i { size_t(chunkIter - chunks.begin()) };
+        size_t pos { i * CHUNKSIZE };
+        if (i > 0) {
+            auto& c { *chunks[i - 1] };
+            pos = (i - 1) * CHUNKSIZE + (std::upper_bound(c.begin(), c.end(), t) - c.begin());
+        }
+        if (i == chunks.size() && pos == i * CHUNKSIZE)
+            pos += std::upper_bound(tail.begin(), tail.end(), t) - tail.begin();
+        assert(pos != 0);
+        return HeightType(uint32_t(pos));
     }
     void append_vector(const std::vector<T>& v)
     {
-        data.insert(data.end(), v.begin(), v.end());
+        for (auto& e : v)
+            append(e);
     }
     size_t size() const
     {
-        return data.size();
+        return chunks.size() * CHUNKSIZE + tail.size();
     }
 
 protected:
-    std::vector<T> data;
+    std::vector<std::shared_ptr<const std::vector<T>>> chunks;
+    std::vector<T> tail;
 };
 using HistoryHeights = Heights<NonzeroHeight, HistoryId>;
 using AccountHeights = Heights<AccountHeight, AccountId>;
@@ -0,0 +1,87 @@
+#include "compact_batch.hpp"
+#include "block/header/view_inline.hpp"
+#include "crypto/hash.hpp"
+#include "general/byte_order.hpp"
+#include "general/reader.hpp"
+#include <cstring>
+
+namespace {
+namespace compact {
+    // flags preceding every header except the first
+    constexpr uint8_t SAMETARGET = 1;
+    constexpr uint8_t SAMEVERSION = 2;
+    constexpr uint8_t SHORTTIME = 4; // 2 byte timestamp increment
+}
+}
+
+std::vector<uint8_t> encode_compact(const Batch& b)
+{
+    std::vector<uint8_t> out;
+    if (b.size() == 0)
+        return out;
+    out.reserve(80 + (b.size() - 1) * 45);
+    auto put = [&](const uint8_t* p, size_t n) { out.insert(out.end(), p, p + n); };
+    put(b.first().data(), 80);
+    for (size_t i = 1; i < b.size(); ++i) {
+        const uint8_t* prev { b[i - 1].data() };
+        const uint8_t* cur { b[i].data() };
+        const uint32_t dt { b[i].timestamp() - b[i - 1].timestamp() };
+        uint8_t flags { 0 };
+        if (memcmp(prev + HeaderView::offset_target, cur + HeaderView::offset_target, 4) == 0)
+            flags |= compact::SAMETARGET;
+        if (memcmp(prev + HeaderView::offset_version, cur + HeaderView::offset_version, 4) == 0)
+            flags |= compact::SAMEVERSION;
+        if (b[i].timestamp() >= b[i - 1].timestamp() && dt <= 0xFFFF)
+            flags |= compact::SHORTTIME;
+        out.push_back(flags);
+        if (!(flags & compact::SAMETARGET))
+            put(cur + HeaderView::offset_target, 4);
+        put(cur + HeaderView::offset_merkleroot, 32);
+        if (!(flags & compact::SAMEVERSION))
+            put(cur + HeaderView::offset_version, 4);
+        if (flags & compact::SHORTTIME) {
+            uint16_t d { hton16(uint16_t(dt)) };
+            put(reinterpret_cast<const uint8_t*>(&d), 2);
+        } else {
+            put(cur + HeaderView::offset_timestamp, 4);
+        }
+        put(cur + HeaderView::offset_nonce, 4);
+    }
+    return out;
+}
+
+Batch decode_compact(Reader& r)
+{
+    std::vector<uint8_t> bytes;
+    if (r.remaining() == 0)
+        return Batch(std::move(bytes));
+    bytes.resize(80);
+    r.copy_checkrange(bytes.data(), 80);
+    while (r.remaining() > 0) {
+        if (bytes.size() >= HEADERBATCHSIZE * 80)
+            throw Error(EBATCHSIZE);
+        bytes.resize(bytes.size() + 80);
+        uint8_t* cur { bytes.data() + bytes.size() - 80 };
+        const uint8_t* prev { cur - 80 };
+        const uint8_t flags { r.uint8() };
+        auto prevhash { HeaderView(prev).hash() };
+        memcpy(cur + HeaderView::offset_prevhash, prevhash.data(), 32);
+        if (flags & compact::SAMETARGET)
+            memcpy(cur + HeaderView::offset_target, prev + HeaderView::offset_target, 4);
+        else
+            r.copy_checkrange(cur + HeaderView::offset_target, 4);
+        r.copy_checkrange(cur + HeaderView::offset_merkleroot, 32);
+        if (flags & compact::SAMEVERSION)
+            memcpy(cur + HeaderView::offset_version, prev + HeaderView::offset_version, 4);
+        else
+            r.copy_checkrange(cur + HeaderView::offset_version, 4);
+        if (flags & compact::SHORTTIME) {
+            uint32_t ts { hton32(HeaderView(prev).timestamp() + r.uint16()) };
+            memcpy(cur + HeaderView::offset_timestamp, &ts, 4);
+        } else {
+            r.copy_checkrange(cur + HeaderView::offset_timestamp, 4);
+        }
+        r.copy_checkrange(cur + HeaderView::offset_nonce, 4);
+    }
+    return Batch(std::move(bytes));
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "batch.hpp"
+#include <cstdint>
+#include <vector>
+
+class Reader;
+
+// Compact encoding of a header batch: prevhash is omitted for all but
+// the first header, target and version are only sent when they change
+// and timestamps are sent as increments when they fit in two bytes.
+[[nodiscard]] std::vector<uint8_t> encode_compact(const Batch&);
+[[nodiscard]] Batch decode_compact(Reader&);
@@ -1,14 +1,25 @@
 #include "account_cache.hpp"
 #include "db/chain_db.hpp"
+#include "db/chain_db_reader.hpp"
 #include "general/address_funds.hpp"
 
 namespace chainserver {
+AccountCache::AccountCache(const ChainDB& db)
+    : fetch([&db](AccountId id) { return db.fetch_account(id); })
+{
+}
+
+AccountCache::AccountCache(const ChainDBReader& db)
+    : fetch([&db](AccountId id) { return db.fetch_account(id); })
+{
+}
+
 const AddressFunds& AccountCache::operator[](AccountId id)
 {
     auto iter = map.find(id);
     if (iter != map.end())
         return iter->second;
-    auto p = db.fetch_account(id);
+    auto p = fetch(id);
     return map.emplace(id, p).first->second;
 }
 
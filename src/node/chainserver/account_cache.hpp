@@ -1,20 +1,20 @@
 #pragma once
 #include "block/body/account_id.hpp"
-#include<map>
+#include <functional>
+#include <map>
 class ChainDB;
+class ChainDBReader;
 class AddressFunds;
 namespace chainserver {
 struct AccountCache {
-    AccountCache(const ChainDB& db)
-        : db(db)
-    {
-    }
+    AccountCache(const ChainDB& db);
+    AccountCache(const ChainDBReader& db);
 
 public:
     const AddressFunds& operator[](AccountId id);
 
 private:
     std::map<AccountId, AddressFunds> map;
-    const ChainDB& db;
+    std::function<AddressFunds(AccountId)> fetch;
 };
 }
@@ -0,0 +1,241 @@
+#include "chain_query.hpp"
+#include "account_cache.hpp"
+#include "block/chain/history/history.hpp"
+#include "block/header/header_impl.hpp"
+#include "db/chain_db_reader.hpp"
+
+namespace chainserver {
+
+auto ChainQuery::get_header(Height h) const -> std::optional<std::pair<NonzeroHeight, Header>>
+{
+    if (auto p { s.headers.get_header(h) }; p.has_value())
+        return std::pair<NonzeroHeight, Header> { h.nonzero_assert(), Header(p.value()) };
+    return {};
+}
+
+auto ChainQuery::api_get_header(const API::HeightOrHash& hh) const -> std::optional<std::pair<NonzeroHeight, Header>>
+{
+    if (std::holds_alternative<Height>(hh.data)) {
+        return get_header(std::get<Height>(hh.data));
+    }
+    auto h { consensus_height(std::get<Hash>(hh.data)) };
+    if (!h.has_value())
+        return {};
+    return get_header(*h);
+}
+
+std::optional<NonzeroHeight> ChainQuery::consensus_height(const Hash& hash) const
+{
+    auto o { db.lookup_block_height(hash) };
+    if (!o.has_value())
+        return {};
+    auto& h { o.value() };
+    auto hash2 { s.headers.get_hash(h) };
+    if (!hash2.has_value() || *hash2 != hash)
+        return {};
+    return h;
+}
+
+auto ChainQuery::api_get_hash(Height h) const -> std::optional<Hash>
+{
+    return s.headers.get_hash(h);
+}
+
+auto ChainQuery::api_get_block(const API::HeightOrHash& hh) const -> std::optional<API::Block>
+{
+    if (std::holds_alternative<Height>(hh.data)) {
+        return api_get_block(std::get<Height>(hh.data));
+    }
+    auto h { consensus_height(std::get<Hash>(hh.data)) };
+    if (!h.has_value())
+        return {};
+    return api_get_block(*h);
+}
+
+auto ChainQuery::api_get_block(Height zh) const -> std::optional<API::Block>
+{
+    if (zh == 0 || zh > s.length())
+        return {};
+    auto h { zh.nonzero_assert() };
+    PinFloor pinFloor { PrevHeight(h) };
+    auto lower = s.historyOffsets.at(h);
+    auto upper = (h == s.length() ? HistoryId { 0 }
+                                  : s.historyOffsets.at(h + 1));
+    auto entries = db.lookup_history_range(lower, upper);
+    auto header = s.headers[h];
+    API::Block b(header, h, s.length() - h + 1);
+
+    AccountCache cache(db);
+    for (auto [hash, data] : entries) {
+        b.push_history(hash, data, cache, pinFloor);
+    }
+    return b;
+}
+
+bool ChainQuery::indexing_in_progress() const
+{
+    return db.indexing_deferred();
+}
+
+auto ChainQuery::api_get_tx(const HashView txHash) const -> std::optional<API::Transaction>
+{
+    auto p = db.lookup_history(txHash);
+    if (!p)
+        return {};
+    auto& [data, historyIndex] = *p;
+    if (data.size() == 0)
+        return {};
+    auto parsed { history::parse_throw(data) };
+    NonzeroHeight h { s.historyOffsets.height(historyIndex) };
+    if (std::holds_alternative<history::TransferData>(parsed)) {
+        auto& d = std::get<history::TransferData>(parsed);
+        return API::TransferTransaction {
+            .txhash = txHash,
+            .toAddress = db.fetch_account(d.toAccountId).address,
+            .confirmations = (s.length() - h) + 1,
+            .height = h,
+            .timestamp = s.headers[h].timestamp(),
+            .amount = d.amount,
+            .fromAddress = db.fetch_account(d.fromAccountId).address,
+            .fee = d.compactFee.uncompact(),
+            .nonceId = d.pinNonce.id,
+            .pinHeight = d.pinNonce.pin_height((PinFloor(PrevHeight(h))))
+        };
+    } else {
+        assert(std::holds_alternative<history::RewardData>(parsed));
+        auto& d = std::get<history::RewardData>(parsed);
+        return API::RewardTransaction {
+            .txhash = txHash,
+            .toAddress = db.fetch_account(d.toAccountId).address,
+            .confirmations = (s.length() - h) + 1,
+            .height = h,
+            .timestamp = s.headers[h].timestamp(),
+            .amount = d.miningReward
+        };
+    }
+}
+
+auto ChainQuery::api_get_latest_txs(size_t N) const -> API::TransactionsByBlocks
+{
+    HistoryId upper { db.next_history_id() };
+    // note: history ids start with 1
+    HistoryId lower { (upper.value() > N + 1) ? upper - N : HistoryId { 1 } };
+    API::TransactionsByBlocks res { .fromId { lower }, .blocks_reversed {} };
+    if (upper.value() == 0)
+        return res;
+    auto lookup { db.lookup_history_range(lower, upper) };
+    assert(lookup.size() == upper - lower);
+    if (s.length() != 0) {
+        AccountCache cache(db);
+        auto update_tmp = [&](auto id) {
+            auto h { s.historyOffsets.height(id) };
+            PinFloor pinFloor { PrevHeight(h) };
+            auto header { s.headers[h] };
+            auto b { API::Block(header, h, s.length() - h + 1) };
+            auto beginId { s.historyOffsets.at(h) };
+            return std::tuple { pinFloor, beginId, b };
+        };
+        auto tmp { update_tmp(upper - 1) };
+
+        for (size_t i = 0; i < lookup.size(); ++i) {
+            auto& [pinFloor, beginId, block] { tmp };
+            auto id { upper - 1 - i };
+            if (id < beginId) { // start new tmp block
+                res.blocks_reversed.push_back(block);
+                tmp = update_tmp(id);
+            }
+
+            auto& [hash, data] = lookup[lookup.size() - 1 - i];
+            block.push_history(hash, data, cache, pinFloor);
+        }
+        res.count = lookup.size();
+        res.blocks_reversed.push_back(std::get<2>(tmp));
+    }
+    return res;
+}
+
+auto ChainQuery::api_get_address(AddressView address) const -> API::Balance
+{
+    if (auto p = db.lookup_address(address); p) {
+        return API::Balance {
+            address,
+            p->accointId,
+            p->funds
+        };
+    } else {
+        return API::Balance {
+            {},
+            AccountId { 0 },
+            Funds { Funds::zero() }
+        };
+    }
+}
+
+auto ChainQuery::api_get_address(AccountId accountId) const -> API::Balance
+{
+    if (auto p = db.lookup_account(accountId); p) {
+        return API::Balance {
+            p->address,
+            accountId,
+            p->funds
+        };
+    } else {
+        return API::Balance {
+            {},
+            AccountId { 0 },
+            Funds { Funds::zero() }
+        };
+    }
+}
+
+auto ChainQuery::api_get_history(const Address& a, uint64_t beforeId) const -> std::optional<API::AccountHistory>
+{
+    auto p = db.lookup_address(a);
+    if (!p)
+        return {};
+    auto& [accountId, balance] = *p;
+
+    std::vector entries_desc = db.lookup_history_100_desc(accountId, beforeId);
+    std::vector<API::Block> blocks_reversed;
+    PinFloor pinFloor { 0 };
+    auto firstHistoryId = HistoryId { 0 };
+    auto nextHistoryOffset = HistoryId { 0 };
+    AccountCache cache(db);
+
+    auto prevHistoryId = HistoryId { 0 };
+    for (auto iter = entries_desc.rbegin(); iter != entries_desc.rend(); ++iter) {
+        auto& [historyId, txid, data] = *iter;
+        if (firstHistoryId == HistoryId { 0 })
+            firstHistoryId = historyId;
+        assert(prevHistoryId < historyId);
+        prevHistoryId = historyId;
+        if (historyId >= nextHistoryOffset) {
+            auto height { s.historyOffsets.height(historyId) };
+            pinFloor = PinFloor(PrevHeight(height));
+            auto header = s.headers[height];
+            bool b = height == s.length();
+            nextHistoryOffset = (b
+                    ? HistoryId { std::numeric_limits<uint64_t>::max() }
+                    : s.historyOffsets.at(height + 1));
+            blocks_reversed.push_back(
+                API::Block(header, height, 1 + (s.length() - height)));
+        }
+        API::Block& b = blocks_reversed.back();
+        b.push_history(txid, data, cache, pinFloor);
+    }
+
+    return API::AccountHistory {
+        .balance = balance,
+        .fromId = firstHistoryId,
+        .blocks_reversed = blocks_reversed
+    };
+}
+
+auto ChainQuery::api_get_richlist(size_t N) const -> API::Richlist
+{
+    API::Richlist out { s.richlist };
+    if (out.entries.size() > N)
+        out.entries.erase(out.entries.begin() + N, out.entries.end());
+    return out;
+}
+}
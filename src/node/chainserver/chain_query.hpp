@@ -0,0 +1,54 @@
+#pragma once
+#include "api/types/all.hpp"
+#include "block/chain/header_chain.hpp"
+#include "block/chain/offsts.hpp"
+#include "general/descriptor.hpp"
+
+class ChainDBReader;
+namespace chainserver {
+
+// Immutable copy of the chainstate metadata needed to answer API
+// queries. It is published by the chain server after every change
+// and shared with the query threads.
+struct ChainSnapshot {
+    Descriptor descriptor;
+    Headerchain headers;
+    HistoryHeights historyOffsets;
+    API::ChainHead head;
+    API::Richlist richlist;
+    Height length() const { return head.height; }
+};
+
+// Answers read-only API queries from a snapshot and a read-only
+// database connection that observes the same chain.
+class ChainQuery {
+public:
+    ChainQuery(const ChainDBReader& db, const ChainSnapshot& snapshot)
+        : db(db)
+        , s(snapshot)
+    {
+    }
+
+    auto api_get_address(AddressView) const -> API::Balance;
+    auto api_get_address(AccountId) const -> API::Balance;
+    auto api_get_head() const -> const API::ChainHead& { return s.head; }
+    bool indexing_in_progress() const; // no lookups by transaction hash or account
+    auto api_get_history(const Address& a, uint64_t beforeId) const -> std::optional<API::AccountHistory>;
+    auto api_get_richlist(size_t N) const -> API::Richlist;
+    auto api_get_tx(HashView hash) const -> std::optional<API::Transaction>;
+    auto api_get_latest_txs(size_t N = 100) const -> API::TransactionsByBlocks;
+    auto api_get_header(const API::HeightOrHash& h) const -> std::optional<std::pair<NonzeroHeight, Header>>;
+    auto api_get_hash(Height h) const -> std::optional<Hash>;
+    auto api_get_block(const API::HeightOrHash& h) const -> std::optional<API::Block>;
+    auto api_get_grid() const { return s.headers.grid(); }
+
+private:
+    auto get_header(Height h) const -> std::optional<std::pair<NonzeroHeight, Header>>;
+    auto api_get_block(Height h) const -> std::optional<API::Block>;
+    std::optional<NonzeroHeight> consensus_height(const Hash&) const;
+
+private:
+    const ChainDBReader& db;
+    const ChainSnapshot& s;
+};
+}
@@ -10,10 +10,17 @@ namespace mining_subscription {
 SubscriptionId::SubscriptionId()
     : id(gid++) {};
 
-void MiningSubscriptions::dispatch(std::function<tl::expected<ChainMiningTask, Error>(const Address&)> blockGenerator)
+void MiningSubscriptions::dispatch(generator_t blockGenerator)
 {
-    for (auto& [addr, v] : subscriptions) {
-        auto b { blockGenerator(addr) };
+    std::vector<Address> addresses;
+    addresses.reserve(subscriptions.size());
+    for (auto& [addr, _] : subscriptions)
+        addresses.push_back(addr);
+    auto blocks { blockGenerator(addresses) };
+    assert(blocks.size() == addresses.size());
+    size_t i { 0 };
+    for (auto& [_, v] : subscriptions) {
+        auto& b { blocks[i++] };
         for (auto& [_, f] : v) {
             if (b.has_value())
                 f(ChainMiningTask { b.value() });
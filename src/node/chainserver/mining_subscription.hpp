@@ -32,7 +32,8 @@ class MiningSubscriptions {
 public:
     void subscribe(SubscriptionRequest&&);
     void unsubscribe(SubscriptionId);
-    void dispatch(std::function<tl::expected<ChainMiningTask,Error>(const Address&)> blockGenerator);
+    using generator_t = std::function<std::vector<tl::expected<ChainMiningTask, Error>>(const std::vector<Address>&)>;
+    void dispatch(generator_t blockGenerator);
 
 private:
     struct Elem {
@@ -0,0 +1,113 @@
+#include "query_pool.hpp"
+#include "db/chain_db_reader.hpp"
+#include "general/errors.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <chrono>
+
+namespace chainserver {
+namespace {
+bool consistent(const ChainDBReader& db, const ChainSnapshot& s)
+{
+    auto head { db.consensus_head() };
+    if (s.length() == 0)
+        return !head.has_value();
+    return head.has_value() && head->first == s.length() && head->second == s.head.hash;
+}
+}
+
+QueryPool::QueryPool(std::string dbPath, size_t nThreads)
+    : dbPath(std::move(dbPath))
+{
+    for (size_t i = 0; i < std::max(nThreads, size_t(1)); ++i)
+        workers.emplace_back(&QueryPool::workerfun, this);
+}
+
+QueryPool::~QueryPool()
+{
+    shutdown_join();
+}
+
+void QueryPool::shutdown_join()
+{
+    {
+        std::unique_lock l(mutex);
+        closing = true;
+        cv.notify_all();
+        cvPublished.notify_all();
+    }
+    for (auto& t : workers) {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void QueryPool::publish(std::shared_ptr<const ChainSnapshot> s)
+{
+    std::unique_lock l(mutex);
+    if (s == snapshot)
+        return;
+    snapshot = std::move(s);
+    cvPublished.notify_all();
+}
+
+void QueryPool::submit(Task t)
+{
+    std::unique_lock l(mutex);
+    tasks.push(std::move(t));
+    cv.notify_one();
+}
+
+std::shared_ptr<const ChainSnapshot> QueryPool::latest()
+{
+    std::unique_lock l(mutex);
+    return snapshot;
+}
+
+std::shared_ptr<const ChainSnapshot> QueryPool::next_snapshot(const std::shared_ptr<const ChainSnapshot>& prev)
+{
+    using namespace std::chrono;
+    std::unique_lock l(mutex);
+    cvPublished.wait_for(l, milliseconds(100), [&]() { return closing || snapshot != prev; });
+    if (closing)
+        return {};
+    return snapshot;
+}
+
+void QueryPool::run(ChainDBReader& db, const Task& task)
+{
+    const auto deadline { std::chrono::steady_clock::now() + MAXWAIT };
+    for (auto s { latest() }; s; s = next_snapshot(s)) {
+        {
+            auto tx { db.read_transaction() };
+            if (consistent(db, *s)) {
+                task.run(ChainQuery(db, *s));
+                return;
+            }
+        }
+        // the writer has committed changes that are not yet published
+        if (std::chrono::steady_clock::now() >= deadline) {
+            spdlog::warn("No consistent chain snapshot for API query after {} seconds", MAXWAIT.count());
+            break;
+        }
+    }
+    task.fail(ECHAINBUSY);
+}
+
+void QueryPool::workerfun()
+{
+    ChainDBReader db(dbPath);
+    while (true) {
+        Task task;
+        {
+            std::unique_lock l(mutex);
+            cv.wait(l, [&]() { return closing || !tasks.empty(); });
+            if (closing)
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        run(db, task);
+    }
+}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "chain_query.hpp"
+#include "expected.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace chainserver {
+
+// Threads answering read-only API queries concurrently to the chain
+// server's writer thread. Each thread owns a read-only database
+// connection and runs a query only when its view of the database
+// matches the latest published snapshot, such that results are
+// consistent even while the writer applies blocks. A query that finds
+// no consistent snapshot within MAXWAIT fails with ECHAINBUSY.
+class QueryPool {
+public:
+    static constexpr std::chrono::seconds MAXWAIT { 10 };
+    struct Task {
+        std::function<void(const ChainQuery&)> run;
+        std::function<void(int32_t)> fail;
+    };
+
+    QueryPool(std::string dbPath, size_t nThreads);
+    QueryPool(const QueryPool&) = delete;
+    ~QueryPool();
+
+    void publish(std::shared_ptr<const ChainSnapshot>);
+    void submit(Task);
+
+    // passes f(query) or the error to the callback
+    template <typename Callback, typename F>
+    void submit(Callback callback, F f)
+    {
+        auto cb { std::make_shared<Callback>(std::move(callback)) };
+        submit(Task {
+            .run { [cb, f = std::move(f)](const ChainQuery& q) mutable { (*cb)(f(q)); } },
+            .fail { [cb](int32_t e) { (*cb)(tl::make_unexpected(e)); } } });
+    }
+    void shutdown_join();
+
+private:
+    void workerfun();
+    void run(ChainDBReader&, const Task&);
+    [[nodiscard]] std::shared_ptr<const ChainSnapshot> latest();
+    [[nodiscard]] std::shared_ptr<const ChainSnapshot> next_snapshot(const std::shared_ptr<const ChainSnapshot>&);
+
+private:
+    const std::string dbPath;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable cvPublished;
+    std::queue<Task> tasks;
+    std::shared_ptr<const ChainSnapshot> snapshot;
+    bool closing { false };
+    std::vector<std::thread> workers;
+};
+}
@@ -0,0 +1,83 @@
+#include "richlist.hpp"
+#include "db/chain_db.hpp"
+
+namespace chainserver {
+
+void Richlist::update(const std::map<AccountId, Funds>& balanceUpdates)
+{
+    if (!loaded)
+        return;
+    for (auto& [id, funds] : balanceUpdates) {
+        auto iter { accounts.find(id) };
+        if (iter != accounts.end()) {
+            ranking.erase({ iter->second.funds, id });
+            iter->second.funds = funds;
+            ranking.insert({ funds, id });
+        } else if (!bound || funds > *bound) {
+            insert(id, { db.fetch_account(id).address, funds });
+        }
+    }
+}
+
+void Richlist::erase_from(AccountId id)
+{
+    for (auto iter { accounts.lower_bound(id) }; iter != accounts.end();)
+        erase(iter++);
+}
+
+API::Richlist Richlist::get(size_t n)
+{
+    n = std::min(n, N);
+    if (!loaded || (bound && n_valid() < n))
+        reload();
+
+    API::Richlist out;
+    for (auto iter { ranking.rbegin() }; iter != ranking.rend() && out.entries.size() < n; ++iter) {
+        auto& [funds, id] { *iter };
+        if (bound && funds < *bound)
+            break;
+        out.entries.push_back({ accounts.at(id).address, funds });
+    }
+    return out;
+}
+
+void Richlist::insert(AccountId id, const AddressFunds& af)
+{
+    accounts.emplace(id, af);
+    ranking.insert({ af.funds, id });
+    if (ranking.size() > CAPACITY) {
+        auto [funds, evicted] { *ranking.begin() };
+        if (!bound || *bound < funds)
+            bound = funds;
+        erase(accounts.find(evicted));
+    }
+}
+
+void Richlist::erase(std::map<AccountId, AddressFunds>::iterator iter)
+{
+    ranking.erase({ iter->second.funds, iter->first });
+    accounts.erase(iter);
+}
+
+size_t Richlist::n_valid() const
+{
+    if (!bound)
+        return ranking.size();
+    return std::distance(ranking.lower_bound({ *bound, AccountId(uint64_t(0)) }), ranking.end());
+}
+
+void Richlist::reload()
+{
+    accounts.clear();
+    ranking.clear();
+    bound.reset();
+    auto entries { db.lookup_richlist(CAPACITY) };
+    for (auto& [id, af] : entries) {
+        accounts.emplace(id, af);
+        ranking.insert({ af.funds, id });
+    }
+    if (entries.size() == CAPACITY)
+        bound = entries.back().second.funds;
+    loaded = true;
+}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "api/types/all.hpp"
+#include "block/body/account_id.hpp"
+#include "general/address_funds.hpp"
+#include <map>
+#include <optional>
+#include <set>
+class ChainDB;
+namespace chainserver {
+
+// Tracks the accounts with the largest balances. It is updated from
+// the balance changes of appended and rolled back blocks such that
+// the richlist does not need to sort the State table. The database is
+// only queried again when too many tracked accounts have dropped below
+// the largest balance of an untracked account.
+class Richlist {
+public:
+    static constexpr size_t N = 100;
+    static constexpr size_t CAPACITY = 4 * N;
+
+    Richlist(const ChainDB& db)
+        : db(db)
+    {
+    }
+
+    void update(const std::map<AccountId, Funds>& balanceUpdates);
+    // forget accounts deleted by a rollback
+    void erase_from(AccountId);
+    [[nodiscard]] API::Richlist get(size_t n = N);
+
+private:
+    void insert(AccountId, const AddressFunds&);
+    void erase(std::map<AccountId, AddressFunds>::iterator);
+    size_t n_valid() const;
+    void reload();
+
+private:
+    const ChainDB& db;
+    bool loaded { false };
+    std::map<AccountId, AddressFunds> accounts;
+    std::set<std::pair<Funds, AccountId>> ranking;
+    // no untracked account has a larger balance, nothing if all
+    // accounts are tracked
+    std::optional<Funds> bound;
+};
+}
@@ -1,11 +1,20 @@
 #include "server.hpp"
 #include "api/types/all.hpp"
 #include "block/header/header_impl.hpp"
+#include "db/chain_db.hpp"
 #include "eventloop/eventloop.hpp"
 #include "general/hex.hpp"
 #include "global/globals.hpp"
 #include "spdlog/spdlog.h"
 
+template <typename T>
+tl::expected<T, int32_t> noval_to_err(std::optional<T>&& v)
+{
+    if (v)
+        return *v;
+    return tl::make_unexpected(ENOTFOUND);
+}
+
 bool ChainServer::is_busy()
 
 {
@@ -28,11 +37,23 @@ ConsensusSlave ChainServer::get_chainstate()
     return state.get_chainstate_concurrent();
 }
 
-ChainServer::ChainServer(ChainDB& db, BatchRegistry& br, std::optional<SnapshotSigner> snapshotSigner, Token)
+AccountCacheStats ChainServer::get_account_cache_stats()
+{
+    return db.account_cache_stats();
+}
+
+SyncPipelineStats ChainServer::get_sync_pipeline_stats()
+{
+    return state.sync_pipeline_stats();
+}
+
+ChainServer::ChainServer(ChainDB& db, BatchRegistry& br, WorkerPool& verifierPool, std::optional<SnapshotSigner> snapshotSigner, Token)
     : db(db)
     , batchRegistry(br)
-    , state(db, br, snapshotSigner)
+    , state(db, br, verifierPool, snapshotSigner)
+    , queryPool(db.path(), config().node.apiQueryThreads)
 {
+    queryPool.publish(state.chain_snapshot());
     worker = std::thread(&ChainServer::workerfun, this);
 }
 
@@ -70,12 +91,16 @@ void ChainServer::api_put_mempool(PaymentCreateMessage m,
 
 void ChainServer::api_get_balance(const API::AccountIdOrAddress& a, BalanceCb callback)
 {
-    defer_maybe_busy(GetBalance { a, std::move(callback) });
+    queryPool.submit(std::move(callback), [account = a](const chainserver::ChainQuery& q) mutable {
+        return account.visit([&](const auto& t) { return q.api_get_address(t); });
+    });
 }
 
 void ChainServer::api_get_grid(GridCb callback)
 {
-    defer_maybe_busy(GetGrid { std::move(callback) });
+    queryPool.submit(std::move(callback), [](const chainserver::ChainQuery& q) {
+        return q.api_get_grid();
+    });
 }
 
 void ChainServer::api_get_mempool(MempoolCb callback)
@@ -86,11 +111,21 @@ void ChainServer::api_get_mempool(MempoolCb callback)
 void ChainServer::api_lookup_tx(const HashView hash,
     TxCb callback)
 {
-    defer_maybe_busy(LookupTxHash { hash, std::move(callback) });
+    auto cb { std::make_shared<TxCb>(std::move(callback)) };
+    queryPool.submit({ .run { [this, hash = Hash(hash), cb](const chainserver::ChainQuery& q) {
+                          bool indexing { q.indexing_in_progress() };
+                          if (auto tx { indexing ? std::nullopt : q.api_get_tx(hash) }; tx)
+                              (*cb)(*tx);
+                          else // not in chain or not indexed yet, try mempool
+                              defer_maybe_busy(LookupTxHash { hash, indexing ? EINDEXING : ENOTFOUND, std::move(*cb) });
+                      } },
+        .fail { [cb](int32_t e) { (*cb)(tl::make_unexpected(e)); } } });
 }
 void ChainServer::api_lookup_latest_txs(LatestTxsCb callback)
 {
-    defer_maybe_busy(LookupLatestTxs { std::move(callback) });
+    queryPool.submit(std::move(callback), [](const chainserver::ChainQuery& q) {
+        return q.api_get_latest_txs();
+    });
 }
 void ChainServer::api_get_transaction_minfee(TransactionMinfeeCb callback)
 {
@@ -99,18 +134,26 @@ void ChainServer::api_get_transaction_minfee(TransactionMinfeeCb callback)
 
 void ChainServer::async_get_head(ChainHeadCb callback)
 {
-    defer_maybe_busy(GetHead { std::move(callback) });
+    queryPool.submit(std::move(callback), [](const chainserver::ChainQuery& q) {
+        return q.api_get_head();
+    });
 }
 
 void ChainServer::api_get_history(const Address& address, uint64_t beforeId,
     HistoryCb callback)
 {
-    defer_maybe_busy(GetHistory { address, beforeId, std::move(callback) });
+    queryPool.submit(std::move(callback), [address, beforeId](const chainserver::ChainQuery& q) -> tl::expected<API::AccountHistory, int32_t> {
+        if (q.indexing_in_progress())
+            return tl::make_unexpected(EINDEXING);
+        return noval_to_err(q.api_get_history(address, beforeId));
+    });
 }
 
 void ChainServer::api_get_richlist(RichlistCb callback)
 {
-    defer_maybe_busy(GetRichlist { std::move(callback) });
+    queryPool.submit(std::move(callback), [](const chainserver::ChainQuery& q) {
+        return q.api_get_richlist(100);
+    });
 }
 void ChainServer::api_get_mining(const Address& address, ChainMiningCb callback)
 {
@@ -137,16 +180,22 @@ void ChainServer::api_get_txcache(TxcacheCb callback)
 
 void ChainServer::api_get_header(API::HeightOrHash hoh, HeaderCb callback)
 {
-    defer_maybe_busy(GetHeader { hoh, std::move(callback) });
+    queryPool.submit(std::move(callback), [hoh](const chainserver::ChainQuery& q) {
+        return noval_to_err(q.api_get_header(hoh));
+    });
 }
 void ChainServer::api_get_hash(Height height, HashCb callback)
 {
-    defer_maybe_busy(GetHash { height, std::move(callback) });
+    queryPool.submit(std::move(callback), [height](const chainserver::ChainQuery& q) {
+        return noval_to_err(q.api_get_hash(height));
+    });
 }
 
 void ChainServer::api_get_block(API::HeightOrHash hoh, BlockCb callback)
 {
-    defer_maybe_busy(GetBlock { hoh, std::move(callback) });
+    queryPool.submit(std::move(callback), [hoh](const chainserver::ChainQuery& q) {
+        return noval_to_err(q.api_get_block(hoh));
+    });
 }
 
 void ChainServer::async_get_blocks(DescriptedBlockRange range, getBlocksCb&& callback)
@@ -181,13 +230,24 @@ void ChainServer::workerfun()
     while (true) {
         {
             std::unique_lock<std::mutex> ul(mutex);
-            while (!haswork) {
-                cv.wait(ul);
+            while (!haswork && !state.index_build_pending()) {
+                if (auto deadline { state.group_commit_deadline() }) {
+                    if (cv.wait_until(ul, *deadline) == std::cv_status::timeout)
+                        break;
+                } else {
+                    cv.wait(ul);
+                }
             }
         }
         haswork = false;
-        if (closing)
+        if (closing) {
+            state.commit_group();
             break;
+        }
+        if (auto deadline { state.group_commit_deadline() }; deadline && std::chrono::steady_clock::now() >= *deadline) {
+            state.commit_group();
+            queryPool.publish(state.chain_snapshot());
+        }
         state.garbage_collect();
 
         { // work
@@ -203,16 +263,19 @@ void ChainServer::workerfun()
                 },
                     tmpq.front());
                 tmpq.pop();
+                queryPool.publish(state.chain_snapshot());
             }
             timing.reset();
         }
+        if (state.index_build_pending()) // one step between events
+            state.build_indices_step();
     }
 }
 
 void ChainServer::dispatch_mining_subscriptions()
 {
-    miningSubscriptions.dispatch([&](const Address& a) {
-        return state.mining_task(a);
+    miningSubscriptions.dispatch([&](const std::vector<Address>& addresses) {
+        return state.mining_tasks(addresses);
     });
 }
 
@@ -239,19 +302,6 @@ void ChainServer::handle_event(MiningAppend&& e)
     }
 }
 
-void ChainServer::handle_event(GetGrid&& e)
-{
-    auto t { timing->time("GetGrid") };
-    e.callback(state.get_headers().grid());
-}
-
-void ChainServer::handle_event(GetBalance&& e)
-{
-    auto t { timing->time("GetBalance") };
-    auto result = e.account.visit([&](const auto& t) { return state.api_get_address(t); });
-    e.callback(result);
-}
-
 void ChainServer::handle_event(GetMempool&& e)
 {
     auto t { timing->time("GetMempool") };
@@ -267,18 +317,13 @@ void ChainServer::handle_event(LookupTxids&& e)
     e.callback(out);
 }
 
-template <typename T>
-tl::expected<T, int32_t> noval_to_err(std::optional<T>&& v)
-{
-    if (v)
-        return *v;
-    return tl::make_unexpected(ENOTFOUND);
-}
-
 void ChainServer::handle_event(LookupTxHash&& e)
 {
     auto t { timing->time("LookupTxHash") };
-    e.callback(noval_to_err(state.api_get_tx(e.hash)));
+    if (auto tx { state.api_get_mempool_tx(e.hash) }; tx)
+        e.callback(*tx);
+    else
+        e.callback(tl::make_unexpected(e.notFound));
 }
 
 void ChainServer::handle_event(GetTransactionMinfee&& e)
@@ -287,54 +332,12 @@ void ChainServer::handle_event(GetTransactionMinfee&& e)
     e.callback(state.api_get_transaction_minfee());
 }
 
-void ChainServer::handle_event(LookupLatestTxs&& e)
-{
-    auto t { timing->time("LookupLatestTxs") };
-    e.callback(state.api_get_latest_txs());
-}
-
 void ChainServer::handle_event(SetSynced&& e)
 {
     auto t { timing->time("SetSynced") };
     state.set_sync_state(e.synced);
-}
-
-void ChainServer::handle_event(GetHistory&& e)
-{
-    auto t { timing->time("GetHistory") };
-    auto history { state.api_get_history(e.address, e.beforeId) };
-    e.callback(noval_to_err(std::move(history)));
-}
-
-void ChainServer::handle_event(GetRichlist&& e)
-{
-    auto t { timing->time("GetRichlist") };
-    auto richlist { state.api_get_richlist(100) };
-    e.callback(std::move(richlist));
-}
-
-void ChainServer::handle_event(GetHead&& e)
-{
-    auto t { timing->time("GetHead") };
-    e.callback(state.api_get_head());
-}
-
-void ChainServer::handle_event(GetHeader&& e)
-{
-    auto t { timing->time("GetHeader") };
-    e.callback(noval_to_err(state.api_get_header(e.heightOrHash)));
-}
-
-void ChainServer::handle_event(GetHash&& e)
-{
-    auto t { timing->time("GetHash") };
-    e.callback(noval_to_err(state.get_hash(e.height)));
-}
-
-void ChainServer::handle_event(GetBlock&& e)
-{
-    auto t { timing->time("GetBlock") };
-    e.callback(noval_to_err(state.api_get_block(e.heightOrHash)));
+    if (e.synced)
+        state.end_bulk_sync();
 }
 
 void ChainServer::handle_event(GetMining&& e)
@@ -362,6 +365,7 @@ void ChainServer::handle_event(GetTxcache&& e)
     auto t { timing->time("GetTxcache") };
     e.callback(state.api_tx_cache());
 }
+
 //
 void ChainServer::handle_event(GetBlocks&& e)
 {
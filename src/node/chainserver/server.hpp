@@ -6,6 +6,7 @@
 #include "communication/create_payment.hpp"
 #include "communication/stage_operation/request.hpp"
 #include "general/logging.hpp"
+#include "query_pool.hpp"
 #include "state/state.hpp"
 #include <condition_variable>
 #include <queue>
@@ -30,6 +31,8 @@ public:
     Batch get_headers(BatchSelector selector);
     std::optional<HeaderView> get_descriptor_header(Descriptor descriptor, Height height);
     ConsensusSlave get_chainstate();
+    AccountCacheStats get_account_cache_stats();
+    SyncPipelineStats get_sync_pipeline_stats();
 
     void shutdown_join()
     {
@@ -37,6 +40,7 @@ public:
         if (worker.joinable()) {
             worker.join();
         }
+        queryPool.shutdown_join();
     }
 
     struct MiningAppend {
@@ -47,13 +51,6 @@ public:
         PaymentCreateMessage m;
         MempoolInsertCb callback;
     };
-    struct GetGrid {
-        GridCb callback;
-    };
-    struct GetBalance {
-        API::AccountIdOrAddress account;
-        BalanceCb callback;
-    };
     struct GetMempool {
         MempoolCb callback;
     };
@@ -64,40 +61,15 @@ public:
     };
     struct LookupTxHash {
         const Hash hash;
+        int32_t notFound; // error if the mempool misses too
         TxCb callback;
     };
-    struct LookupLatestTxs {
-        LatestTxsCb callback;
-    };
     struct GetTransactionMinfee {
         TransactionMinfeeCb callback;
     };
     struct SetSynced {
         bool synced;
     };
-    struct GetHistory {
-        const Address& address;
-        uint64_t beforeId;
-        HistoryCb callback;
-    };
-    struct GetRichlist {
-        RichlistCb callback;
-    };
-    struct GetHead {
-        ChainHeadCb callback;
-    };
-    struct GetHeader {
-        API::HeightOrHash heightOrHash;
-        HeaderCb callback;
-    };
-    struct GetHash {
-        Height height;
-        HashCb callback;
-    };
-    struct GetBlock {
-        API::HeightOrHash heightOrHash;
-        BlockCb callback;
-    };
     struct GetMining {
         Address address;
         ChainMiningCb callback;
@@ -127,20 +99,11 @@ public:
     using Event = std::variant<
         MiningAppend,
         PutMempool,
-        GetGrid,
-        GetBalance,
         GetMempool,
         LookupTxids,
         LookupTxHash,
-        LookupLatestTxs,
         GetTransactionMinfee,
         SetSynced,
-        GetHistory,
-        GetRichlist,
-        GetHead,
-        GetHeader,
-        GetHash,
-        GetBlock,
         GetMining,
         SubscribeMining,
         UnsubscribeMining,
@@ -178,10 +141,10 @@ private:
     struct Token { };
 
 public:
-    ChainServer(ChainDB& b, BatchRegistry&, std::optional<SnapshotSigner> snapshotSigner, Token);
-    static auto make_chain_server(ChainDB& b, BatchRegistry& br, std::optional<SnapshotSigner> snapshotSigner)
+    ChainServer(ChainDB& b, BatchRegistry&, WorkerPool& verifierPool, std::optional<SnapshotSigner> snapshotSigner, Token);
+    static auto make_chain_server(ChainDB& b, BatchRegistry& br, WorkerPool& verifierPool, std::optional<SnapshotSigner> snapshotSigner)
     {
-        return std::make_shared<ChainServer>(b, br, snapshotSigner, Token {});
+        return std::make_shared<ChainServer>(b, br, verifierPool, snapshotSigner, Token {});
     }
     ~ChainServer();
 
@@ -229,20 +192,11 @@ private:
 private:
     void handle_event(MiningAppend&&);
     void handle_event(PutMempool&&);
-    void handle_event(GetGrid&&);
-    void handle_event(GetBalance&&);
     void handle_event(GetMempool&&);
     void handle_event(LookupTxids&&);
     void handle_event(LookupTxHash&&);
-    void handle_event(LookupLatestTxs&&);
     void handle_event(GetTransactionMinfee&&);
     void handle_event(SetSynced&& e);
-    void handle_event(GetHistory&&);
-    void handle_event(GetRichlist&&);
-    void handle_event(GetHead&&);
-    void handle_event(GetHeader&&);
-    void handle_event(GetHash&&);
-    void handle_event(GetBlock&&);
     void handle_event(GetMining&&);
     void handle_event(SubscribeMining&&);
     void handle_event(UnsubscribeMining&&);
@@ -271,6 +225,8 @@ private:
     bool haswork = false;
     bool closing = false;
     bool switching = false; // doing chain switch?
+
+    chainserver::QueryPool queryPool; // read-only API queries
     std::thread worker;
 };
 ;
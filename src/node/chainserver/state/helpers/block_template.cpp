@@ -0,0 +1,245 @@
+#include "block_template.hpp"
+#include "block/body/view.hpp"
+#include "crypto/hasher_sha256.hpp"
+#include "crypto/sha256_batch.hpp"
+#include "db/chain_db.hpp"
+#include "general/writer.hpp"
+#include "mempool/mempool.hpp"
+#include "spdlog/spdlog.h"
+#include <cstring>
+
+namespace chainserver {
+namespace {
+constexpr size_t MAXTRANSFERS { 400 };
+constexpr size_t TRANSFERSIZE { 99 };
+constexpr size_t MAXRESOLVED { 100000 }; // bound on cached recipient ids
+
+size_t body_size(size_t nAddresses, size_t nTransfers)
+{
+    return 10 + 2 + 20 * nAddresses + 16 + (nTransfers > 0 ? 4 + TRANSFERSIZE * nTransfers : 0);
+}
+
+Hash hash_pair(const Hash& h1, const Hash& h2)
+{
+    std::array<uint8_t, 64> b;
+    memcpy(b.data(), h1.data(), 32);
+    memcpy(b.data() + 32, h2.data(), 32);
+    return hashSHA256(b);
+}
+
+// node i of the level above, an unpaired last node is hashed alone
+Hash parent(const std::vector<Hash>& level, size_t i)
+{
+    if (2 * i + 1 < level.size())
+        return hash_pair(level[2 * i], level[2 * i + 1]);
+    return hashSHA256(level[2 * i]);
+}
+}
+
+const BlockTemplate::Transfers BlockTemplate::noTransfers;
+
+void BlockTemplate::on_rollback()
+{
+    accountIds.clear();
+    unknown.clear();
+    records.clear();
+    validity = {};
+}
+
+void BlockTemplate::update(const ChainDB& db, const mempool::Mempool& mempool, NonzeroHeight h, Validity v)
+{
+    if (v == validity && height == h)
+        return;
+    if (db.next_state_id() < nextStateId)
+        on_rollback(); // ids were reassigned
+    if (v.db != validity.db)
+        unknown.clear();
+    if (PinFloor pf { PrevHeight(h) }; pf != pinFloor) {
+        records.clear();
+        pinFloor = pf;
+    }
+    if (accountIds.size() > MAXRESOLVED)
+        accountIds.clear();
+    validity = v;
+    height = h;
+    nextStateId = db.next_state_id();
+    select(db, mempool);
+
+    // should be valid for any miner, disable transactions as fallback
+    if (transfers.size() > 0 && !BodyContainer(serialize(Address(std::array<uint8_t, 20> {}), {}, false)).view(h).valid()) {
+        spdlog::warn("Block template invalid, mining without transactions");
+        newAddresses.clear();
+        newAddressLeaves.clear();
+        transfers = {};
+        records.clear();
+    }
+}
+
+std::optional<AccountId> BlockTemplate::lookup(const ChainDB& db, const Address& a)
+{
+    if (auto iter { accountIds.find(a) }; iter != accountIds.end())
+        return iter->second;
+    if (unknown.contains(a))
+        return {};
+    if (auto p { db.lookup_address(a) }) {
+        auto [id, _] = *p;
+        accountIds.emplace(a, id);
+        return id;
+    }
+    unknown.insert(a);
+    return {};
+}
+
+std::optional<AccountId> BlockTemplate::resolve(const ChainDB& db, const Address& a, bool allowNew)
+{
+    if (auto id { lookup(db, a) })
+        return id;
+    for (size_t i = 0; i < newAddresses.size(); ++i) {
+        if (newAddresses[i] == a)
+            return nextStateId + i;
+    }
+    if (!allowNew)
+        return {};
+    newAddresses.push_back(a);
+    newAddressLeaves.push_back(hashSHA256(a));
+    return nextStateId + (newAddresses.size() - 1);
+}
+
+void BlockTemplate::select(const ChainDB& db, const mempool::Mempool& mempool)
+{
+    std::vector<Hash> hashes;
+    auto payments { mempool.get_payments(MAXTRANSFERS, *height, &hashes) };
+
+    newAddresses.clear();
+    newAddressLeaves.clear();
+    transfers = {};
+    merkle = {};
+    std::map<Hash, Record> selected;
+
+    // same policy as generate_body, except that a new miner address
+    // always fits
+    for (size_t i = 0; i < payments.size(); ++i) {
+        auto& pmsg { payments[i] };
+        size_t size { body_size(newAddresses.size(), transfers.size()) };
+        assert(size <= MAXBLOCKSIZE);
+        size_t remaining = MAXBLOCKSIZE - size;
+        if (remaining < TRANSFERSIZE + 20) // keep space for a new miner address
+            break;
+        bool allowNewAddress { remaining >= TRANSFERSIZE + 40 };
+        const size_t nNew { newAddresses.size() };
+        auto toId { resolve(db, pmsg.toAddr, allowNewAddress) };
+        if (toId == pmsg.from_id()) {
+            spdlog::warn("Impossible self send detected.");
+            continue;
+        }
+        if (!toId)
+            break;
+
+        const Record* r { nullptr };
+        if (auto iter { records.find(hashes[i]) }; iter != records.end()
+            && iter->second.toId == *toId
+            && memcmp(iter->second.bytes.data() + 34, pmsg.signature.serialize().data(), 65) == 0) {
+            r = &iter->second;
+        } else {
+            auto pn = PinNonce::make_pin_nonce(pmsg.nonce_id(), *height, pmsg.pin_height());
+            if (!pn)
+                throw std::runtime_error("Cannot make pin_nonce");
+            Record n { .toId = *toId, .bytes {}, .leaf {} };
+            Writer w(n.bytes.data(), n.bytes.size());
+            w << pmsg.from_id() // 8
+              << *pn // 8
+              << pmsg.compactFee // 2
+              << *toId // 8
+              << pmsg.amount // 8
+              << pmsg.signature; // 65
+            assert(w.remaining() == 0);
+            n.leaf = hashSHA256(n.bytes);
+            r = &records.insert_or_assign(hashes[i], n).first->second;
+        }
+        if (newAddresses.size() == nNew) // recipient id does not depend on position
+            selected.emplace(hashes[i], *r);
+
+        transfers.bytes.insert(transfers.bytes.end(), r->bytes.begin(), r->bytes.end());
+        transfers.leaves.push_back(r->leaf);
+        transfers.totalFee.add_assert(pmsg.fee());
+    }
+    records = std::move(selected);
+}
+
+std::vector<uint8_t> BlockTemplate::serialize(const Address& miner, std::optional<AccountId> minerId, bool disableTxs) const
+{
+    const Transfers& trs { disableTxs ? noTransfers : transfers };
+    const size_t nTransferAddresses { disableTxs ? 0 : newAddresses.size() };
+    const size_t nAddresses { nTransferAddresses + (minerId ? 0 : 1) };
+
+    std::vector<uint8_t> out(body_size(nAddresses, trs.size()));
+    assert(out.size() <= MAXBLOCKSIZE); // space for the miner address is reserved
+    Writer w(out.data(), out.size());
+    w.skip(10); // seed bytes
+    w << uint16_t(nAddresses);
+    for (size_t i = 0; i < nTransferAddresses; ++i)
+        w << Range(newAddresses[i]);
+    if (!minerId) {
+        w << Range(miner);
+        minerId = nextStateId + nTransferAddresses;
+    }
+    w << *minerId << Funds::sum_assert(height->reward(), trs.totalFee).E8();
+    if (trs.size() > 0)
+        w << uint32_t(trs.size()) << Range(trs.bytes);
+    assert(w.remaining() == 0);
+    return out;
+}
+
+auto BlockTemplate::body(const ChainDB& db, const Address& miner, bool disableTxs) -> Body
+{
+    assert(height.has_value());
+    const Transfers& trs { disableTxs ? noTransfers : transfers };
+    const size_t nTransferAddresses { disableTxs ? 0 : newAddresses.size() };
+    auto minerId { disableTxs ? lookup(db, miner) : resolve(db, miner, false) };
+    auto out { serialize(miner, minerId, disableTxs) };
+
+    std::vector<Hash> prefix;
+    prefix.reserve(nTransferAddresses + 2);
+    prefix.insert(prefix.end(), newAddressLeaves.begin(), newAddressLeaves.begin() + nTransferAddresses);
+    if (!minerId)
+        prefix.push_back(hashSHA256(miner));
+    const size_t offsetReward { 10 + 2 + 20 * prefix.size() };
+    prefix.push_back(hashSHA256(out.data() + offsetReward, 16));
+
+    auto root { merkle_root(std::move(prefix), trs, out.data()) };
+    return { std::move(out), root };
+}
+
+Hash BlockTemplate::merkle_root(std::vector<Hash> prefix, const Transfers& trs, const uint8_t* seed)
+{
+    const size_t k { prefix.size() };
+    const size_t n { k + trs.size() };
+    if (merkle.prefix != k || merkle.transfers != trs.size()) {
+        // full build
+        merkle = { .prefix = k, .transfers = trs.size(), .levels {} };
+        std::vector<Hash> level(std::move(prefix));
+        level.insert(level.end(), trs.leaves.begin(), trs.leaves.end());
+        merkle.levels.push_back(std::move(level));
+        while (merkle.levels.back().size() > 2) {
+            auto& l { merkle.levels.back() };
+            std::vector<Hash> next((l.size() + 1) / 2);
+            const size_t pairs { l.size() / 2 };
+            sha256::hash_batch(l[0].data(), 64, 64, pairs, next.data());
+            if (l.size() % 2 != 0)
+                next.back() = hashSHA256(l.back());
+            merkle.levels.push_back(std::move(next));
+        }
+    } else {
+        // only nodes covering the first k leaves change
+        auto& leaves { merkle.levels[0] };
+        assert(leaves.size() == n);
+        std::copy(prefix.begin(), prefix.end(), leaves.begin());
+        for (size_t j = 1; j < merkle.levels.size(); ++j) {
+            const size_t last { (k - 1) >> j };
+            for (size_t i = 0; i <= last; ++i)
+                merkle.levels[j][i] = parent(merkle.levels[j - 1], i);
+        }
+    }
+    return BodyView::seeded_merkle_root(merkle.levels.back(), seed, *height);
+}
+}
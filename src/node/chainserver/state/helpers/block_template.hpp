@@ -0,0 +1,83 @@
+#pragma once
+#include "block/body/container.hpp"
+#include "block/body/primitives.hpp"
+#include "general/funds.hpp"
+#include <map>
+#include <set>
+#include <vector>
+
+class ChainDB;
+namespace mempool {
+class Mempool;
+}
+
+namespace chainserver {
+// Best block template, kept across mining tasks. The transfer selection
+// is redone only when the chain or the mempool changed. Serialized
+// transfers with their merkle leaves are reused within a pin window and
+// recipient account ids are reused across appends. A mining task only
+// writes the address and reward sections for its miner and rehashes the
+// leftmost merkle path.
+class BlockTemplate {
+public:
+    struct Validity {
+        int db { -1 };
+        int mempool { -1 };
+        bool operator==(const Validity&) const = default;
+    };
+    struct Body {
+        BodyContainer body;
+        Hash merkleRoot;
+    };
+
+    void update(const ChainDB&, const mempool::Mempool&, NonzeroHeight, Validity);
+    [[nodiscard]] Body body(const ChainDB&, const Address& miner, bool disableTxs);
+
+    // account ids may be reassigned after a rollback
+    void on_rollback();
+
+private:
+    struct Record {
+        AccountId toId;
+        std::array<uint8_t, 99> bytes;
+        Hash leaf;
+    };
+    struct Transfers {
+        size_t size() const { return leaves.size(); }
+        std::vector<uint8_t> bytes;
+        std::vector<Hash> leaves;
+        Funds totalFee { Funds::zero() };
+    };
+    // merkle levels for a given number of leaves before the transfers,
+    // only nodes covering those leaves change between miners
+    struct MerkleCache {
+        size_t prefix { 0 };
+        size_t transfers { 0 };
+        std::vector<std::vector<Hash>> levels;
+    };
+
+    static const Transfers noTransfers;
+
+    std::optional<AccountId> lookup(const ChainDB&, const Address&);
+    std::optional<AccountId> resolve(const ChainDB&, const Address&, bool allowNew);
+    void select(const ChainDB&, const mempool::Mempool&);
+    std::vector<uint8_t> serialize(const Address& miner, std::optional<AccountId> minerId, bool disableTxs) const;
+    Hash merkle_root(std::vector<Hash> prefix, const Transfers&, const uint8_t* seed);
+
+    Validity validity;
+    std::optional<NonzeroHeight> height;
+    std::optional<PinFloor> pinFloor;
+    AccountId nextStateId { 0 };
+
+    // recipient resolution
+    std::map<Address, AccountId, Address::Comparator> accountIds; // existing accounts
+    std::set<Address, Address::Comparator> unknown; // not in chain, until the next chain change
+
+    // current selection
+    std::vector<Address> newAddresses;
+    std::vector<Hash> newAddressLeaves;
+    Transfers transfers;
+    std::map<Hash, Record> records; // by transaction hash, for the current pin floor
+    MerkleCache merkle;
+};
+}
@@ -19,6 +19,8 @@ Chainstate::Chainstate(
     , historyOffsets(std::move(std::get<1>(init)))
     , accountOffsets(std::move(std::get<2>(init)))
     , chainTxIds(db.fetch_tx_ids(length()))
+    , _mempool(true, config().node.mempoolMaxSize)
+    , _richlist(db)
 {
     assert(this->historyOffsets.size() == headerchain.length());
     spdlog::info("Cache has {} entries", chainTxIds.size());
@@ -38,6 +40,9 @@ void Chainstate::fork(Chainstate::ForkData&& fd)
     // increment descriptor
     dsc += 1;
 
+    // forget accounts created after the fork point
+    _richlist.erase_from(accountOffsets.at(forkHeight.nonzero_assert()));
+
     // adapt header chain and offsets
     headerchain = std::move(fd.stage);
     historyOffsets.shrink(fd.rollbackResult.shrinkLength);
@@ -56,6 +61,7 @@ void Chainstate::fork(Chainstate::ForkData&& fd)
     balanceUpdates.merge(fd.rollbackResult.balanceUpdates);
     for (auto& [accountId, balance] : balanceUpdates)
         _mempool.set_balance(accountId, balance);
+    _richlist.update(balanceUpdates);
 
     //////////////////////////////
     // insert transactions into mempool
@@ -95,6 +101,9 @@ auto Chainstate::rollback(const RollbackResult& rb) -> HeaderchainRollback
     // increment descriptor
     dsc += 1;
 
+    // forget accounts created after the fork point
+    _richlist.erase_from(accountOffsets.at(forkHeight.nonzero_assert()));
+
     // adapt header chain and offsets
     headerchain.shrink(rb.shrinkLength);
     historyOffsets.shrink(rb.shrinkLength);
@@ -119,6 +128,7 @@ auto Chainstate::rollback(const RollbackResult& rb) -> HeaderchainRollback
     auto& balanceUpdates { rb.balanceUpdates };
     for (auto& [accountId, balance] : balanceUpdates)
         _mempool.set_balance(accountId, balance);
+    _richlist.update(balanceUpdates);
 
     //////////////////////////////
     // insert transactions into mempool
@@ -162,6 +172,7 @@ auto Chainstate::append(AppendMulti ad) -> HeaderchainAppend
     auto& balanceUpdates { ad.appendResult.balanceUpdates };
     for (auto& [accountId, balance] : balanceUpdates)
         _mempool.set_balance(accountId, balance);
+    _richlist.update(balanceUpdates);
 
     // remove from mempool
     // remove outdated transactions
@@ -196,6 +207,7 @@ auto Chainstate::append(AppendSingle d) -> HeaderchainAppend
     auto& balanceUpdates { d.balanceUpdates };
     for (auto& [accountId, balance] : balanceUpdates)
         _mempool.set_balance(accountId, balance);
+    _richlist.update(balanceUpdates);
 
     // remove from mempool
     // remove outdated transactions
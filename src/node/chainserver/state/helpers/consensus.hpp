@@ -1,5 +1,6 @@
 #pragma once
 #include "../../account_cache.hpp"
+#include "../../richlist.hpp"
 #include "../../transaction_ids.hpp"
 #include "../update/update.hpp"
 #include "block/body/account_id.hpp"
@@ -73,6 +74,8 @@ struct Chainstate {
     Descriptor descriptor() const { return dsc; }
     const auto& txids() const { return chainTxIds; }
     const auto& mempool() const { return _mempool; }
+    auto richlist() { return _richlist.get(); }
+    const auto& history_offsets() const { return historyOffsets; }
     inline auto historyOffset(NonzeroHeight height) const
     {
         return historyOffsets.at(height);
@@ -100,6 +103,7 @@ private:
     AccountHeights accountOffsets;
     TransactionIds chainTxIds; // replay protection
     mempool::Mempool _mempool;
+    Richlist _richlist;
 };
 
 }
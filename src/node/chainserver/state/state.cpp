@@ -1,13 +1,13 @@
 #include "state.hpp"
 #include "api/http//endpoint.hpp"
 #include "api/types/all.hpp"
-#include "block/body/generator.hpp"
 #include "block/body/parse.hpp"
 #include "block/body/rollback.hpp"
 #include "block/body/view.hpp"
 #include "block/chain/history/history.hpp"
 #include "block/header/generator.hpp"
 #include "block/header/header_impl.hpp"
+#include "chainserver/chain_query.hpp"
 #include "communication/create_payment.hpp"
 #include "db/chain_db.hpp"
 #include "eventloop/types/chainstate.hpp"
@@ -20,111 +20,18 @@
 #include <ranges>
 namespace chainserver {
 
-void MiningCache::update_validity(CacheValidity cv)
-{
-    if (cacheValidity != cv)
-        cache.clear();
-    cacheValidity = cv;
-}
-const BodyContainer* MiningCache::lookup(const Address& a, bool disableTxs) const
-{
-    auto iter { std::find_if(cache.begin(), cache.end(), [&](const Item& i) {
-        return i.address == a && i.disableTxs == disableTxs;
-    }) };
-    if (iter != cache.end())
-        return &iter->b;
-    return nullptr;
-}
-
-const BodyContainer& MiningCache::insert(const Address& a, bool disableTxs, BodyContainer b)
-{
-    cache.push_back({ a, disableTxs, std::move(b) });
-    return cache.back().b;
-}
-
-State::State(ChainDB& db, BatchRegistry& br, std::optional<SnapshotSigner> snapshotSigner)
+State::State(ChainDB& db, BatchRegistry& br, WorkerPool& verifierPool, std::optional<SnapshotSigner> snapshotSigner)
     : db(db)
     , batchRegistry(br)
     , snapshotSigner(std::move(snapshotSigner))
     , signedSnapshot(db.get_signed_snapshot())
     , chainstate(db, br)
     , nextGarbageCollect(std::chrono::steady_clock::now())
-    , _miningCache(mining_cache_validity())
-{
-}
-
-std::optional<std::pair<NonzeroHeight, Header>> State::get_header(Height h) const
-{
-    if (auto p { chainstate.headers().get_header(h) }; p.has_value())
-        return std::pair<NonzeroHeight, Header> { h.nonzero_assert(), Header(p.value()) };
-    return {};
-}
-
-auto State::api_get_header(API::HeightOrHash& hh) const -> std::optional<std::pair<NonzeroHeight, Header>>
-{
-    if (std::holds_alternative<Height>(hh.data)) {
-        return get_header(std::get<Height>(hh.data));
-    }
-    auto h { consensus_height(std::get<Hash>(hh.data)) };
-    if (!h.has_value())
-        return {};
-    return get_header(*h);
-}
-
-std::optional<NonzeroHeight> State::consensus_height(const Hash& hash) const
-{
-    auto o { db.lookup_block_height(hash) };
-    if (!o.has_value())
-        return {};
-    auto& h { o.value() };
-    auto hash2 { chainstate.headers().get_hash(h) };
-    if (!hash2.has_value() || *hash2 != hash)
-        return {};
-    return h;
-}
-
-std::optional<Hash> State::get_hash(Height h) const
-{
-    return chainstate.headers().get_hash(h);
-}
-
-std::optional<API::Block> State::api_get_block(const API::HeightOrHash& hh) const
-{
-    if (std::holds_alternative<Height>(hh.data)) {
-        return api_get_block(std::get<Height>(hh.data));
-    }
-    auto h { consensus_height(std::get<Hash>(hh.data)) };
-    if (!h.has_value())
-        return {};
-    return api_get_block(*h);
-}
-
-std::optional<API::Block> State::api_get_block(Height zh) const
-{
-    if (zh == 0 || zh > chainlength())
-        return {};
-    auto h { zh.nonzero_assert() };
-    PinFloor pinFloor { PrevHeight(h) };
-    auto lower = chainstate.historyOffset(h);
-    auto upper = (h == chainlength() ? HistoryId { 0 }
-                                     : chainstate.historyOffset(h + 1));
-    auto entries = db.lookupHistoryRange(lower, upper);
-    auto header = chainstate.headers()[h];
-    API::Block b(header, h, chainlength() - h + 1);
-
-    chainserver::AccountCache cache(db);
-    for (auto [hash, data] : entries) {
-        b.push_history(hash, data, cache, pinFloor);
-    }
-    return b;
-}
-
-auto State::api_tx_cache() const -> const TransactionIds
+    , verifierPool(verifierPool)
 {
-    return chainstate.txids();
 }
 
-std::optional<API::Transaction> State::api_get_tx(const HashView txHash) const
+std::optional<API::Transaction> State::api_get_mempool_tx(const HashView txHash) const
 {
     if (auto p = chainstate.mempool()[txHash]; p) {
         auto& tx = *p;
@@ -141,40 +48,6 @@ std::optional<API::Transaction> State::api_get_tx(const HashView txHash) const
             .pinHeight = tx.pin_height(),
         };
     }
-    auto p = db.lookup_history(txHash);
-    if (p) {
-        auto& [data, historyIndex] = *p;
-        if (data.size() == 0)
-            return {};
-        auto parsed { history::parse_throw(data) };
-        NonzeroHeight h { chainstate.history_height(historyIndex) };
-        if (std::holds_alternative<history::TransferData>(parsed)) {
-            auto& d = std::get<history::TransferData>(parsed);
-            return API::TransferTransaction {
-                .txhash = txHash,
-                .toAddress = db.fetch_account(d.toAccountId).address,
-                .confirmations = (chainlength() - h) + 1,
-                .height = h,
-                .timestamp = chainstate.headers()[h].timestamp(),
-                .amount = d.amount,
-                .fromAddress = db.fetch_account(d.fromAccountId).address,
-                .fee = d.compactFee.uncompact(),
-                .nonceId = d.pinNonce.id,
-                .pinHeight = d.pinNonce.pin_height((PinFloor(PrevHeight(h))))
-            };
-        } else {
-            assert(std::holds_alternative<history::RewardData>(parsed));
-            auto& d = std::get<history::RewardData>(parsed);
-            return API::RewardTransaction {
-                .txhash = txHash,
-                .toAddress = db.fetch_account(d.toAccountId).address,
-                .confirmations = (chainlength() - h) + 1,
-                .height = h,
-                .timestamp = chainstate.headers()[h].timestamp(),
-                .amount = d.miningReward
-            };
-        }
-    }
     return {};
 }
 
@@ -183,49 +56,14 @@ auto State::api_get_transaction_minfee() -> API::TransactionMinfee
     return { chainstate.mempool().min_fee() };
 }
 
-auto State::api_get_latest_txs(size_t N) const -> API::TransactionsByBlocks
-{
-    HistoryId upper { db.next_history_id() };
-    // note: history ids start with 1
-    HistoryId lower { (upper.value() > N + 1) ? db.next_history_id() - N : HistoryId { 1 } };
-    API::TransactionsByBlocks res { .fromId { lower }, .blocks_reversed {} };
-    if (upper.value() == 0)
-        return res;
-    auto lookup { db.lookupHistoryRange(lower, upper) };
-    assert(lookup.size() == upper - lower);
-    if (chainlength() != 0) {
-        chainserver::AccountCache cache(db);
-        auto update_tmp = [&](auto id) {
-            auto h { chainstate.history_height(id) };
-            PinFloor pinFloor { PrevHeight(h) };
-            auto header { chainstate.headers()[h] };
-            auto b { API::Block(header, h, chainlength() - h + 1) };
-            auto beginId { chainstate.historyOffset(h) };
-            return std::tuple { pinFloor, beginId, b };
-        };
-        auto tmp { update_tmp(upper - 1) };
-
-        for (size_t i = 0; i < lookup.size(); ++i) {
-            auto& [pinFloor, beginId, block] { tmp };
-            auto id { upper - 1 - i };
-            if (id < beginId) { // start new tmp block
-                res.blocks_reversed.push_back(block);
-                tmp = update_tmp(id);
-            }
-
-            auto& [hash, data] = lookup[lookup.size() - 1 - i];
-            block.push_history(hash, data, cache, pinFloor);
-        }
-        res.count = lookup.size();
-        res.blocks_reversed.push_back(std::get<2>(tmp));
-    }
-    return res;
-}
-
 void State::garbage_collect()
 {
     // garbage collect old unused blocks
     using namespace std::chrono;
+    // compaction removes segment files on commit, this must wait until
+    // commits are durable again (see ChainDB::garbage_collect_blocks)
+    if (bulkSync.active || db.group_open())
+        return;
     if (auto n = steady_clock::now(); n > nextGarbageCollect) {
         nextGarbageCollect = n + minutes(5);
         auto tr = db.transaction();
@@ -262,55 +100,33 @@ ConsensusSlave State::get_chainstate_concurrent()
 
 tl::expected<ChainMiningTask, Error> State::mining_task(const Address& a)
 {
-    return mining_task(a, config().node.disableTxsMining);
+    return std::move(mining_tasks({ a }).front());
 }
 
-tl::expected<ChainMiningTask, Error> State::mining_task(const Address& a, bool disableTxs)
+auto State::mining_tasks(const std::vector<Address>& addresses) -> std::vector<tl::expected<ChainMiningTask, Error>>
 {
-
     auto md = chainstate.mining_data();
 
     NonzeroHeight height { next_height() };
     if (height.value() < NEWBLOCKSTRUCUTREHEIGHT && !is_testnet())
-        return tl::make_unexpected(Error(ENOTSYNCED));
-
-    auto make_body {
-        [&]() {
-            std::vector<TransferTxExchangeMessage> payments;
-            if (!disableTxs) {
-                payments = chainstate.mempool().get_payments(400, height);
-            }
-
-            Funds totalfee { Funds::zero() };
-            for (auto& p : payments)
-                totalfee.add_assert(p.fee()); // assert because
-            // fee sum is < sum of mempool payers' balances
-
-            // mempool should have deleted out of window transactions
-            auto body { generate_body(db, height, a, payments) };
-            return body;
-        }
-    };
-
-    const auto& b {
-        [&]() {
-            _miningCache.update_validity(mining_cache_validity());
-            if (auto* p { _miningCache.lookup(a, disableTxs) }; p != nullptr) {
-                return *p;
-            } else
-                return _miningCache.insert(a, disableTxs, make_body());
-        }()
-    };
-    auto bv { b.view(height) };
-    if (!bv.valid())
-        spdlog::error("Cannot create mining task, body invalid");
-
-    HeaderGenerator hg(md.prevhash, bv, md.target, md.timestamp, height);
-    return ChainMiningTask { .block {
-        .height = height,
-        .header = hg.serialize(0),
-        .body = bv.span(),
-    } };
+        return std::vector<tl::expected<ChainMiningTask, Error>>(addresses.size(), tl::make_unexpected(Error(ENOTSYNCED)));
+
+    // mempool should have deleted out of window transactions
+    blockTemplate.update(db, chainstate.mempool(), height, { dbCacheValidity, chainstate.mempool().cache_validity() });
+    const bool disableTxs { config().node.disableTxsMining };
+
+    std::vector<tl::expected<ChainMiningTask, Error>> res;
+    res.reserve(addresses.size());
+    for (auto& a : addresses) {
+        auto b { blockTemplate.body(db, a, disableTxs) };
+        HeaderGenerator hg(md.prevhash, b.merkleRoot, md.target, md.timestamp, height);
+        res.push_back(ChainMiningTask { .block {
+            .height = height,
+            .header = hg.serialize(0),
+            .body = std::move(b.body),
+        } });
+    }
+    return res;
 }
 
 stage_operation::StageSetResult State::set_stage(Headerchain&& hc)
@@ -367,11 +183,29 @@ auto State::add_stage(const std::vector<Block>& blocks, const Headerchain& hc) -
 
     assert(blocks.size() > 0);
     ChainError err { Error(0), blocks.back().height + 1 };
+    update_bulk_sync(hc);
     auto transaction = db.transaction();
+    if (db.group_open())
+        bulkSync.groupBlocks += blocks.size();
 
     assert(hc.length() >= stage.length());
     assert(hc.hash_at(stage.length()) == stage.hash_at(stage.length()));
-    for (auto& b : blocks) {
+
+    // check bodies in parallel
+    const auto start { std::chrono::steady_clock::now() };
+    std::vector<int32_t> bodyErrors(blocks.size(), 0);
+    verifierPool.parallel_for(blocks.size(), [&](size_t i) {
+        auto& b { blocks[i] };
+        BodyView bv(b.body_view());
+        if (b.header.merkleroot() != bv.merkle_root(b.height))
+            bodyErrors[i] = EMROOT;
+        else if (!bv.valid())
+            bodyErrors[i] = EINV_BODY;
+    });
+    syncPipelineCounters.on_check(blocks.size(), std::chrono::steady_clock::now() - start);
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        auto& b { blocks[i] };
         assert(hc.length() >= b.height);
         assert(hc[b.height] == b.header);
 
@@ -382,13 +216,8 @@ auto State::add_stage(const std::vector<Block>& blocks, const Headerchain& hc) -
             err = { prepared.error(), b.height };
             break;
         }
-        BodyView bv(b.body_view());
-        if (b.header.merkleroot() != bv.merkle_root(b.height)) {
-            err = { EMROOT, b.height };
-            break;
-        }
-        if (!bv.valid()) {
-            err = { EINV_BODY, b.height };
+        if (bodyErrors[i] != 0) {
+            err = { bodyErrors[i], b.height };
             break;
         }
         db.insert_protect(b);
@@ -409,6 +238,96 @@ auto State::add_stage(const std::vector<Block>& blocks, const Headerchain& hc) -
     }
 }
 
+void State::update_bulk_sync(const Headerchain& target)
+{
+    const size_t distance { config().node.bulkSyncDistance };
+    const size_t behind { target.length().value() - stage.length().value() };
+    const bool bulk { distance != 0 && behind > distance };
+    if (auto deadline { group_commit_deadline() }) {
+        if (!bulk || bulkSync.groupBlocks >= GROUPBLOCKS || std::chrono::steady_clock::now() >= *deadline)
+            commit_group();
+    }
+    if (bulk != bulkSync.active) {
+        set_bulk_sync(bulk);
+        if (bulk) {
+            spdlog::info("Bulk sync enabled, {} blocks behind", behind);
+            // rebuilding the indices pays off when most rows are still to come
+            if (behind > stage.length().value())
+                db.defer_indexing();
+        }
+    }
+    if (bulk && !db.group_open()) {
+        db.begin_group();
+        bulkSync.groupBlocks = 0;
+        bulkSync.groupStart = std::chrono::steady_clock::now();
+    }
+}
+
+void State::set_bulk_sync(bool active)
+{
+    bulkSync.active = active;
+    db.set_relaxed_durability(active);
+    if (active) {
+        indexBuild.active = false; // resumed when bulk sync ends
+    } else {
+        spdlog::info("Bulk sync disabled, full durability restored");
+        start_index_build();
+    }
+}
+
+void State::start_index_build()
+{
+    if (indexBuild.active || !db.indexing_deferred())
+        return;
+    spdlog::info("Building transaction indices in the background.");
+    indexBuild.active = true;
+    indexBuild.start = indexBuild.lastLog = std::chrono::steady_clock::now();
+}
+
+void State::build_indices_step()
+{
+    assert(indexBuild.active);
+    const auto now { std::chrono::steady_clock::now() };
+    if (auto next { db.build_indices_step(INDEXSTEPROWS) }) {
+        if (now - indexBuild.lastLog >= std::chrono::seconds(10)) {
+            indexBuild.lastLog = now;
+            spdlog::info("Building transaction indices: {:.1f}%",
+                100.0 * next->value() / db.next_history_id().value());
+        }
+    } else {
+        indexBuild.active = false;
+        std::chrono::duration<double> elapsed { now - indexBuild.start };
+        spdlog::info("Built transaction indices in {:.1f} seconds.", elapsed.count());
+    }
+}
+
+auto State::group_commit_deadline() const -> std::optional<tp>
+{
+    if (!db.group_open())
+        return {};
+    return bulkSync.groupStart + GROUPDURATION;
+}
+
+void State::commit_group()
+{
+    if (!db.group_open())
+        return;
+    const auto start { std::chrono::steady_clock::now() };
+    db.commit_group();
+    syncPipelineCounters.on_commit(std::chrono::steady_clock::now() - start);
+    refresh_snapshot(); // readers see the committed group, a new group may open right away
+    spdlog::debug("Committed group of {} blocks", bulkSync.groupBlocks);
+}
+
+void State::end_bulk_sync()
+{
+    commit_group();
+    if (bulkSync.active)
+        set_bulk_sync(false);
+    else
+        start_index_build(); // deferred before a restart
+}
+
 RollbackResult State::rollback(const Height newlength) const
 {
     spdlog::info("Rolling back chain");
@@ -432,7 +351,7 @@ RollbackResult State::rollback(const Height newlength) const
             throw std::runtime_error("Database corrupted (could not load block)");
         auto& [header, body, undo] = *u;
 
-        BodyView bv(body, height);
+        BodyView bv(body.span(), height);
         if (!bv.valid())
             throw std::runtime_error(
                 "Database corrupted (invalid block body at height " + std::to_string(height) + ".");
@@ -448,7 +367,7 @@ RollbackResult State::rollback(const Height newlength) const
         }
 
         // roll back state modifications
-        RollbackView rbv(undo);
+        RollbackView rbv(undo.span());
         if (i == 0) {
             oldAccountStart = rbv.getBeginNewAccounts();
         }
@@ -466,9 +385,7 @@ RollbackResult State::rollback(const Height newlength) const
     db.delete_state_from(*oldAccountStart);
     auto dk { db.delete_consensus_from((newlength + 1).nonzero_assert()) };
     // write balances to db
-    for (auto& p : balanceMap) {
-        db.set_balance(p.first, p.second);
-    }
+    db.set_balances({ balanceMap.begin(), balanceMap.end() });
     return chainserver::RollbackResult {
         .shrinkLength { newlength },
         .toMempool { std::move(toMempool) },
@@ -548,6 +465,7 @@ auto State::apply_signed_snapshot(SignedSnapshot&& ssnew) -> std::optional<State
     if (!signedSnapshot->compatible(chainstate.headers())) {
         assert(signedSnapshot->height() <= chainlength());
         auto rb { rollback(signedSnapshot->height() - 1) };
+        blockTemplate.on_rollback();
 
         std::unique_lock<std::mutex> ul(chainstateMutex);
         auto headers_ptr { blockCache.add_old_chain(chainstate, rb.deletionKey) };
@@ -599,7 +517,7 @@ auto State::append_mined_block(const Block& b) -> StateUpdate
         throw Error(EMINEDDEPRECATED);
     }
 
-    chainserver::BlockApplier e { db, chainstate.headers(), chainstate.txids(), false };
+    chainserver::BlockApplier e { db, chainstate.headers(), chainstate.txids(), verifierPool, false };
     auto apiBlock { e.apply_block(bv, b.header, nextHeight, blockId) };
     http_endpoint().push_event(apiBlock);
     db.set_consensus_work(chainstate.work_with_new_block());
@@ -637,40 +555,6 @@ std::pair<mempool::Log, TxHash> State::append_gentx(const PaymentCreateMessage&
     }
 }
 
-API::Balance State::api_get_address(AddressView address)
-{
-    if (auto p = db.lookup_address(address); p) {
-        return API::Balance {
-            address,
-            p->accointId,
-            p->funds
-        };
-    } else {
-        return API::Balance {
-            {},
-            AccountId { 0 },
-            Funds { Funds::zero() }
-        };
-    }
-}
-
-API::Balance State::api_get_address(AccountId accountId)
-{
-    if (auto p = db.lookup_account(accountId); p) {
-        return API::Balance {
-            p->address,
-            accountId,
-            p->funds
-        };
-    } else {
-        return API::Balance {
-            {},
-            AccountId { 0 },
-            Funds { Funds::zero() }
-        };
-    }
-}
-
 size_t State::on_mempool_constraint_update()
 {
     return chainstate.on_mempool_constraint_update();
@@ -706,6 +590,58 @@ API::ChainHead State::api_get_head() const
     };
 }
 
+Height State::assumed_valid_height(const Headerchain& hc) const
+{
+    auto& av { config().node.assumeValid };
+    std::optional<std::pair<NonzeroHeight, Hash>> block;
+    if (av && av->block)
+        block = av->block;
+    else if (av && signedSnapshot)
+        block = std::pair { signedSnapshot->height(), signedSnapshot->hash };
+    if (!block || hc.length() < block->first)
+        return Height(0);
+    auto& [height, hash] { *block };
+    const bool active { hc.hash_at(height) == hash };
+    const std::tuple status { height, hash, active };
+    if (assumeValidLogged != status) {
+        assumeValidLogged = status;
+        if (active)
+            spdlog::info("Assume-valid active, not checking transfer signatures up to height {} (block {})",
+                height.value(), serialize_hex(hash));
+        else
+            spdlog::warn("Assume-valid block {} at height {} is not in the best chain, checking all transfer signatures",
+                serialize_hex(hash), height.value());
+    }
+    return active ? Height(height) : Height(0);
+}
+
+auto State::chain_snapshot() -> std::shared_ptr<const ChainSnapshot>
+{
+    // API readers use their own connections and cannot see an open group
+    if (!snapshot || !db.group_open())
+        refresh_snapshot();
+    return snapshot;
+}
+
+void State::refresh_snapshot()
+{
+    auto outdated = [&](const ChainSnapshot& s) {
+        auto& ss { s.head.signedSnapshot };
+        return s.descriptor != chainstate.descriptor()
+            || s.length() != chainlength()
+            || ss.has_value() != signedSnapshot.has_value()
+            || (ss && ss->priority != signedSnapshot->priority);
+    };
+    if (!snapshot || outdated(*snapshot)) {
+        snapshot = std::make_shared<const ChainSnapshot>(ChainSnapshot {
+            .descriptor { chainstate.descriptor() },
+            .headers { chainstate.headers() },
+            .historyOffsets { chainstate.history_offsets() },
+            .head { api_get_head() },
+            .richlist { chainstate.richlist() } });
+    }
+}
+
 auto State::api_get_mempool(size_t n) -> API::MempoolEntries
 {
     std::vector<Hash> hashes;
@@ -720,54 +656,6 @@ auto State::api_get_mempool(size_t n) -> API::MempoolEntries
     return out;
 }
 
-auto State::api_get_history(Address a, uint64_t beforeId) -> std::optional<API::AccountHistory>
-{
-    auto p = db.lookup_address(a);
-    if (!p)
-        return {};
-    auto& [accountId, balance] = *p;
-
-    std::vector entries_desc = db.lookup_history_100_desc(accountId, beforeId);
-    std::vector<API::Block> blocks_reversed;
-    PinFloor pinFloor { 0 };
-    auto firstHistoryId = HistoryId { 0 };
-    auto nextHistoryOffset = HistoryId { 0 };
-    chainserver::AccountCache cache(db);
-
-    auto prevHistoryId = HistoryId { 0 };
-    for (auto iter = entries_desc.rbegin(); iter != entries_desc.rend(); ++iter) {
-        auto& [historyId, txid, data] = *iter;
-        if (firstHistoryId == HistoryId { 0 })
-            firstHistoryId = historyId;
-        assert(prevHistoryId < historyId);
-        prevHistoryId = historyId;
-        if (historyId >= nextHistoryOffset) {
-            auto height { chainstate.history_height(historyId) };
-            pinFloor = PinFloor(PrevHeight(height));
-            auto header = chainstate.headers()[height];
-            bool b = height == chainlength();
-            nextHistoryOffset = (b
-                    ? HistoryId { std::numeric_limits<uint64_t>::max() }
-                    : chainstate.historyOffset(height + 1));
-            blocks_reversed.push_back(
-                API::Block(header, height, 1 + (chainlength() - height)));
-        }
-        API::Block& b = blocks_reversed.back();
-        b.push_history(txid, data, cache, pinFloor);
-    }
-
-    return API::AccountHistory {
-        .balance = balance,
-        .fromId = firstHistoryId,
-        .blocks_reversed = blocks_reversed
-    };
-}
-
-auto State::api_get_richlist(size_t N) -> API::Richlist
-{
-    return db.lookup_richlist(N);
-}
-
 auto State::get_blocks(DescriptedBlockRange range) -> std::vector<BodyContainer>
 {
     assert(range.lower != 0);
@@ -787,7 +675,7 @@ auto State::get_blocks(DescriptedBlockRange range) -> std::vector<BodyContainer>
         auto hash { hashes[i] };
         auto b { db.get_block(hash) };
         if (b) {
-            res.push_back(std::move(b->second.body));
+            res.push_back(BodyContainer(b->second.body.span()));
         } else {
             spdlog::error("BUG: no block with hash {} in db.", serialize_hex(hash));
             return {};
@@ -806,6 +694,7 @@ auto State::commit_fork(RollbackResult&& rr, AppendBlocksResult&& abr) -> StateU
     assert(!signedSnapshot || signedSnapshot->compatible(stage));
     auto forkHeight { (rr.shrinkLength + 1).nonzero_assert() };
     auto headers_ptr { blockCache.add_old_chain(chainstate, rr.deletionKey) };
+    blockTemplate.on_rollback();
 
     chainstate.fork(chainserver::Chainstate::ForkData {
         .stage { stage },
@@ -856,9 +745,4 @@ std::optional<SignedSnapshot> State::try_sign_chainstate()
     return {};
 }
 
-MiningCache::CacheValidity State::mining_cache_validity()
-{
-    return { dbCacheValidity, chainstate.mempool().cache_validity(), now_timestamp() };
-}
-
 }
@@ -4,46 +4,20 @@
 #include "communication/messages.hpp"
 #include "communication/mining_task.hpp"
 #include "communication/stage_operation/result.hpp"
+#include "helpers/block_template.hpp"
 #include "helpers/consensus.hpp"
 #include "helpers/past_chains.hpp"
+#include "general/worker_pool.hpp"
+#include "transactions/block_pipeline.hpp"
 #include <chrono>
+#include <memory>
 
 class ChainDB;
 struct Block;
 
 class ChainDBTransaction;
 namespace chainserver {
-struct MiningCache {
-    struct CacheValidity {
-        int db { 0 };
-        int mempool { 0 };
-        uint32_t timestamp;
-        bool operator==(const CacheValidity&) const = default;
-        CacheValidity(int db, int mempool, uint32_t timestamp)
-            : db(db)
-            , mempool(mempool)
-            , timestamp(timestamp)
-        {
-        }
-    };
-    MiningCache(CacheValidity cacheValidity)
-        : cacheValidity(cacheValidity)
-    {
-    }
-
-    struct Item {
-        Address address;
-        bool disableTxs;
-        BodyContainer b;
-    };
-
-    CacheValidity cacheValidity;
-    uint32_t timestamp;
-    void update_validity(CacheValidity);
-    [[nodiscard]] const BodyContainer* lookup(const Address&, bool disableTxs) const;
-    const BodyContainer& insert(const Address& a, bool disableTxs, BodyContainer);
-    std::vector<Item> cache;
-};
+struct ChainSnapshot;
 class State {
     friend class ApplyStageTransaction;
     friend class SetSignedPinTransaction;
@@ -53,7 +27,7 @@ class State {
 
 public:
     // constructor/destructor
-    State(ChainDB& b, BatchRegistry&, std::optional<SnapshotSigner> snapshotSigner);
+    State(ChainDB& b, BatchRegistry&, WorkerPool& verifierPool, std::optional<SnapshotSigner> snapshotSigner);
 
     // concurrent methods
     Batch get_headers_concurrent(BatchSelector selector);
@@ -63,7 +37,8 @@ public:
     // normal methods
     void garbage_collect();
     auto mining_task(const Address& a) -> tl::expected<ChainMiningTask, Error>;
-    auto mining_task(const Address& a, bool disableTxs) -> tl::expected<ChainMiningTask, Error>;
+    // one block template is shared by all addresses
+    auto mining_tasks(const std::vector<Address>&) -> std::vector<tl::expected<ChainMiningTask, Error>>;
 
     auto append_gentx(const PaymentCreateMessage&) -> std::pair<mempool::Log, TxHash>;
     auto chainlength() const -> Height { return chainstate.headers().length(); }
@@ -87,34 +62,52 @@ public:
         }
     }
 
+    // Bulk sync: far behind the stage tip, stage additions are grouped
+    // into one database transaction with relaxed durability. A crash
+    // loses at most the open group, the database stays consistent.
+    // On initial sync indexing is deferred until bulk sync ends, the
+    // indices are then built in steps between events. All steps but
+    // the last, which creates the hash index in one go, are bounded.
+    static constexpr size_t GROUPBLOCKS = 1000;
+    static constexpr std::chrono::seconds GROUPDURATION { 10 };
+    static constexpr size_t INDEXSTEPROWS = 50000;
+    auto group_commit_deadline() const -> std::optional<std::chrono::steady_clock::time_point>;
+    void commit_group();
+    void end_bulk_sync();
+    bool index_build_pending() const { return indexBuild.active; }
+    void build_indices_step();
+
     // general getters
-    auto get_header(Height h) const -> std::optional<std::pair<NonzeroHeight, Header>>;
-    auto get_headers() const { return chainstate.headers(); }
-    auto get_hash(Height h) const -> std::optional<Hash>;
     auto get_blocks(DescriptedBlockRange) -> std::vector<BodyContainer>;
     auto get_mempool_tx(TransactionId) const -> std::optional<TransferTxExchangeMessage>;
 
-    // api getters
-    auto api_get_address(AddressView) -> API::Balance;
-    auto api_get_address(AccountId) -> API::Balance;
+    // snapshot of the chain for read-only API queries, shared
+    // until the chain changes, while a commit group is open it
+    // reflects the last committed group
+    auto chain_snapshot() -> std::shared_ptr<const ChainSnapshot>;
+
+    // api getters that need the writer's state
     auto api_get_head() const -> API::ChainHead;
-    auto api_get_history(Address a, uint64_t beforeId) -> std::optional<API::AccountHistory>;
-    auto api_get_richlist(size_t N) -> API::Richlist;
     auto api_get_mempool(size_t) -> API::MempoolEntries;
-    auto api_get_tx(HashView hash) const -> std::optional<API::Transaction>;
+    auto api_get_mempool_tx(HashView hash) const -> std::optional<API::Transaction>;
     auto api_get_transaction_minfee() -> API::TransactionMinfee;
-    auto api_get_latest_txs(size_t N = 100) const -> API::TransactionsByBlocks;
-    auto api_get_header(API::HeightOrHash& h) const -> std::optional<std::pair<NonzeroHeight, Header>>;
-    auto api_get_block(const API::HeightOrHash& h) const -> std::optional<API::Block>;
-    auto api_tx_cache() const -> const TransactionIds;
+    auto api_tx_cache() const -> const TransactionIds& { return chainstate.txids(); }
+
+    // can be called concurrently
+    SyncPipelineStats sync_pipeline_stats() const { return syncPipelineCounters.stats(); }
 
 private:
     void publish_websocket_events(const std::optional<StateUpdate>&, const std::vector<API::Block>&);
 
     // delegated getters
-    auto api_get_block(Height h) const -> std::optional<API::Block>;
-    std::optional<NonzeroHeight> consensus_height(const Hash&) const;
     NonzeroHeight next_height() const { return (chainlength() + 1).nonzero_assert(); }
+    // blocks up to the returned height are ancestors of the assumed valid block
+    Height assumed_valid_height(const Headerchain& hc) const;
+
+    void update_bulk_sync(const Headerchain& target);
+    void set_bulk_sync(bool active);
+    void start_index_build();
+    void refresh_snapshot();
 
     // transactions
     [[nodiscard]] auto apply_stage(ChainDBTransaction&& t) -> std::tuple<ChainError, std::optional<StateUpdate>, std::vector<API::Block>>;
@@ -132,7 +125,6 @@ private:
     [[nodiscard]] auto commit_fork(RollbackResult&& rr, AppendBlocksResult&&) -> StateUpdate;
     [[nodiscard]] auto commit_append(AppendBlocksResult&& abr) -> StateUpdate;
     std::optional<SignedSnapshot> try_sign_chainstate();
-    MiningCache::CacheValidity mining_cache_validity();
 
 private:
     using tp = std::chrono::steady_clock::time_point;
@@ -153,6 +145,21 @@ private:
     ExtendableHeaderchain stage;
     std::chrono::steady_clock::time_point nextGarbageCollect;
 
-    MiningCache _miningCache;
+    BlockTemplate blockTemplate;
+    std::shared_ptr<const ChainSnapshot> snapshot;
+    WorkerPool& verifierPool; // thread safe, shared with the header download
+    mutable SyncPipelineCounters syncPipelineCounters;
+    // assume-valid status logged last, only changes are logged
+    mutable std::optional<std::tuple<NonzeroHeight, Hash, bool>> assumeValidLogged;
+    struct BulkSync {
+        bool active { false };
+        size_t groupBlocks { 0 };
+        tp groupStart;
+    } bulkSync;
+    struct IndexBuild {
+        bool active { false };
+        tp start;
+        tp lastLog;
+    } indexBuild;
 };
 }
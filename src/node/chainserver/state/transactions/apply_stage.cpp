@@ -2,6 +2,7 @@
 #include "api/types/all.hpp"
 #include "block/body/view.hpp"
 #include "block_applier.hpp"
+#include "block_pipeline.hpp"
 #include "general/hex.hpp"
 #include "general/now.hpp"
 #include <fstream>
@@ -20,31 +21,33 @@ ApplyStageTransaction::ApplyStageTransaction(const State& s, ChainDBTransaction&
     applyResult = AppendBlocksResult {};
     auto& res { applyResult.value() };
     auto& baseTxIds { rb ? rb->chainTxIds : ccs.chainstate.txids() };
-    chainserver::BlockApplier ba { ccs.db, ccs.stage, baseTxIds, true };
+    chainserver::BlockApplier ba { ccs.db, ccs.stage, baseTxIds, ccs.verifierPool, true, ccs.assumed_valid_height(ccs.stage) };
+    const NonzeroHeight begin { (chainlength + 1).nonzero_assert() };
+    const auto start { std::chrono::steady_clock::now() };
+    auto record { [&]() { ccs.syncPipelineCounters.on_apply(chainlength.value() + 1 - begin.value(), std::chrono::steady_clock::now() - start); } };
+
+    // signatures of upcoming blocks are recovered while applying
+    BlockPipeline pipeline(ccs.db, ccs.stage, ccs.verifierPool, ccs.syncPipelineCounters,
+        begin, ba.assume_valid_height());
     std::vector<API::Block> apiBlocks;
-    for (NonzeroHeight h = (chainlength + 1).nonzero_assert(); h <= ccs.stage.length(); ++h) {
+    for (NonzeroHeight h = begin; h <= ccs.stage.length(); ++h) {
         auto historyId { ccs.db.next_history_id() };
         AccountId accountId { ccs.db.next_state_id() };
-        auto hash { ccs.stage.hash_at(h) };
-        auto p = ccs.db.get_block(hash);
-        if (!p) {
-            throw std::runtime_error("Bug at line " + std::to_string(__LINE__)
-                + ". Cannot get block with hash " + serialize_hex(hash)
-                + " at height " + std::to_string(h) + " from database.");
-        }
-        BlockId blockId { p->first };
-        Block& b = p->second;
-        BodyView bv(b.body.view(h));
+        auto item { pipeline.next() };
+        assert(item);
+        auto& b { item->block };
+        BodyView bv(b.body_view());
         assert(bv.valid());
 
         try {
-            auto apiBlock { ba.apply_block(bv, b.header, h, blockId) };
+            auto apiBlock { ba.apply_block(bv, b.header, h, item->id, item->validSignatures) };
             apiBlocks.push_back(std::move(apiBlock));
         } catch (Error e) {
             std::string fname { std::to_string(now_timestamp()) + "_" + std::to_string(h.value()) + "_failed.block" };
             std::ofstream f(fname);
-            f << serialize_hex(b.body.data());
+            f << serialize_hex(b.body.span().data(), b.body.size());
             res.newTxIds = ba.move_new_txids();
+            record();
             return { apiBlocks, { e, h } };
         }
         res.newHistoryOffsets.push_back(historyId);
@@ -53,6 +56,7 @@ ApplyStageTransaction::ApplyStageTransaction(const State& s, ChainDBTransaction&
     }
     res.newTxIds = ba.move_new_txids();
     res.balanceUpdates = ba.move_balance_updates();
+    record();
     return { apiBlocks, { Error(0), (ccs.stage.length() + 1).nonzero_assert() } };
 }
 
@@ -76,7 +80,9 @@ auto ApplyStageTransaction::commit(State& cs) -> StateUpdate
     std::unique_lock<std::mutex> ul(cs.chainstateMutex);
     auto result { rb ? cs.commit_fork(std::move(*rb), std::move(*applyResult))
                      : cs.commit_append(std::move(*applyResult)) };
+    auto start { std::chrono::steady_clock::now() };
     transaction.commit();
+    cs.syncPipelineCounters.on_commit(std::chrono::steady_clock::now() - start);
     return result;
 }
 }
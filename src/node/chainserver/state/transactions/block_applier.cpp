@@ -5,6 +5,7 @@
 #include "block/chain/header_chain.hpp"
 #include "block/chain/history/history.hpp"
 #include "db/chain_db.hpp"
+#include "general/worker_pool.hpp"
 
 namespace {
 
@@ -149,21 +150,6 @@ private:
     std::vector<TransferInternal> payments;
 };
 
-struct InsertHistoryEntry {
-    InsertHistoryEntry(const RewardInternal& p, HistoryId historyId)
-        : he(p)
-        , historyId(historyId)
-    {
-    }
-    InsertHistoryEntry(const VerifiedTransfer& t, HistoryId historyId)
-        : he(t)
-        , historyId(historyId)
-    {
-    }
-    history::Entry he;
-    HistoryId historyId;
-};
-
 struct HistoryEntries {
     HistoryEntries(HistoryId nextHistoryId)
         : nextHistoryId(nextHistoryId)
@@ -172,14 +158,14 @@ struct HistoryEntries {
     HistoryId nextHistoryId;
     [[nodiscard]] const auto& push_reward(const RewardInternal& r)
     {
-        auto& e { insertHistory.emplace_back(r, nextHistoryId) };
+        auto& e { insertHistory.emplace_back(r) };
         insertAccountHistory.emplace_back(r.toAccountId, nextHistoryId);
         ++nextHistoryId;
         return e;
     }
     [[nodiscard]] auto& push_transfer(const VerifiedTransfer& r)
     {
-        auto& e { insertHistory.emplace_back(r, nextHistoryId) };
+        auto& e { insertHistory.emplace_back(r) };
         insertAccountHistory.emplace_back(r.ti.toAccountId, nextHistoryId);
         if (r.ti.toAccountId != r.ti.fromAccountId) {
             insertAccountHistory.emplace_back(r.ti.fromAccountId, nextHistoryId);
@@ -190,16 +176,12 @@ struct HistoryEntries {
     void write(ChainDB& db)
     {
         // insert history for payouts and payments
-        for (auto& p : insertHistory) {
-            auto inserted { db.insertHistory(p.he.hash, p.he.data) };
-            assert(p.historyId == inserted);
-        }
+        [[maybe_unused]] auto first { db.insert_history(insertHistory) };
+        assert(first + insertHistory.size() == nextHistoryId);
         // insert account history
-        for (auto p : insertAccountHistory) {
-            db.insertAccountHistory(p.first, p.second);
-        }
+        db.insert_account_history(insertAccountHistory);
     }
-    std::vector<InsertHistoryEntry> insertHistory;
+    std::vector<history::Entry> insertHistory;
     std::vector<std::pair<AccountId, HistoryId>> insertAccountHistory;
 };
 
@@ -221,7 +203,7 @@ struct Preparation {
     }
 };
 
-Preparation BlockApplier::Preparer::prepare(const BodyView& bv, const NonzeroHeight height) const
+Preparation BlockApplier::Preparer::prepare(const BodyView& bv, const NonzeroHeight height, std::span<const uint8_t> validSignatures) const
 {
     if (!bv.valid())
         throw Error(EINV_BODY);
@@ -310,13 +292,29 @@ Preparation BlockApplier::Preparer::prepare(const BodyView& bv, const NonzeroHei
         auto& ref { res.historyEntries.push_reward(r) };
 
         res.apiRewards.push_back({
-            .txhash { ref.he.hash },
+            .txhash { ref.hash },
             .toAddress { r.toAddress },
             .amount { r.amount },
         });
     }
-    for (auto& tr : balanceChecker.get_transfers()) {
-        auto verified { tr.verify(hc, height) };
+    // signature recovery is expensive, do it in parallel
+    auto& transfers { balanceChecker.get_transfers() };
+    std::vector<std::optional<VerifiedTransfer>> verifiedTransfers(transfers.size());
+    std::vector<int32_t> verifyErrors(transfers.size(), 0);
+    verifierPool.parallel_for(transfers.size(), [&](size_t i) {
+        try {
+            bool verified { i < validSignatures.size() && validSignatures[i] != 0 };
+            verifiedTransfers[i].emplace(transfers[i].verify(hc, height, height > assumeValidHeight && !verified));
+        } catch (Error e) {
+            verifyErrors[i] = e.e;
+        }
+    });
+
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        auto& tr { transfers[i] };
+        if (verifyErrors[i] != 0)
+            throw Error(verifyErrors[i]);
+        auto& verified { *verifiedTransfers[i] };
         TransactionId tid { verified.id };
 
         // check for duplicate txid (also within current block)
@@ -330,7 +328,7 @@ Preparation BlockApplier::Preparer::prepare(const BodyView& bv, const NonzeroHei
             .fee { tr.compactFee.uncompact() },
             .nonceId { tr.pinNonce.id },
             .pinHeight { tr.pinNonce.pin_height(PinFloor { PrevHeight { height } }) },
-            .txhash { ref.he.hash },
+            .txhash { ref.hash },
             .toAddress { tr.toAddress },
             .amount { tr.amount },
         });
@@ -338,9 +336,10 @@ Preparation BlockApplier::Preparer::prepare(const BodyView& bv, const NonzeroHei
     return res;
 }
 
-API::Block BlockApplier::apply_block(const BodyView& bv, HeaderView hv, NonzeroHeight height, BlockId blockId)
+API::Block BlockApplier::apply_block(const BodyView& bv, HeaderView hv, NonzeroHeight height, BlockId blockId,
+    std::span<const uint8_t> validSignatures)
 {
-    auto prepared { preparer.prepare(bv, height) }; // call const function
+    auto prepared { preparer.prepare(bv, height, validSignatures) }; // call const function
 
     // ABOVE NO DB MODIFICATIONS
     //////////////////////////////
@@ -353,16 +352,14 @@ API::Block BlockApplier::apply_block(const BodyView& bv, HeaderView hv, NonzeroH
         preparer.newTxIds.merge(std::move(prepared.txset));
 
         // update old balances
-        for (auto& [accId, bal] : prepared.updateBalances) {
-            db.set_balance(accId, bal);
+        db.set_balances(prepared.updateBalances);
+        for (auto& [accId, bal] : prepared.updateBalances)
             balanceUpdates.insert_or_assign(accId, bal);
-        }
 
         // insert new balances
-        for (auto& [addr, bal, accId] : prepared.insertBalances) {
-            db.insertStateEntry(addr, bal, accId);
+        db.insert_state_entries(prepared.insertBalances);
+        for (auto& [addr, bal, accId] : prepared.insertBalances)
             balanceUpdates.insert_or_assign(accId, bal);
-        }
 
         // write undo data
         db.set_block_undo(blockId, prepared.rg.serialze());
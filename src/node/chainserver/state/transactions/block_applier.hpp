@@ -1,33 +1,41 @@
 #pragma once
 #include "crypto/address.hpp"
+#include "crypto/hash.hpp"
 #include "../../transaction_ids.hpp"
 #include "api/types/forward_declarations.hpp"
+#include <span>
 class ChainDB;
 class Headerchain;
 class BodyView;
 class BlockId;
 class HeaderView;
+class WorkerPool;
 
 namespace chainserver {
 struct Preparation;
 struct BlockApplier {
-    BlockApplier(ChainDB& db, const Headerchain& hc, const std::set<TransactionId, ByPinHeight>& baseTxIds, bool fromStage)
-        : preparer { db, hc, baseTxIds, {} }
+    BlockApplier(ChainDB& db, const Headerchain& hc, const std::set<TransactionId, ByPinHeight>& baseTxIds, WorkerPool& verifierPool, bool fromStage, Height assumeValidHeight = Height(0))
+        : preparer { db, hc, baseTxIds, verifierPool, assumeValidHeight, {} }
         , db(db)
         , fromStage(fromStage)
     {
     }
     TransactionIds&& move_new_txids() { return std::move(preparer.newTxIds); };
     auto&& move_balance_updates() { return std::move(balanceUpdates); };
-    [[nodiscard]] API::Block apply_block(const BodyView& bv, HeaderView, NonzeroHeight height, BlockId blockId);
+    // validSignatures[i] != 0 marks transfer i as already verified
+    [[nodiscard]] API::Block apply_block(const BodyView& bv, HeaderView, NonzeroHeight height, BlockId blockId,
+        std::span<const uint8_t> validSignatures = {});
+    Height assume_valid_height() const { return preparer.assumeValidHeight; }
 
 private: // private methods
     struct Preparer {
         const ChainDB& db; // preparer cannot modify db!
         const Headerchain& hc;
         const std::set<TransactionId, ByPinHeight>& baseTxIds;
+        WorkerPool& verifierPool; // recovers transfer signatures in parallel
+        Height assumeValidHeight; // signatures are not checked up to this height
         TransactionIds newTxIds;
-        Preparation prepare(const BodyView& bv, const NonzeroHeight height) const;
+        Preparation prepare(const BodyView& bv, const NonzeroHeight height, std::span<const uint8_t> validSignatures) const;
     };
 
 private: // private data
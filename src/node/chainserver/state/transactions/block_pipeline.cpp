@@ -0,0 +1,197 @@
+#include "block_pipeline.hpp"
+#include "block/block.hpp"
+#include "block/body/parse.hpp"
+#include "block/body/view.hpp"
+#include "block/chain/header_chain.hpp"
+#include "block/chain/history/history.hpp"
+#include "db/chain_db.hpp"
+#include "general/hex.hpp"
+#include "general/worker_pool.hpp"
+#include "spdlog/spdlog.h"
+
+void SyncPipelineCounters::on_submit(size_t prevalidated, size_t unresolved)
+{
+    chunks += 1;
+    signaturesPrevalidated += prevalidated;
+    signaturesUnresolved += unresolved;
+    auto depth { ++queueDepth };
+    auto max { maxQueueDepth.load() };
+    while (depth > max && !maxQueueDepth.compare_exchange_weak(max, depth)) { }
+}
+
+SyncPipelineStats SyncPipelineCounters::stats() const
+{
+    return {
+        .blocksChecked { blocksChecked.load() },
+        .checkMicros { checkMicros.load() },
+        .blocksApplied { blocksApplied.load() },
+        .applyMicros { applyMicros.load() },
+        .stallMicros { stallMicros.load() },
+        .commitMicros { commitMicros.load() },
+        .chunks { chunks.load() },
+        .signaturesPrevalidated { signaturesPrevalidated.load() },
+        .signaturesUnresolved { signaturesUnresolved.load() },
+        .queueDepth { queueDepth.load() },
+        .maxQueueDepth { maxQueueDepth.load() }
+    };
+}
+
+namespace chainserver {
+struct BlockPipeline::Chunk {
+    struct Entry {
+        BlockId id;
+        StoredBlock block;
+        size_t begin; // transfer range in chunk
+        size_t end;
+    };
+    Chunk(SyncPipelineCounters& counters)
+        : counters(counters)
+    {
+        entries.reserve(CHUNKBLOCKS);
+    }
+    Chunk(const Chunk&) = delete;
+    ~Chunk()
+    { // workers reference this chunk, it may be dropped unconsumed
+        try {
+            wait();
+        } catch (const std::exception& e) {
+            spdlog::error("Signature prevalidation failed: {}", e.what());
+        } catch (...) {
+            spdlog::error("Signature prevalidation failed");
+        }
+    }
+    void wait()
+    {
+        if (!pending)
+            return;
+        auto p { std::move(*pending) };
+        pending.reset();
+        counters.on_chunk_done();
+        p.wait();
+    }
+    SyncPipelineCounters& counters;
+    std::vector<Entry> entries;
+    std::vector<TransferInternal> transfers;
+    std::vector<NonzeroHeight> heights;
+    std::vector<uint8_t> valid; // written concurrently, no vector<bool>
+    std::optional<WorkerPool::Pending> pending;
+    size_t cursor { 0 };
+};
+
+BlockPipeline::BlockPipeline(const ChainDB& db, const Headerchain& stage, WorkerPool& pool,
+    SyncPipelineCounters& counters, NonzeroHeight begin, Height assumeValidHeight)
+    : db(db)
+    , stage(stage)
+    , pool(pool)
+    , counters(counters)
+    , assumeValidHeight(assumeValidHeight)
+    , nextHeight(begin)
+    , beginNewAccounts(db.next_state_id())
+    , nextAccountId(beginNewAccounts)
+{
+}
+
+BlockPipeline::~BlockPipeline() = default;
+
+auto BlockPipeline::next() -> std::optional<Item>
+{
+    if (!chunks.empty() && chunks.front()->cursor == chunks.front()->entries.size())
+        chunks.pop_front();
+    fill();
+    if (chunks.empty())
+        return {};
+    auto& c { *chunks.front() };
+    if (c.pending) {
+        auto start { std::chrono::steady_clock::now() };
+        c.wait();
+        counters.on_stall(std::chrono::steady_clock::now() - start);
+    }
+    auto& e { c.entries[c.cursor++] };
+    return Item {
+        .id { e.id },
+        .block { e.block },
+        .validSignatures { c.valid.data() + e.begin, e.end - e.begin }
+    };
+}
+
+void BlockPipeline::fill()
+{
+    while (chunks.size() < MAXCHUNKS && nextHeight <= stage.length())
+        chunks.push_back(load_chunk());
+}
+
+const Address* BlockPipeline::resolve(AccountId id)
+{
+    if (auto iter { addresses.find(id) }; iter != addresses.end())
+        return &iter->second;
+    if (id >= beginNewAccounts)
+        return nullptr; // not created by earlier blocks
+    auto p { db.lookup_account(id) };
+    if (!p)
+        return nullptr;
+    return &addresses.emplace(id, p->address).first->second;
+}
+
+auto BlockPipeline::load_chunk() -> std::unique_ptr<Chunk>
+{
+    auto c { std::make_unique<Chunk>(counters) };
+    for (; c->entries.size() < CHUNKBLOCKS && nextHeight <= stage.length(); ++nextHeight) {
+        const NonzeroHeight h { nextHeight };
+        auto hash { stage.hash_at(h) };
+        auto p = db.get_block(hash);
+        if (!p) {
+            throw std::runtime_error("Bug at line " + std::to_string(__LINE__)
+                + ". Cannot get block with hash " + serialize_hex(hash)
+                + " at height " + std::to_string(h) + " from database.");
+        }
+        auto& e { c->entries.emplace_back(p->first, std::move(p->second), c->transfers.size(), c->transfers.size()) };
+        BodyView bv(e.block.body_view());
+        if (!bv.valid())
+            continue;
+
+        // new accounts are numbered consecutively in block order
+        for (size_t i = 0; i < bv.getNAddresses(); ++i)
+            addresses.try_emplace(nextAccountId + i, bv.get_address(i));
+        nextAccountId = nextAccountId + bv.getNAddresses();
+
+        if (h <= assumeValidHeight)
+            continue; // signatures are not checked
+        try {
+            for (auto t : bv.transfers()) {
+                auto& ti { c->transfers.emplace_back(t.fromAccountId(), t.compact_fee_trow(),
+                    t.toAccountId(), t.amount_throw(), t.pin_nonce(), t.signature()) };
+                auto from { resolve(t.fromAccountId()) };
+                auto to { resolve(t.toAccountId()) };
+                if (from && to) {
+                    ti.fromAddress = *from;
+                    ti.toAddress = *to;
+                }
+                c->heights.push_back(h);
+            }
+            e.end = c->transfers.size();
+        } catch (Error) { // BlockApplier will reject this block
+            c->transfers.erase(c->transfers.begin() + e.begin, c->transfers.end());
+            c->heights.erase(c->heights.begin() + e.begin, c->heights.end());
+        }
+    }
+
+    // recover signatures on the pool
+    c->valid.resize(c->transfers.size(), 0);
+    size_t unresolved { 0 };
+    for (auto& t : c->transfers)
+        unresolved += t.fromAddress.is_null();
+    auto chunk { c.get() };
+    c->pending = pool.parallel_for_async(c->transfers.size(), [this, chunk](size_t i) {
+        auto& t { chunk->transfers[i] };
+        if (t.fromAddress.is_null())
+            return;
+        try {
+            t.verify(stage, chunk->heights[i], true);
+            chunk->valid[i] = 1;
+        } catch (Error) {
+        }
+    });
+    counters.on_submit(c->transfers.size() - unresolved, unresolved);
+    return c;
+}
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "block/body/account_id.hpp"
+#include "block/chain/height.hpp"
+#include "block/id.hpp"
+#include "crypto/address.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+
+class ChainDB;
+class Headerchain;
+class WorkerPool;
+struct StoredBlock;
+
+struct SyncPipelineStats {
+    uint64_t blocksChecked;
+    uint64_t checkMicros;
+    uint64_t blocksApplied;
+    uint64_t applyMicros;
+    uint64_t stallMicros; // application waiting for prevalidation
+    uint64_t commitMicros;
+    uint64_t chunks;
+    uint64_t signaturesPrevalidated;
+    uint64_t signaturesUnresolved; // left to BlockApplier
+    size_t queueDepth; // prevalidation chunks in flight
+    size_t maxQueueDepth;
+};
+
+// can be updated and read concurrently
+class SyncPipelineCounters {
+    using duration = std::chrono::steady_clock::duration;
+
+public:
+    void on_check(size_t blocks, duration d)
+    {
+        blocksChecked += blocks;
+        checkMicros += micros(d);
+    }
+    void on_apply(size_t blocks, duration d)
+    {
+        blocksApplied += blocks;
+        applyMicros += micros(d);
+    }
+    void on_stall(duration d) { stallMicros += micros(d); }
+    void on_commit(duration d) { commitMicros += micros(d); }
+    void on_submit(size_t prevalidated, size_t unresolved);
+    void on_chunk_done() { queueDepth -= 1; }
+    SyncPipelineStats stats() const;
+
+private:
+    static uint64_t micros(duration d)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    }
+    std::atomic<uint64_t> blocksChecked { 0 };
+    std::atomic<uint64_t> checkMicros { 0 };
+    std::atomic<uint64_t> blocksApplied { 0 };
+    std::atomic<uint64_t> applyMicros { 0 };
+    std::atomic<uint64_t> stallMicros { 0 };
+    std::atomic<uint64_t> commitMicros { 0 };
+    std::atomic<uint64_t> chunks { 0 };
+    std::atomic<uint64_t> signaturesPrevalidated { 0 };
+    std::atomic<uint64_t> signaturesUnresolved { 0 };
+    std::atomic<size_t> queueDepth { 0 };
+    std::atomic<size_t> maxQueueDepth { 0 };
+};
+
+namespace chainserver {
+
+// Loads the staged blocks to be applied and recovers their transfer
+// signatures on the verifier pool ahead of the sequential application.
+// At most MAXCHUNKS chunks are in flight. Addresses are resolved on the
+// calling thread: accounts that existed before the first block are
+// looked up in the database, new accounts are numbered in block order
+// like BlockApplier does. Transfers that cannot be resolved or whose
+// signature does not match are left to the checks in BlockApplier.
+class BlockPipeline {
+    struct Chunk;
+
+public:
+    static constexpr size_t CHUNKBLOCKS = 16;
+    static constexpr size_t MAXCHUNKS = 4;
+    struct Item {
+        BlockId id;
+        const StoredBlock& block;
+        std::span<const uint8_t> validSignatures; // by transfer index
+    };
+
+    BlockPipeline(const ChainDB&, const Headerchain& stage, WorkerPool&, SyncPipelineCounters&,
+        NonzeroHeight begin, Height assumeValidHeight);
+    BlockPipeline(const BlockPipeline&) = delete;
+    ~BlockPipeline();
+
+    // next block with its signatures prevalidated, the returned
+    // reference is valid until the next call
+    [[nodiscard]] std::optional<Item> next();
+
+private:
+    void fill();
+    std::unique_ptr<Chunk> load_chunk();
+    const Address* resolve(AccountId);
+
+private:
+    const ChainDB& db;
+    const Headerchain& stage;
+    WorkerPool& pool;
+    SyncPipelineCounters& counters;
+    Height assumeValidHeight;
+    NonzeroHeight nextHeight;
+    const AccountId beginNewAccounts;
+    AccountId nextAccountId;
+    std::map<AccountId, Address> addresses;
+    std::deque<std::unique_ptr<Chunk>> chunks;
+};
+}
@@ -1,9 +1,9 @@
 #include "recvbuffer.hpp"
-#include "crypto/hasher_sha256.hpp"
+#include "crypto/sha256_batch.hpp"
 
 bool Rcvbuffer::verify()
 {
-    auto h = hashSHA256(body.bytes);
+    auto h = sha256::hash(body.bytes.data(), body.bytes.size());
     if (memcmp(header + 4, h.data(), 4) != 0) {
         return false;
     };
@@ -3,6 +3,7 @@
 #include "communication/messages.hpp"
 #include "general/errors.hpp"
 #include "general/reader.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -36,7 +37,12 @@ private: // private methods
     void clear()
     {
         pos = 0;
-        body.bytes.clear();
+        bsize = 0;
+        // the body allocation is reused for the next message unless large
+        if (body.bytes.capacity() > KEEPCAPACITY)
+            body.bytes = {};
+        else
+            body.bytes.clear();
     }
     int32_t allocate_body()
     {
@@ -51,16 +57,21 @@ private: // private methods
         if (bsize < 2 || bsize > 2 + sb) {
             return EMSGLEN;
         }
-        // Now allocate
-        body.bytes.resize(std::min(bsize, size_t(1024ul)));
+        // Now allocate, large bodies grow with the received bytes such that
+        // announcing a size does not pin memory
+        body.bytes.resize(std::min(bsize, std::max(INITIALBODY, body.bytes.capacity())));
         // Copy additional bytes into body (needed for checksum)
         body.bytes[0] = header[8];
         body.bytes[1] = header[9];
         return 0;
     }
-    void realloc()
+    void grow()
     {
-        body.bytes.resize(std::min(bsize, body.bytes.size() + size_t(1024ul)));
+        body.bytes.resize(std::min(bsize, 2 * body.bytes.size()));
+    }
+    bool full()
+    {
+        return bsize > 0 && pos == 8 + body.bytes.size();
     }
     bool finished()
     {
@@ -68,6 +79,8 @@ private: // private methods
     }
 
 private: // private members
+    static constexpr size_t INITIALBODY = 4 * 1024;
+    static constexpr size_t KEEPCAPACITY = 64 * 1024;
     uint8_t header[10]; // 4 bytes body size + 4 bytes checksum + 2 bytes message
                         // type,
     struct Body {
@@ -1,5 +1,82 @@
 #include "sndbuffer.hpp"
 #include "crypto/hasher_sha256.hpp"
+#include <mutex>
+#include <vector>
+
+namespace {
+// Size classes are powers of two between 2^MINBITS and 2^MAXBITS bytes,
+// larger messages are allocated directly. Buffers are allocated by the
+// eventloop and released by the libuv thread, hence the mutex.
+class Pool {
+public:
+    static constexpr size_t MINBITS = 8;
+    static constexpr size_t MAXBITS = 22;
+    static constexpr uint8_t UNPOOLED = 0xFF;
+    static constexpr size_t MAXCACHED = 8 * 1024 * 1024; // bytes per class
+
+    static uint8_t size_class(size_t size)
+    {
+        size_t bits { MINBITS };
+        while ((size_t(1) << bits) < size) {
+            if (++bits > MAXBITS)
+                return UNPOOLED;
+        }
+        return bits - MINBITS;
+    }
+    char* pop(uint8_t sizeClass)
+    {
+        std::lock_guard l(m);
+        auto& v { free[sizeClass] };
+        if (v.empty())
+            return nullptr;
+        char* p { v.back() };
+        v.pop_back();
+        return p;
+    }
+    void push(uint8_t sizeClass, char* p)
+    {
+        {
+            std::lock_guard l(m);
+            auto& v { free[sizeClass] };
+            if ((v.size() + 1) << (sizeClass + MINBITS) <= MAXCACHED) {
+                v.push_back(p);
+                return;
+            }
+        }
+        delete[] p;
+    }
+
+private:
+    std::mutex m;
+    std::vector<char*> free[MAXBITS - MINBITS + 1];
+};
+
+// never destructed, buffers may be released during static destruction
+Pool& pool()
+{
+    static Pool* p { new Pool };
+    return *p;
+}
+}
+
+auto Sndbuffer::allocate(size_t size) -> Ptr
+{
+    auto c { Pool::size_class(size) };
+    if (c == Pool::UNPOOLED)
+        return { new char[size], Deleter { c } };
+    char* p { pool().pop(c) };
+    if (!p)
+        p = new char[size_t(1) << (c + Pool::MINBITS)];
+    return { p, Deleter { c } };
+}
+
+void Sndbuffer::Deleter::operator()(char* p) const
+{
+    if (sizeClass == Pool::UNPOOLED)
+        delete[] p;
+    else
+        pool().push(sizeClass, p);
+}
 
 void Sndbuffer::writeChecksum()
 {
@@ -6,10 +6,16 @@
 
 class Sndbuffer {
 	public:
+		// returns memory to a size-classed pool for reuse by later messages
+		struct Deleter {
+			uint8_t sizeClass;
+			void operator()(char* p) const;
+		};
+		using Ptr = std::unique_ptr<char[], Deleter>;
 		const uint32_t len;
-		std::unique_ptr<char[]> ptr;
+		Ptr ptr;
 		Sndbuffer(uint8_t msgtype, uint32_t msglen)
-			: len(msglen + 10), ptr(new char[len]) {
+			: len(msglen + 10), ptr(allocate(len)) {
 				ptr[8] = 0;
 				ptr[9] = msgtype;
                 uint32_t n=hton32(len-8);
@@ -19,4 +25,25 @@ class Sndbuffer {
 		uint8_t* msgdata() { return reinterpret_cast<uint8_t*>(ptr.get() + 10); };
 		size_t msgsize() { return len - 10; }
 		size_t fullsize() { return len; }
+
+	private:
+		static Ptr allocate(size_t size);
+};
+
+// Immutable, checksummed message which can be queued on several
+// connections without copying. Used to serialize broadcasts once.
+class SharedSndbuffer {
+public:
+    SharedSndbuffer(Sndbuffer&& b)
+        : len(b.fullsize())
+    {
+        b.writeChecksum();
+        ptr = std::move(b.ptr);
+    }
+    size_t fullsize() const { return len; }
+    const std::shared_ptr<char[]>& data() const { return ptr; }
+
+private:
+    uint32_t len;
+    std::shared_ptr<char[]> ptr;
 };
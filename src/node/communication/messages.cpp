@@ -1,5 +1,7 @@
 #include "messages.hpp"
 #include "block/chain/worksum.hpp"
+#include "block/body/view.hpp"
+#include "block/header/compact_batch.hpp"
 #include "block/header/view.hpp"
 #include "communication/buffers/sndbuffer.hpp"
 #include "communication/messages.hpp"
@@ -338,6 +340,19 @@ BatchrepMsg::operator Sndbuffer() const
         << nonce << Range(batch.raw());
 }
 
+auto BatchrepCompactMsg::from_reader(Reader& r) -> BatchrepCompactMsg
+{
+    auto nonce { r.uint32() };
+    return { nonce, decode_compact(r) };
+}
+
+BatchrepCompactMsg::operator Sndbuffer() const
+{
+    auto encoded { encode_compact(batch) };
+    return gen_msg(4 + encoded.size())
+        << nonce << Range(encoded);
+}
+
 std::string BlockreqMsg::log_str() const
 {
     return "blockreq [" + std::to_string(range.lower) + "," + std::to_string(range.upper) + "]";
@@ -380,6 +395,164 @@ BlockrepMsg::operator Sndbuffer() const
     return mw;
 }
 
+CompactBody::CompactBody(const BodyContainer& b, NonzeroHeight h)
+{
+    auto bv { b.view(h) };
+    if (!bv.valid())
+        throw std::runtime_error("Cannot compact invalid block body");
+    const size_t n { bv.getNTransfers() };
+    const size_t offset { b.size() - n * BodyView::TransferSize };
+    prefix.assign(b.data().begin(), b.data().begin() + offset);
+    stubs.reserve(n * STUBSIZE);
+    for (size_t i = 0; i < n; ++i) {
+        auto p { b.data().data() + offset + i * BodyView::TransferSize };
+        stubs.insert(stubs.end(), p, p + STUBSIZE);
+    }
+}
+
+CompactBody::CompactBody(Reader& r)
+{
+    auto p { r.span() };
+    prefix.assign(p.begin(), p.end());
+    auto s { r.span() };
+    if (s.size() % STUBSIZE != 0)
+        throw Error(EMSGINTEGRITY);
+    stubs.assign(s.begin(), s.end());
+}
+
+Writer& operator<<(Writer& w, const CompactBody& b)
+{
+    return w << uint32_t(b.prefix.size()) << Range(b.prefix)
+             << uint32_t(b.stubs.size()) << Range(b.stubs);
+}
+
+auto BlockreqCompactMsg::from_reader(Reader& r) -> BlockreqCompactMsg
+{
+    return { r.uint32(), r };
+}
+
+BlockreqCompactMsg::operator Sndbuffer() const
+{
+    return gen_msg(16)
+        << nonce
+        << range;
+}
+
+auto BlockrepCompactMsg::from_reader(Reader& r) -> BlockrepCompactMsg
+{
+    auto nonce = r.uint32();
+    std::vector<CompactBody> bodies;
+    while (r.remaining() != 0)
+        bodies.push_back({ r });
+    return { nonce, std::move(bodies) };
+}
+
+BlockrepCompactMsg::operator Sndbuffer() const
+{
+    size_t size = 0;
+    for (auto& b : blocks)
+        size += b.serialized_size();
+    auto mw { gen_msg(4 + size) };
+    mw << nonce;
+    for (auto& b : blocks)
+        mw << b;
+    return mw;
+}
+
+auto BlocktxnreqMsg::from_reader(Reader& r) -> BlocktxnreqMsg
+{
+    auto nonce { r.uint32() };
+    DescriptedBlockRange range(r);
+    auto n { r.uint32() };
+    if (n > MAXENTRIES)
+        throw Error(EMSGINTEGRITY);
+    std::vector<Position> missing;
+    missing.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto block { r.uint32() };
+        missing.push_back({ block, r.uint32() });
+    }
+    return { nonce, range, std::move(missing) };
+}
+
+BlocktxnreqMsg::operator Sndbuffer() const
+{
+    auto mw { gen_msg(4 + 12 + 4 + missing.size() * 8) };
+    mw << nonce << range << uint32_t(missing.size());
+    for (auto& [block, transfer] : missing)
+        mw << block << transfer;
+    return mw;
+}
+
+auto BlocktxnrepMsg::from_reader(Reader& r) -> BlocktxnrepMsg
+{
+    auto nonce { r.uint32() };
+    if (r.remaining() % 65 != 0)
+        throw Error(EMSGINTEGRITY);
+    std::vector<Signature> signatures(r.remaining() / 65);
+    for (auto& s : signatures)
+        r.copy_checkrange(s.data(), 65);
+    return { nonce, std::move(signatures) };
+}
+
+BlocktxnrepMsg::operator Sndbuffer() const
+{
+    auto mw { gen_msg(4 + signatures.size() * 65) };
+    mw << nonce;
+    for (auto& s : signatures)
+        mw << Range(s);
+    return mw;
+}
+
+auto ReconreqMsg::from_reader(Reader& r) -> ReconreqMsg
+{
+    auto nonce { r.uint32() };
+    return { nonce, mempool::TxSketch(r) };
+}
+
+ReconreqMsg::operator Sndbuffer() const
+{
+    return gen_msg(4 + sketch.serialized_size()) << nonce << sketch;
+}
+
+auto ReconrepMsg::from_reader(Reader& r) -> ReconrepMsg
+{
+    auto nonce { r.uint32() };
+    bool decoded { r.uint8() != 0 };
+    auto nMissing { r.uint16() };
+    if (nMissing > MAXENTRIES)
+        throw Error(EMSGINTEGRITY);
+    std::vector<TxidWithFee> missing;
+    missing.reserve(nMissing);
+    for (size_t i = 0; i < nMissing; ++i) {
+        TransactionId txid { r };
+        auto fee { CompactUInt::from_value_throw(r.uint16()) };
+        missing.push_back({ txid, fee });
+    }
+    auto nWanted { r.uint16() };
+    if (nWanted > MAXENTRIES)
+        throw Error(EMSGINTEGRITY);
+    std::vector<uint64_t> wanted(nWanted);
+    for (auto& w : wanted)
+        w = r.uint64();
+    if (!decoded && (missing.size() > 0 || wanted.size() > 0))
+        throw Error(EMSGINTEGRITY);
+    return { nonce, decoded, std::move(missing), std::move(wanted) };
+}
+
+ReconrepMsg::operator Sndbuffer() const
+{
+    assert(missing.size() <= MAXENTRIES && wanted.size() <= MAXENTRIES);
+    auto mw { gen_msg(4 + 1 + 2 + missing.size() * (TransactionId::bytesize + 2) + 2 + wanted.size() * 8) };
+    mw << nonce << decoded << uint16_t(missing.size());
+    for (auto& t : missing)
+        mw << t.txid << t.fee;
+    mw << uint16_t(wanted.size());
+    for (auto w : wanted)
+        mw << w;
+    return mw;
+}
+
 auto TxsubscribeMsg::from_reader(Reader& r) -> TxsubscribeMsg
 {
     return {
@@ -10,6 +10,7 @@
 #include "general/descriptor.hpp"
 #include "general/params.hpp"
 #include "general/tcp_util.hpp"
+#include "mempool/tx_sketch.hpp"
 #include <array>
 #include <chrono>
 #include <cstddef>
@@ -175,6 +176,22 @@ struct BatchrepMsg : public WithNonce, public MsgCode<7> {
     Batch batch;
 };
 
+// Same content as BatchrepMsg but prevhash is omitted for all but the
+// first header and timestamp, target and version are delta encoded.
+// Only sent to peers that announced support in the handshake.
+struct BatchrepCompactMsg : public WithNonce, public MsgCode<17> {
+    static constexpr size_t maxSize = BatchrepMsg::maxSize;
+    BatchrepCompactMsg(uint32_t nonce, Batch b)
+        : WithNonce { nonce }
+        , batch(std::move(b))
+    {
+    }
+    static BatchrepCompactMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    Batch batch;
+};
+
 struct ProbereqMsg : public RandNonce, public MsgCode<8> {
     static constexpr size_t maxSize = 12;
     std::string log_str() const;
@@ -248,6 +265,103 @@ struct BlockrepMsg : public WithNonce, public MsgCode<11> {
     std::vector<BodyContainer> blocks;
 };
 
+// Block body with the signatures of its transfers stripped, the receiver
+// looks them up in its mempool.
+struct CompactBody {
+    static constexpr size_t STUBSIZE = 34; // transfer without signature
+    CompactBody(const BodyContainer&, NonzeroHeight);
+    CompactBody(Reader& r);
+    size_t serialized_size() const { return 8 + prefix.size() + stubs.size(); }
+    size_t n_transfers() const { return stubs.size() / STUBSIZE; }
+    friend Writer& operator<<(Writer&, const CompactBody&);
+
+    std::vector<uint8_t> prefix; // body bytes before the first transfer
+    std::vector<uint8_t> stubs;
+};
+
+struct BlockreqCompactMsg : public RandNonce, public MsgCode<18> {
+    static constexpr size_t maxSize = BlockreqMsg::maxSize;
+    BlockreqCompactMsg(uint32_t nonce, DescriptedBlockRange range)
+        : RandNonce(nonce)
+        , range(range) {};
+    static BlockreqCompactMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    DescriptedBlockRange range;
+};
+
+struct BlockrepCompactMsg : public WithNonce, public MsgCode<19> {
+    static constexpr size_t maxSize = BlockrepMsg::maxSize;
+    BlockrepCompactMsg(uint32_t nonce, std::vector<CompactBody> b)
+        : WithNonce { nonce }
+        , blocks(std::move(b)) {};
+    static BlockrepCompactMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    std::vector<CompactBody> blocks;
+};
+
+// requests signatures a BlockrepCompactMsg receiver could not find
+struct BlocktxnreqMsg : public WithNonce, public MsgCode<20> {
+    using Position = std::pair<uint32_t, uint32_t>; // block offset, transfer index
+    static constexpr size_t MAXENTRIES = MAXBLOCKBATCHSIZE * (MAXBLOCKSIZE / 99);
+    static constexpr size_t maxSize = 4 + 12 + 4 + MAXENTRIES * 8;
+    BlocktxnreqMsg(uint32_t nonce, DescriptedBlockRange range, std::vector<Position> missing)
+        : WithNonce { nonce }
+        , range(range)
+        , missing(std::move(missing)) {};
+    static BlocktxnreqMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    DescriptedBlockRange range;
+    std::vector<Position> missing;
+};
+
+struct BlocktxnrepMsg : public WithNonce, public MsgCode<21> {
+    using Signature = std::array<uint8_t, 65>;
+    static constexpr size_t maxSize = 4 + BlocktxnreqMsg::MAXENTRIES * 65;
+    BlocktxnrepMsg(uint32_t nonce, std::vector<Signature> signatures)
+        : WithNonce { nonce }
+        , signatures(std::move(signatures)) {};
+    static BlocktxnrepMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    std::vector<Signature> signatures;
+};
+
+// carries a sketch of the sender's mempool, the nonce salts the short ids
+struct ReconreqMsg : public RandNonce, public MsgCode<22> {
+    static constexpr size_t maxSize = 4 + 2 + mempool::TxSketch::MAXCELLS * mempool::TxSketch::CELLSIZE;
+    ReconreqMsg(mempool::TxSketch sketch)
+        : sketch(std::move(sketch)) {};
+    ReconreqMsg(uint32_t nonce, mempool::TxSketch sketch)
+        : RandNonce(nonce)
+        , sketch(std::move(sketch)) {};
+    static ReconreqMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+    uint64_t salt() const { return nonce; }
+
+    mempool::TxSketch sketch;
+};
+
+// transactions only the responder knows and short ids of those it wants,
+// both are empty if the sketch difference could not be decoded
+struct ReconrepMsg : public WithNonce, public MsgCode<23> {
+    static constexpr size_t MAXENTRIES = mempool::TxSketch::MAXCELLS;
+    static constexpr size_t maxSize = 4 + 1 + 2 + MAXENTRIES * (TransactionId::bytesize + 2) + 2 + MAXENTRIES * 8;
+    ReconrepMsg(uint32_t nonce, bool decoded, std::vector<TxidWithFee> missing = {}, std::vector<uint64_t> wanted = {})
+        : WithNonce { nonce }
+        , decoded(decoded)
+        , missing(std::move(missing))
+        , wanted(std::move(wanted)) {};
+    static ReconrepMsg from_reader(Reader& r);
+    operator Sndbuffer() const;
+
+    bool decoded;
+    std::vector<TxidWithFee> missing;
+    std::vector<uint64_t> wanted;
+};
+
 struct TxsubscribeMsg : public RandNonce, public MsgCode<12> {
     TxsubscribeMsg(Height upper)
         : upper(upper) {};
@@ -315,5 +429,5 @@ struct LeaderMsg : public MsgCode<16> {
 namespace messages {
 [[nodiscard]] size_t size_bound(uint8_t msgtype);
 
-using Msg = std::variant<InitMsg, ForkMsg, AppendMsg, SignedPinRollbackMsg, PingMsg, PongMsg, BatchreqMsg, BatchrepMsg, ProbereqMsg, ProberepMsg, BlockreqMsg, BlockrepMsg, TxnotifyMsg, TxreqMsg, TxrepMsg, LeaderMsg>;
+using Msg = std::variant<InitMsg, ForkMsg, AppendMsg, SignedPinRollbackMsg, PingMsg, PongMsg, BatchreqMsg, BatchrepMsg, ProbereqMsg, ProberepMsg, BlockreqMsg, BlockrepMsg, TxnotifyMsg, TxreqMsg, TxrepMsg, LeaderMsg, BatchrepCompactMsg, BlockreqCompactMsg, BlockrepCompactMsg, BlocktxnreqMsg, BlocktxnrepMsg, ReconreqMsg, ReconrepMsg>;
 } // namespace messages
@@ -1,11 +1,13 @@
 #include "config.hpp"
 #include "cmdline/cmdline.hpp"
 #include "general/errors.hpp"
+#include "general/hex.hpp"
 #include "general/is_testnet.hpp"
 #include "general/tcp_util.hpp"
 #include "spdlog/spdlog.h"
 #include "toml++/toml.hpp"
 #include "version.hpp"
+#include <charconv>
 #include <filesystem>
 #include <iostream>
 #include <limits>
@@ -62,6 +64,31 @@ std::optional<SnapshotSigner> parse_leader_key(std::string privKey)
     return {};
 }
 
+std::optional<Config::Node::AssumeValid> parse_assume_valid(const std::string& s)
+{
+    if (s == "none")
+        return {};
+    if (s == "snapshot")
+        return Config::Node::AssumeValid {};
+    auto pos { s.find(':') };
+    if (pos != std::string::npos) {
+        uint32_t height { 0 };
+        Hash hash;
+        auto [ptr, ec] { std::from_chars(s.data(), s.data() + pos, height) };
+        if (ec == std::errc() && ptr == s.data() + pos && height > 0
+            && parse_hex(std::string_view(s).substr(pos + 1), hash))
+            return Config::Node::AssumeValid { std::pair { NonzeroHeight(height), hash } };
+    }
+    throw std::runtime_error("Invalid assume-valid value \"" + s + "\", expected \"none\", \"snapshot\" or \"<height>:<block hash>\".");
+}
+
+}
+
+std::string Config::Node::AssumeValid::to_string() const
+{
+    if (!block)
+        return "snapshot";
+    return std::to_string(block->first.value()) + ":" + serialize_hex(block->second);
 }
 
 int Config::init(int argc, char** argv)
@@ -174,6 +201,8 @@ int Config::process_gengetopt(gengetopt_args_info& ai)
     std::optional<EndpointAddress> rpcBind;
     std::optional<EndpointAddress> publicrpcBind;
     std::optional<EndpointAddress> stratumBind;
+    std::optional<double> stratumShareDifficulty;
+    std::optional<int64_t> stratumShareInterval;
     node.isolated = ai.isolated_given;
     node.disableTxsMining = ai.disable_tx_mining_given;
     if (ai.testnet_given) {
@@ -237,6 +266,10 @@ int Config::process_gengetopt(gengetopt_args_info& ai)
                     for (auto& [k, v] : *t) {
                         if (k == "bind")
                             stratumBind = fetch_endpointaddress(v);
+                        else if (k == "share-difficulty")
+                            stratumShareDifficulty = fetch<double>(v);
+                        else if (k == "share-interval")
+                            stratumShareInterval = fetch<int64_t>(v);
                         else
                             warning_config(k);
                     }
@@ -276,6 +309,16 @@ int Config::process_gengetopt(gengetopt_args_info& ai)
                             peers.allowLocalhostIp = fetch<bool>(v);
                         } else if (k == "log-communication") {
                             node.logCommunication = fetch<bool>(v);
+                        } else if (k == "verification-threads") {
+                            node.verificationThreads = std::max(fetch<int64_t>(v), int64_t(0));
+                        } else if (k == "api-query-threads") {
+                            node.apiQueryThreads = std::max(fetch<int64_t>(v), int64_t(1));
+                        } else if (k == "bulk-sync-distance") {
+                            node.bulkSyncDistance = std::max(fetch<int64_t>(v), int64_t(0));
+                        } else if (k == "mempool-max-size") {
+                            node.mempoolMaxSize = std::max(fetch<int64_t>(v), int64_t(1));
+                        } else if (k == "assume-valid") {
+                            node.assumeValid = parse_assume_valid(fetch<std::string>(v));
                         } else
                             warning_config(k);
                     }
@@ -328,6 +371,12 @@ int Config::process_gengetopt(gengetopt_args_info& ai)
             stratumPool = StratumPool { *stratumBind };
         }
     }
+    if (stratumPool) {
+        if (stratumShareDifficulty)
+            stratumPool->shareDifficulty = std::max(*stratumShareDifficulty, 1.0);
+        if (stratumShareInterval)
+            stratumPool->shareInterval = std::max(*stratumShareInterval, int64_t(1));
+    }
 
     // JSON RPC socket
     if (ai.rpc_given) {
@@ -414,6 +463,8 @@ std::string Config::dump()
     tbl.insert_or_assign("stratum",
         toml::table {
             { "bind", stratumPool ? stratumPool->bind.to_string() : ""s },
+            { "share-difficulty", stratumPool ? stratumPool->shareDifficulty : 10000.0 },
+            { "share-interval", stratumPool ? (int64_t)stratumPool->shareInterval : 10 },
         });
     tbl.insert_or_assign("node",
         toml::table {
@@ -423,7 +474,12 @@ std::string Config::dump()
             { "disable-tx-mining", node.disableTxsMining },
             { "enable-ban", peers.enableBan },
             { "allow-localhost-ip", peers.allowLocalhostIp },
-            { "log-communication", (bool)node.logCommunication } });
+            { "log-communication", (bool)node.logCommunication },
+            { "verification-threads", (int64_t)node.verificationThreads },
+            { "api-query-threads", (int64_t)node.apiQueryThreads },
+            { "bulk-sync-distance", (int64_t)node.bulkSyncDistance },
+            { "mempool-max-size", (int64_t)node.mempoolMaxSize },
+            { "assume-valid", node.assumeValid ? node.assumeValid->to_string() : "none"s } });
     tbl.insert_or_assign("db", toml::table {
                                    { "chain-db", data.chaindb },
                                    { "peers-db", data.peersdb },
@@ -27,6 +27,8 @@ struct Config {
     };
     struct StratumPool {
         EndpointAddress bind;
+        double shareDifficulty { 10000.0 }; // initial share difficulty
+        uint32_t shareInterval { 10 }; // seconds between shares aimed for by vardiff
     };
     std::optional<PublicAPI> publicAPI;
     std::optional<StratumPool> stratumPool;
@@ -36,6 +38,18 @@ struct Config {
         std::atomic<CompactUInt> minMempoolFee { CompactUInt::compact(Funds::from_value(1000448).value()) };
         bool isolated { false };
         bool disableTxsMining { false }; // don't mine transactions
+        size_t verificationThreads { 0 }; // shared verifier pool, 0 means auto
+        size_t apiQueryThreads { 2 }; // threads answering read-only API queries
+        size_t bulkSyncDistance { 5000 }; // group commits further behind the tip, 0 disables
+        size_t mempoolMaxSize { 10000 }; // transactions
+        // Transfer signatures in ancestors of this block are not checked
+        // during sync. Without explicit block the latest signed snapshot
+        // is assumed valid. Empty (config value "none") disables it.
+        struct AssumeValid {
+            std::optional<std::pair<NonzeroHeight, Hash>> block;
+            std::string to_string() const;
+        };
+        std::optional<AssumeValid> assumeValid { AssumeValid {} };
         std::atomic<bool> logCommunication { false };
     } node;
     struct Peers {
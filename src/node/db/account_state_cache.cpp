@@ -0,0 +1,93 @@
+#include "account_state_cache.hpp"
+
+std::optional<AddressFunds> AccountStateCache::lookup(AccountId id)
+{
+    auto iter { entries.find(id) };
+    if (iter == entries.end()) {
+        misses += 1;
+        return {};
+    }
+    hits += 1;
+    touch(iter->second);
+    return iter->second.af;
+}
+
+std::optional<AccountFunds> AccountStateCache::lookup(AddressView address)
+{
+    auto iter { ids.find(Address(address)) };
+    if (iter == ids.end()) {
+        misses += 1;
+        return {};
+    }
+    hits += 1;
+    auto& e { entries.at(iter->second) };
+    touch(e);
+    return AccountFunds { iter->second, e.af.funds };
+}
+
+void AccountStateCache::insert(AccountId id, const AddressFunds& af)
+{
+    if (capacity == 0)
+        return;
+    auto [iter, inserted] { entries.try_emplace(id, Entry { af, {} }) };
+    if (!inserted) {
+        iter->second.af = af;
+        touch(iter->second);
+        return;
+    }
+    lru.push_front(id);
+    iter->second.lruPos = lru.begin();
+    ids.insert_or_assign(af.address, id);
+    if (entries.size() > capacity)
+        erase(entries.find(lru.back()));
+    size = entries.size();
+}
+
+void AccountStateCache::insert_new(AccountId id, const AddressFunds& af)
+{
+    modified.insert(id);
+    insert(id, af);
+}
+
+void AccountStateCache::set_balance(AccountId id, Funds f)
+{
+    modified.insert(id);
+    if (auto iter { entries.find(id) }; iter != entries.end())
+        iter->second.af.funds = f;
+}
+
+void AccountStateCache::erase_from(AccountId id)
+{
+    for (auto iter { entries.lower_bound(id) }; iter != entries.end();)
+        erase(iter++);
+    size = entries.size();
+}
+
+void AccountStateCache::on_commit()
+{
+    modified.clear();
+}
+
+void AccountStateCache::on_rollback()
+{
+    for (auto id : modified) {
+        if (auto iter { entries.find(id) }; iter != entries.end())
+            erase(iter);
+    }
+    modified.clear();
+    size = entries.size();
+}
+
+void AccountStateCache::touch(Entry& e)
+{
+    lru.splice(lru.begin(), lru, e.lruPos);
+}
+
+void AccountStateCache::erase(std::map<AccountId, Entry>::iterator iter)
+{
+    auto& e { iter->second };
+    if (auto i { ids.find(e.af.address) }; i != ids.end() && i->second == iter->first)
+        ids.erase(i);
+    lru.erase(e.lruPos);
+    entries.erase(iter);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "general/address_funds.hpp"
+#include <atomic>
+#include <list>
+#include <map>
+#include <optional>
+#include <set>
+
+struct AccountCacheStats {
+    size_t size;
+    size_t capacity;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+// Bounded write-through cache of the `State` table in front of ChainDB.
+// Accounts modified within a database transaction are evicted when the
+// transaction is rolled back such that the cache never holds
+// uncommitted data afterwards.
+class AccountStateCache {
+public:
+    AccountStateCache(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    // lookups count hits and misses
+    [[nodiscard]] std::optional<AddressFunds> lookup(AccountId);
+    [[nodiscard]] std::optional<AccountFunds> lookup(AddressView);
+
+    // insert account read from the database
+    void insert(AccountId, const AddressFunds&);
+
+    // write-through modifications
+    void insert_new(AccountId, const AddressFunds&);
+    void set_balance(AccountId, Funds);
+    void erase_from(AccountId);
+
+    void on_commit();
+    void on_rollback();
+
+    // can be called concurrently
+    AccountCacheStats stats() const
+    {
+        return { size.load(), capacity, hits.load(), misses.load() };
+    }
+
+private:
+    struct Entry {
+        AddressFunds af;
+        std::list<AccountId>::iterator lruPos;
+    };
+    void touch(Entry& e);
+    void erase(std::map<AccountId, Entry>::iterator);
+
+private:
+    const size_t capacity;
+    std::map<AccountId, Entry> entries;
+    std::map<Address, AccountId> ids;
+    std::list<AccountId> lru; // most recently used first
+    std::set<AccountId> modified; // in the current transaction
+    std::atomic<size_t> size { 0 };
+    std::atomic<uint64_t> hits { 0 };
+    std::atomic<uint64_t> misses { 0 };
+};
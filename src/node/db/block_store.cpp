@@ -0,0 +1,164 @@
+#include "block_store.hpp"
+#include "general/mapped_file/mapped_file.hpp"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+
+namespace {
+constexpr const char* prefix { "blk" };
+constexpr const char* suffix { ".dat" };
+}
+
+BlockStore::BlockStore(const std::string& dbPath)
+{
+    if (dbPath.empty()) {
+        temporary = true;
+        dir = std::filesystem::temp_directory_path()
+            / ("warthog-blocks-" + std::to_string(std::random_device {}()));
+    } else {
+        dir = std::filesystem::path(dbPath).replace_extension("blocks");
+    }
+    std::filesystem::create_directories(dir);
+}
+
+BlockStore::~BlockStore()
+{
+    if (temporary) {
+        writer.reset();
+        std::lock_guard l(mappingsMutex);
+        mappings.clear();
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+}
+
+std::string BlockStore::segment_path(int64_t segment) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%s%05ld%s", prefix, long(segment), suffix);
+    return (dir / name).string();
+}
+
+std::vector<int64_t> BlockStore::segments() const
+{
+    std::vector<int64_t> res;
+    for (auto& e : std::filesystem::directory_iterator(dir)) {
+        auto name { e.path().filename().string() };
+        if (!e.is_regular_file() || !name.starts_with(prefix) || !name.ends_with(suffix))
+            continue;
+        auto digits { name.substr(3, name.size() - 3 - 4) };
+        if (digits.empty() || !std::all_of(digits.begin(), digits.end(), ::isdigit))
+            continue;
+        res.push_back(std::stoll(digits));
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+void BlockStore::set_write_position(int64_t segment, int64_t offset)
+{
+    assert(offset >= 0 && size_t(offset) <= SEGMENTSIZE);
+    writeSegment = segment;
+    writeOffset = offset;
+    open_write_segment();
+}
+
+void BlockStore::open_write_segment()
+{
+    writer = std::make_unique<WritableFile>(segment_path(writeSegment));
+    // segments have fixed size such that they can be mapped once
+    writer->resize(SEGMENTSIZE);
+}
+
+auto BlockStore::append(std::span<const uint8_t> data) -> Location
+{
+    assert(writer);
+    if (data.size() > SEGMENTSIZE)
+        throw std::runtime_error("Cannot store " + std::to_string(data.size()) + " bytes in block store segment");
+    if (writeOffset + data.size() > SEGMENTSIZE) {
+        sync();
+        writeSegment += 1;
+        writeOffset = 0;
+        open_write_segment();
+    }
+    writer->write(writeOffset, data.data(), data.size());
+    Location l {
+        .segment = writeSegment,
+        .offset = writeOffset,
+        .length = int64_t(data.size())
+    };
+    writeOffset += data.size();
+    dirty = true;
+    return l;
+}
+
+auto BlockStore::read(const Location& l) const -> View
+{
+    if (l.length == 0)
+        return {};
+    auto m { mapped(l.segment) };
+    if (l.offset < 0 || l.length < 0 || size_t(l.offset + l.length) > m->size())
+        throw std::runtime_error("Database corrupted, invalid location in block segment " + std::to_string(l.segment));
+    std::span<const uint8_t> bytes { m->data() + l.offset, size_t(l.length) };
+    return { std::move(m), bytes };
+}
+
+std::shared_ptr<const MappedFile> BlockStore::mapped(int64_t segment) const
+{
+    std::lock_guard l(mappingsMutex);
+    auto iter { mappings.find(segment) };
+    if (iter == mappings.end())
+        iter = mappings.emplace(segment, std::make_shared<MappedFile>(segment_path(segment))).first;
+    return iter->second;
+}
+
+void BlockStore::sync()
+{
+    if (dirty) {
+        writer->sync();
+        dirty = false;
+    }
+}
+
+void BlockStore::remove_after_commit(int64_t segment)
+{
+    assert(segment != writeSegment);
+    pendingRemovals.push_back(segment);
+}
+
+void BlockStore::on_commit()
+{
+    for (auto s : pendingRemovals)
+        remove_segment(s);
+    pendingRemovals.clear();
+}
+
+void BlockStore::rollback_to(Savepoint sp)
+{
+    pendingRemovals.resize(sp.removals);
+    // appended data is no longer referenced and will be overwritten,
+    // segments opened after the savepoint are not referenced at all
+    if (sp.segment != writeSegment) {
+        const int64_t last { writeSegment };
+        writer.reset();
+        writeSegment = sp.segment;
+        for (int64_t s { sp.segment + 1 }; s <= last; ++s)
+            remove_segment(s);
+        open_write_segment();
+    }
+    writeOffset = sp.offset;
+}
+
+void BlockStore::remove_segment(int64_t segment)
+{
+    assert(segment != writeSegment);
+    {
+        std::lock_guard l(mappingsMutex);
+        mappings.erase(segment);
+    }
+    std::error_code ec;
+    std::filesystem::remove(segment_path(segment), ec);
+    if (ec)
+        spdlog::warn("Cannot remove block segment {}: {}", segment_path(segment), ec.message());
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+class MappedFile;
+class WritableFile;
+
+// Append-only storage of block bodies and undo data in fixed size
+// segment files. The SQLite database only stores the location of
+// each entry. Reads return views into memory mapped segments, a view
+// keeps its mapping alive after the segment is removed.
+class BlockStore {
+public:
+    static constexpr size_t SEGMENTSIZE = 64 * 1024 * 1024;
+    struct Location {
+        int64_t segment;
+        int64_t offset;
+        int64_t length;
+    };
+    class View {
+    public:
+        View() = default;
+        View(std::shared_ptr<const MappedFile> file, std::span<const uint8_t> bytes)
+            : file(std::move(file))
+            , bytes(bytes)
+        {
+        }
+        std::span<const uint8_t> span() const { return bytes; }
+        size_t size() const { return bytes.size(); }
+
+    private:
+        std::shared_ptr<const MappedFile> file;
+        std::span<const uint8_t> bytes;
+    };
+
+    // an empty path creates a temporary store that is removed on destruction
+    BlockStore(const std::string& dbPath);
+    BlockStore(const BlockStore&) = delete;
+    ~BlockStore();
+
+    [[nodiscard]] std::vector<int64_t> segments() const;
+    void set_write_position(int64_t segment, int64_t offset);
+    int64_t write_segment() const { return writeSegment; }
+
+    [[nodiscard]] Location append(std::span<const uint8_t>);
+    [[nodiscard]] View read(const Location&) const;
+
+    // flushes appended data to disk, must be called before the
+    // database transaction referencing the data commits
+    void sync();
+
+    // segment removal is deferred until the database transaction
+    // that removed the last reference has committed
+    void remove_after_commit(int64_t segment);
+    void on_commit();
+    // taken when a database transaction starts, rolling back discards
+    // pending removals and rewinds the write position
+    struct Savepoint {
+        size_t removals;
+        int64_t segment;
+        int64_t offset;
+    };
+    Savepoint savepoint() const { return { pendingRemovals.size(), writeSegment, writeOffset }; }
+    void rollback_to(Savepoint sp);
+    void remove_segment(int64_t segment);
+
+private:
+    std::string segment_path(int64_t segment) const;
+    std::shared_ptr<const MappedFile> mapped(int64_t segment) const;
+    void open_write_segment();
+
+private:
+    std::filesystem::path dir;
+    bool temporary { false };
+    int64_t writeSegment { 0 };
+    int64_t writeOffset { 0 };
+    std::unique_ptr<WritableFile> writer;
+    bool dirty { false };
+    std::vector<int64_t> pendingRemovals;
+    // reads may come from several threads
+    mutable std::mutex mappingsMutex;
+    mutable std::map<int64_t, std::shared_ptr<const MappedFile>> mappings;
+};
@@ -1,6 +1,7 @@
 #include "chain_db.hpp"
 #include "api/types/all.hpp"
 #include "block/body/parse.hpp"
+#include "block/chain/history/history.hpp"
 #include "block/chain/header_chain.hpp"
 #include "block/header/header_impl.hpp"
 #include "block/header/view_inline.hpp"
@@ -8,8 +9,108 @@
 #include "general/now.hpp"
 #include "sqlite3.h"
 #include <array>
+#include <set>
 #include <spdlog/spdlog.h>
 
+namespace {
+// JSON array of integer pairs for json_each()
+template <typename T1, typename T2>
+std::string json_pairs(const std::vector<std::pair<T1, T2>>& pairs, auto first, auto second)
+{
+    std::string json { "[" };
+    for (auto& p : pairs) {
+        if (json.size() > 1)
+            json += ",";
+        json += "[" + std::to_string(first(p)) + "," + std::to_string(second(p)) + "]";
+    }
+    return json + "]";
+}
+
+BlockStore::Location location(Statement2::Row& r, int index)
+{
+    return {
+        .segment = r.get<int64_t>(index),
+        .offset = r.get<int64_t>(index + 1),
+        .length = r.get<int64_t>(index + 2)
+    };
+}
+}
+
+ChainDB::InitBlockStore::InitBlockStore(SQLite::Database& db, BlockStore& bs)
+{
+    if (db.execAndGet("SELECT count(*) FROM pragma_table_info('Blocks') WHERE name='body_file'").getInt() == 0)
+        migrate_legacy(db, bs);
+    db.exec("CREATE INDEX IF NOT EXISTS `blocks_body_file` ON `Blocks` (`body_file`)");
+    db.exec("CREATE INDEX IF NOT EXISTS `blocks_undo_file` ON `Blocks` (`undo_file`)");
+
+    // Continue writing at the end of the last referenced segment.
+    // Unreferenced segments are leftovers from interrupted compaction.
+    Statement2 stmtSegmentEnd(db, "SELECT coalesce(max(e),0) FROM ("
+                                  "SELECT `body_offset`+`body_length` AS e FROM `Blocks` WHERE `body_file`=?1 UNION ALL "
+                                  "SELECT `undo_offset`+`undo_length` FROM `Blocks` WHERE `undo_file`=?1)");
+    int64_t segment { 0 }, offset { 0 };
+    for (auto s : bs.segments()) {
+        int64_t end { stmtSegmentEnd.one(s).get<int64_t>(0) };
+        if (end == 0) {
+            if (s != bs.write_segment())
+                bs.remove_segment(s);
+            continue;
+        }
+        segment = s;
+        offset = end;
+    }
+    bs.set_write_position(segment, offset);
+}
+
+void ChainDB::InitBlockStore::migrate_legacy(SQLite::Database& db, BlockStore& bs)
+{
+    for (auto s : bs.segments())
+        bs.remove_segment(s);
+    bs.set_write_position(0, 0);
+
+    int64_t n { db.execAndGet("SELECT count(*) FROM `Blocks`").getInt64() };
+    spdlog::info("Moving {} blocks from the database into block segment files, this may take a while.", n);
+    SQLite::Transaction tx(db);
+    db.exec(blocks_table_schema("BlocksMigration"));
+    SQLite::Statement select(db, "SELECT ROWID, `height`, `header`, `hash`, `body`, `undo` FROM `Blocks` ORDER BY ROWID");
+    SQLite::Statement insert(db, "INSERT INTO `BlocksMigration` (ROWID, `height`, `header`, `hash`, `body_file`, "
+                                 "`body_offset`, `body_length`, `undo_file`, `undo_offset`, `undo_length`) VALUES (?,?,?,?,?,?,?,?,?,?)");
+    int64_t i { 0 };
+    while (select.executeStep()) {
+        auto blob = [&](int index) {
+            auto c { select.getColumn(index) };
+            return std::span<const uint8_t>(static_cast<const uint8_t*>(c.getBlob()), c.getBytes());
+        };
+        insert.bind(1, select.getColumn(0).getInt64());
+        insert.bind(2, select.getColumn(1).getInt64());
+        insert.bind(3, select.getColumn(2).getBlob(), select.getColumn(2).getBytes());
+        insert.bind(4, select.getColumn(3).getBlob(), select.getColumn(3).getBytes());
+        auto body { bs.append(blob(4)) };
+        insert.bind(5, body.segment);
+        insert.bind(6, body.offset);
+        insert.bind(7, body.length);
+        if (select.getColumn(5).isNull()) {
+            insert.bind(8);
+            insert.bind(9);
+            insert.bind(10);
+        } else {
+            auto undo { bs.append(blob(5)) };
+            insert.bind(8, undo.segment);
+            insert.bind(9, undo.offset);
+            insert.bind(10, undo.length);
+        }
+        insert.exec();
+        insert.reset();
+        if (++i % 100000 == 0)
+            spdlog::info("Moved {}/{} blocks", i, n);
+    }
+    db.exec("DROP TABLE `Blocks`");
+    db.exec("ALTER TABLE `BlocksMigration` RENAME TO `Blocks`");
+    bs.sync();
+    tx.commit();
+    spdlog::info("Moved {} blocks, the freed database space is reused (run VACUUM to shrink the file).", i);
+}
+
 ChainDB::Cache ChainDB::Cache::init(SQLite::Database& db)
 {
     auto maxStateId = AccountId(int64_t(db.execAndGet("SELECT coalesce(max(ROWID),0) FROM `State`")
@@ -30,23 +131,118 @@ ChainDBTransaction ChainDB::transaction()
 {
     return ChainDBTransaction(*this);
 }
+
+void ChainDB::begin_group()
+{
+    assert(!groupOpen);
+    db.exec("BEGIN");
+    groupOpen = true;
+}
+
+void ChainDB::commit_group()
+{
+    assert(groupOpen);
+    blockStore.sync();
+    db.exec("COMMIT");
+    groupOpen = false;
+    accountCache.on_commit();
+    blockStore.on_commit();
+    headerFile.on_commit();
+}
+
+void ChainDB::set_relaxed_durability(bool relaxed)
+{
+    relaxedDurability = relaxed;
+    db.exec(relaxed ? "PRAGMA synchronous = NORMAL" : "PRAGMA synchronous = FULL");
+}
+
+void ChainDB::defer_indexing()
+{
+    assert(!groupOpen);
+    if (!indexing_deferred()) {
+        // the log table marks deferred indexing, create it first
+        db.exec("CREATE TABLE IF NOT EXISTS `AccountHistoryLog` (`history_id` INTEGER, "
+                "`account_id` INTEGER, PRIMARY KEY(`history_id`,`account_id`)) WITHOUT ROWID");
+        db.exec("DROP INDEX IF EXISTS `history_index`");
+        prepare_account_history_log();
+    }
+}
+
+std::optional<HistoryId> ChainDB::build_indices_step(size_t rows)
+{
+    assert(!groupOpen && rows > 0);
+    if (!indexing_deferred())
+        return {};
+    SQLite::Transaction tx(db);
+    // move whole history ids only, the log is ordered by history id
+    if (auto o { stmtAccountHistoryLogCutoff->one(int64_t(rows)) }; o.has_value()) {
+        const int64_t cutoff { o.get<int64_t>(0) };
+        stmtAccountHistoryLogMoveBelow->run(cutoff);
+        stmtAccountHistoryLogDeleteBelow->run(cutoff);
+        tx.commit();
+        return HistoryId { uint64_t(cutoff) };
+    }
+    if (db.execAndGet("SELECT EXISTS(SELECT 1 FROM `AccountHistoryLog`)").getInt() != 0) {
+        db.exec("INSERT INTO `AccountHistory` (`account_id`,`history_id`) "
+                "SELECT `account_id`,`history_id` FROM `AccountHistoryLog` "
+                "ORDER BY `account_id`,`history_id`");
+        db.exec("DELETE FROM `AccountHistoryLog`");
+        tx.commit();
+        return cache.nextHistoryId;
+    }
+    // SQLite cannot build an index incrementally, this sorts the whole
+    // History table in one go
+    spdlog::info("Building transaction hash index, the node does not process chain events until this is done.");
+    db.exec("CREATE INDEX IF NOT EXISTS `history_index` ON `History` (`hash` ASC)");
+    stmtAccountHistoryLogInsert.reset();
+    stmtAccountHistoryLogInserts.reset();
+    stmtAccountHistoryLogDeleteFrom.reset();
+    stmtAccountHistoryLogCutoff.reset();
+    stmtAccountHistoryLogMoveBelow.reset();
+    stmtAccountHistoryLogDeleteBelow.reset();
+    db.exec("DROP TABLE `AccountHistoryLog`");
+    tx.commit();
+    return {};
+}
+
+void ChainDB::prepare_account_history_log()
+{
+    stmtAccountHistoryLogInsert.emplace(db, "INSERT INTO `AccountHistoryLog` "
+                                            "(`history_id`,`account_id`) VALUES (?,?)");
+    stmtAccountHistoryLogInserts.emplace(db, "INSERT INTO `AccountHistoryLog` (`history_id`,`account_id`) VALUES ", 2);
+    stmtAccountHistoryLogDeleteFrom.emplace(db, "DELETE FROM `AccountHistoryLog` WHERE `history_id`>=?");
+    stmtAccountHistoryLogCutoff.emplace(db, "SELECT `history_id` FROM `AccountHistoryLog` "
+                                            "ORDER BY `history_id` LIMIT 1 OFFSET ?");
+    stmtAccountHistoryLogMoveBelow.emplace(db, "INSERT INTO `AccountHistory` (`account_id`,`history_id`) "
+                                               "SELECT `account_id`,`history_id` FROM `AccountHistoryLog` "
+                                               "WHERE `history_id`<? ORDER BY `account_id`,`history_id`");
+    stmtAccountHistoryLogDeleteBelow.emplace(db, "DELETE FROM `AccountHistoryLog` WHERE `history_id`<?");
+}
 ChainDB::ChainDB(const std::string& path)
     : db(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE)
     , fl(path)
     , createTables(db)
+    , blockStore(path)
+    , initBlockStore(db, blockStore)
+    , headerFile(path)
     , cache(Cache::init(db))
-    , stmtBlockInsert(db, "INSERT INTO \"Blocks\" ( `height`, `header`, `body` "
-                          ", `hash`) VALUES (?,?,?,?)")
-    , stmtUndoSet(db, "UPDATE \"Blocks\" SET `undo`=? WHERE `ROWID`=?")
+    , stmtBlockInsert(db, "INSERT INTO \"Blocks\" ( `height`, `header`, `hash`, "
+                          "`body_file`, `body_offset`, `body_length`) VALUES (?,?,?,?,?,?)")
+    , stmtUndoSet(db, "UPDATE \"Blocks\" SET `undo_file`=?, `undo_offset`=?, `undo_length`=? WHERE `ROWID`=?")
     , stmtBlockGetUndo(
-          db, "SELECT `header`,`body`, `undo` FROM \"Blocks\" WHERE `ROWID`=?")
+          db, "SELECT `header`, `body_file`, `body_offset`, `body_length`, "
+              "coalesce(`undo_file`,0), coalesce(`undo_offset`,0), coalesce(`undo_length`,0) FROM \"Blocks\" WHERE `ROWID`=?")
     , stmtBlockById(
-          db, "SELECT `height`, `header`, `body` FROM \"Blocks\" WHERE `ROWID`=?;")
+          db, "SELECT `height`, `header`, `body_file`, `body_offset`, `body_length` FROM \"Blocks\" WHERE `ROWID`=?;")
     , stmtBlockByHash(
-          db, "SELECT ROWID, `height`, `header`, `body` FROM \"Blocks\" WHERE `hash`=?;")
+          db, "SELECT ROWID, `height`, `header`, `body_file`, `body_offset`, `body_length` FROM \"Blocks\" WHERE `hash`=?;")
     , stmtConsensusHeaders(db, "SELECT c.height, c.history_cursor, c.account_cursor, b.header "
                                "FROM `Blocks` b JOIN `Consensus` c ON "
                                "b.ROWID=c.block_id ORDER BY c.height ASC;")
+    , stmtConsensusHeadHeader(db, "SELECT c.height, c.history_cursor, c.account_cursor, b.header "
+                                  "FROM `Blocks` b JOIN `Consensus` c ON "
+                                  "b.ROWID=c.block_id ORDER BY c.height DESC LIMIT 1;")
+    , stmtBlockHeader(db, "SELECT `header` FROM `Blocks` WHERE ROWID=?")
     , stmtConsensusInsert(db, "INSERT INTO \"Consensus\" ( `height`, "
                               "`block_id`, `history_cursor`, `account_cursor`) VALUES (?,?,?,?)")
     , stmtConsensusSetProperty(
@@ -70,15 +266,30 @@ ChainDB::ChainDB(const std::string& path)
     , stmtScheduleDelete2(db, "DELETE FROM `Deleteschedule` WHERE `block_id` = ?")
     , stmtScheduleConsensus(db, "REPLACE INTO `Deleteschedule` (block_id,deletion_key) SELECT block_id, ? FROM Consensus WHERE height >= ?")
 
+    , stmtGCSegments(
+          db, "SELECT `body_file`, coalesce(`undo_file`,-1) FROM `Blocks` WHERE ROWID IN (SELECT `block_id` FROM "
+              "`Deleteschedule` WHERE `deletion_key`<=? AND `deletion_key` > 0 )")
     , stmtDeleteGCBlocks(
           db, "DELETE FROM `Blocks` WHERE ROWID IN (SELECT `block_id`  FROM "
               "`Deleteschedule` WHERE `deletion_key`<=? AND `deletion_key` > 0 )")
     , stmtDeleteGCRefs(db, "DELETE  FROM `Deleteschedule` WHERE `deletion_key`<=? AND `deletion_key` > 0")
+    , stmtSegmentLive(db, "SELECT coalesce(sum(l),0) FROM ("
+                          "SELECT `body_length` AS l FROM `Blocks` WHERE `body_file`=?1 UNION ALL "
+                          "SELECT `undo_length` FROM `Blocks` WHERE `undo_file`=?1)")
+    , stmtSegmentBodies(db, "SELECT ROWID, `body_file`, `body_offset`, `body_length` FROM `Blocks` WHERE `body_file`=?")
+    , stmtSegmentUndos(db, "SELECT ROWID, `undo_file`, `undo_offset`, `undo_length` FROM `Blocks` WHERE `undo_file`=?")
+    , stmtBodyMove(db, "UPDATE `Blocks` SET `body_file`=?, `body_offset`=? WHERE ROWID=?")
+    , stmtUndoMove(db, "UPDATE `Blocks` SET `undo_file`=?, `undo_offset`=? WHERE ROWID=?")
 
     , stmtStateInsert(db, "INSERT INTO \"State\" ( `ROWID`, `address`, "
                           "`balance`) VALUES (?,?,?)")
     , stmtStateDeleteFrom(db, "DELETE FROM `State` WHERE `ROWID`>=?")
     , stmtStateSetBalance(db, "UPDATE `State` SET `balance`=? WHERE `ROWID`=?")
+    , stmtStateSetBalances(db, "UPDATE `State` SET `balance`=v.column2 FROM (VALUES ", 2,
+          ") AS v WHERE `State`.ROWID=v.column1")
+    , stmtStateInserts(db, "INSERT INTO `State` (`ROWID`, `address`, `balance`) VALUES ", 3)
+    , stmtStateSetBalancesJson(db, "UPDATE `State` SET `balance`=v.value->>1 FROM json_each(?) AS v "
+                                   "WHERE `State`.ROWID=v.value->>0")
 
     , stmtBadblockInsert(
           db, "INSERT INTO `Badblocks` (`height`, `header`) VALUES (?,?)")
@@ -86,36 +297,33 @@ ChainDB::ChainDB(const std::string& path)
     , stmtAccountLookup(
           db, "SELECT `Address`, `Balance` FROM `State` WHERE ROWID=?")
     , stmtRichlistLookup(
-          db, "SELECT Address, Balance FROM `State` ORDER BY `Balance` DESC LIMIT ?")
+          db, "SELECT ROWID, `Address`, `Balance` FROM `State` ORDER BY `Balance` DESC LIMIT ?")
     , stmtHistoryInsert(db, "INSERT INTO `History` (`id`,`hash`, `data`"
                             ") VALUES (?,?,?)")
     , stmtHistoryDeleteFrom(db, "DELETE FROM `History` WHERE `id`>=?")
-    , stmtHistoryLookup(db,
-          "SELECT `id`, `data` FROM `History` WHERE `hash`=?")
-    , stmtHistoryLookupRange(db,
-          "SELECT `hash`, `data` FROM `History` WHERE `id`>=? AND`id`<?")
     , stmtAccountHistoryInsert(db, "INSERT INTO `AccountHistory` "
                                    "(`account_id`,`history_id`) VALUES (?,?)")
+    , stmtHistoryInserts(db, "INSERT INTO `History` (`id`,`hash`, `data`) VALUES ", 3)
+    , stmtAccountHistoryInserts(db, "INSERT INTO `AccountHistory` (`account_id`,`history_id`) VALUES ", 2)
+    , stmtAccountHistoryInsertsJson(db, "INSERT INTO `AccountHistory` (`account_id`,`history_id`) "
+                                        "SELECT value->>0, value->>1 FROM json_each(?)")
     , stmtAccountHistoryDeleteFrom(
           db, "DELETE FROM `AccountHistory` WHERE `history_id`>=?")
     , stmtBlockIdSelect(
           db, "SELECT `ROWID` FROM `Blocks` WHERE `hash`=?")
-    , stmtBlockHeightSelect(
-          db, "SELECT `height` FROM `Blocks` WHERE `hash`=?")
     , stmtBlockDelete(db, "DELETE FROM `Blocks` WHERE ROWID = ?")
 
     // BELOW STATEMENTS REQUIRED FOR INDEXING NODES
     //
     , stmtAddressLookup(
           db, "SELECT `ROWID`,`balance` FROM `State` WHERE `address`=?")
-    , stmtHistoryById(db, "SELECT h.id, `hash`,`data` FROM `History` `h` JOIN "
-                          "`AccountHistory` `ah` ON h.id=`ah`.history_id WHERE "
-                          "ah.`account_id`=? AND h.id<? ORDER BY h.id DESC LIMIT 100")
 {
 
     //
     // Do DELETESCHEDULE cleanup
     db.exec("UPDATE `Deleteschedule` SET `deletion_key`=1");
+    if (db.tableExists("AccountHistoryLog"))
+        prepare_account_history_log();
 }
 
 void ChainDB::insertStateEntry(const AddressView address, Funds balance,
@@ -125,6 +333,51 @@ void ChainDB::insertStateEntry(const AddressView address, Funds balance,
         throw std::runtime_error("Internal error, state id inconsistent.");
     stmtStateInsert.run(cache.maxStateId + 1, address, balance);
     cache.maxStateId++;
+    accountCache.insert_new(cache.maxStateId, { address, balance });
+}
+
+void ChainDB::set_balances(const std::vector<std::pair<AccountId, Funds>>& balances)
+{
+    switch (bulkWrites) {
+    case BulkWrites::PerRow:
+        for (auto& [id, balance] : balances)
+            set_balance(id, balance);
+        return;
+    case BulkWrites::MultiRow:
+        stmtStateSetBalances.run(balances, [](Statement2& st, int i, auto& p) {
+            st.bind(i, p.first);
+            st.bind(i + 1, p.second);
+        });
+        break;
+    case BulkWrites::JsonEach:
+        stmtStateSetBalancesJson.run(json_pairs(
+            balances, [](auto& p) { return p.first.value(); }, [](auto& p) { return p.second.E8(); }));
+        break;
+    }
+    for (auto& [id, balance] : balances)
+        accountCache.set_balance(id, balance);
+}
+
+void ChainDB::insert_state_entries(const std::vector<std::tuple<AddressView, Funds, AccountId>>& entries)
+{
+    if (bulkWrites == BulkWrites::PerRow) {
+        for (auto& [address, balance, id] : entries)
+            insertStateEntry(address, balance, id);
+        return;
+    }
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (std::get<2>(entries[i]) != cache.maxStateId + 1 + i)
+            throw std::runtime_error("Internal error, state id inconsistent.");
+    stmtStateInserts.run(entries, [](Statement2& st, int i, auto& e) {
+        auto& [address, balance, id] { e };
+        st.bind(i, id);
+        st.bind(i + 1, address);
+        st.bind(i + 2, balance);
+    });
+    for (auto& [address, balance, id] : entries) {
+        cache.maxStateId++;
+        accountCache.insert_new(id, { address, balance });
+    }
 }
 
 void ChainDB::delete_state_from(AccountId fromAccountId)
@@ -135,6 +388,7 @@ void ChainDB::delete_state_from(AccountId fromAccountId)
     } else {
         cache.maxStateId = fromAccountId - 1;
         stmtStateDeleteFrom.run(fromAccountId);
+        accountCache.erase_from(fromAccountId);
     }
 }
 
@@ -188,8 +442,43 @@ std::vector<BlockId> ChainDB::consensus_block_ids(Height begin,
 
 void ChainDB::garbage_collect_blocks(DeletionKey dk)
 {
+    assert(!groupOpen && !relaxedDurability);
+    std::set<int64_t> segments;
+    stmtGCSegments.for_each([&](Statement2::Row& r) {
+        segments.insert(r.get<int64_t>(0));
+        if (auto s { r.get<int64_t>(1) }; s >= 0)
+            segments.insert(s);
+    },
+        dk.value());
     stmtDeleteGCBlocks.run(dk.value());
     stmtDeleteGCRefs.run(dk.value());
+    for (auto s : segments)
+        compact_segment(s);
+}
+
+void ChainDB::compact_segment(int64_t segment)
+{
+    // rewrite segments that are less than half referenced
+    if (segment == blockStore.write_segment())
+        return;
+    if (stmtSegmentLive.one(segment).get<int64_t>(0) * 2 >= int64_t(BlockStore::SEGMENTSIZE))
+        return;
+
+    using Entries = std::vector<std::pair<BlockId, BlockStore::Location>>;
+    auto move = [&](Statement2& select, Statement2& update) {
+        Entries entries;
+        select.for_each([&](Statement2::Row& r) {
+            entries.push_back({ r.get<BlockId>(0), location(r, 1) });
+        },
+            segment);
+        for (auto& [id, l] : entries) {
+            auto moved { blockStore.append(blockStore.read(l).span()) };
+            update.run(moved.segment, moved.offset, id);
+        }
+    };
+    move(stmtSegmentBodies, stmtBodyMove);
+    move(stmtSegmentUndos, stmtUndoMove);
+    blockStore.remove_after_commit(segment);
 }
 
 DeletionKey ChainDB::schedule_protected_all()
@@ -230,10 +519,11 @@ DeletionKey ChainDB::delete_consensus_from(NonzeroHeight height)
     auto dk { cache.deletionKey++ };
     stmtScheduleConsensus.run(dk.value(), height);
     stmtConsensusDeleteFrom.run(height);
+    headerFile.shrink(height - 1);
     return dk;
 }
 
-std::optional<Block> ChainDB::get_block(BlockId id) const
+std::optional<StoredBlock> ChainDB::get_block(BlockId id) const
 {
     auto o { stmtBlockById.one(id) };
     if (!o.has_value())
@@ -242,28 +532,28 @@ std::optional<Block> ChainDB::get_block(BlockId id) const
     if (h == 0) {
         throw std::runtime_error("Database corrupted, block has height 0");
     }
-    return Block {
+    return StoredBlock {
         .height = h.nonzero_assert(),
         .header = o.get_array<80>(1),
-        .body = o.get_vector(2)
+        .body = blockStore.read(location(o, 2))
     };
 }
 
-std::optional<std::pair<BlockId, Block>> ChainDB::get_block(HashView hash) const
+std::optional<std::pair<BlockId, StoredBlock>> ChainDB::get_block(HashView hash) const
 {
     auto o = stmtBlockByHash.one(hash);
     if (!o.has_value())
         return {};
-    Height h { o.get<Height>(0) };
+    Height h { o.get<Height>(1) };
     if (h == 0) {
         throw std::runtime_error("Database corrupted, block has height 0");
     }
-    return std::pair<BlockId, Block> {
+    return std::pair<BlockId, StoredBlock> {
         o.get<BlockId>(0),
-        Block {
+        StoredBlock {
             .height = h.nonzero_assert(),
             .header = o.get_array<80>(2),
-            .body = o.get_vector(3) }
+            .body = blockStore.read(location(o, 3)) }
     };
 }
 
@@ -276,38 +566,67 @@ std::pair<BlockId, bool> ChainDB::insert_protect(const Block& b)
         assert(schedule_exists(*blockId) || consensus_exists(b.height, *blockId));
         return { blockId.value(), false };
     } else {
-        stmtBlockInsert.run(b.height, b.header, b.body.data(), hash);
+        auto l { blockStore.append(b.body.data()) };
+        stmtBlockInsert.run(b.height, b.header, hash, l.segment, l.offset, l.length);
         auto lastId { db.getLastInsertRowid() };
         stmtScheduleInsert.run(lastId, 0);
         return { BlockId(lastId), true };
     }
 }
 
-std::optional<std::tuple<Header, RawBody, RawUndo>>
+std::optional<std::tuple<Header, BlockStore::View, BlockStore::View>>
 ChainDB::get_block_undo(BlockId id) const
 {
     auto a = stmtBlockGetUndo.one(id);
     if (!a.has_value())
         return {};
-    return std::tuple<Header, RawBody, RawUndo> {
+    return std::tuple<Header, BlockStore::View, BlockStore::View> {
         a.get_array<80>(0),
-        { a.get_vector(1) },
-        { a.get_vector(2) }
+        blockStore.read(location(a, 1)),
+        blockStore.read(location(a, 4))
     };
 }
 
 void ChainDB::set_block_undo(BlockId id, const std::vector<uint8_t>& undo)
 {
-    stmtUndoSet.run(undo, id);
+    auto l { blockStore.append(undo) };
+    stmtUndoSet.run(l.segment, l.offset, l.length, id);
 }
 
 void ChainDB::insert_consensus(NonzeroHeight height, BlockId blockId, HistoryId historyCursor, AccountId accountCursor)
 {
     stmtConsensusInsert.run(height, blockId, historyCursor, accountCursor);
     stmtScheduleDelete2.run(blockId);
+    Header header { stmtBlockHeader.one(blockId).get_array<80>(0) };
+    headerFile.append(header, historyCursor, accountCursor);
 }
 
 std::tuple<std::vector<Batch>, HistoryHeights, AccountHeights> ChainDB::getConsensusHeaders() const
+{
+    if (auto c { headerFile.load() }; c && matches_consensus_head(*c))
+        return std::move(*c);
+    spdlog::info("Loading consensus headers from database");
+    auto c { load_consensus_headers() };
+    headerFile.rewrite(c);
+    return c;
+}
+
+bool ChainDB::matches_consensus_head(const HeaderFile::Consensus& c) const
+{
+    auto& [batches, historyHeights, accountHeights] { c };
+    auto o { stmtConsensusHeadHeader.one() };
+    if (!o.has_value() || batches.empty())
+        return false;
+    Height h { o.get<Height>(0) };
+    if (h.value() != historyHeights.size() || h == 0)
+        return false;
+    auto nh { h.nonzero_assert() };
+    return historyHeights.at(nh) == o.get<HistoryId>(1)
+        && accountHeights.at(nh) == o.get<AccountId>(2)
+        && Header(batches.back().last()) == Header(o.get_array<80>(3));
+}
+
+HeaderFile::Consensus ChainDB::load_consensus_headers() const
 {
     uint32_t h = 1;
     std::vector<Batch> batches;
@@ -360,70 +679,76 @@ HistoryId ChainDB::insertHistory(const HashView hash,
     return cache.nextHistoryId++;
 }
 
+HistoryId ChainDB::insert_history(const std::vector<history::Entry>& entries)
+{
+    const HistoryId first { cache.nextHistoryId };
+    if (bulkWrites == BulkWrites::PerRow) {
+        for (auto& e : entries)
+            insertHistory(e.hash, e.data);
+        return first;
+    }
+    stmtHistoryInserts.run(entries, [&](Statement2& st, int i, auto& e) {
+        st.bind(i, (int64_t)cache.nextHistoryId.value());
+        st.bind(i + 1, e.hash);
+        st.bind(i + 2, e.data);
+        ++cache.nextHistoryId;
+    });
+    return first;
+}
+
 void ChainDB::delete_history_from(NonzeroHeight h)
 {
     const int64_t nextHistoryId = stmtConsensusSelectHistory.one(h).get<int64_t>(0);
     assert(nextHistoryId >= 0);
     stmtHistoryDeleteFrom.run(nextHistoryId);
     stmtAccountHistoryDeleteFrom.run(nextHistoryId);
+    if (indexing_deferred())
+        stmtAccountHistoryLogDeleteFrom->run(nextHistoryId);
     cache.nextHistoryId = HistoryId{nextHistoryId};
 }
 
-std::optional<std::pair<std::vector<uint8_t>, HistoryId>> ChainDB::lookup_history(const HashView hash)
-{
-    auto o = stmtHistoryLookup.one(hash);
-    if (!o.has_value())
-        return {};
-    auto index { HistoryId{o.get<int64_t>(0)} };
-    assert(index > HistoryId{0});
-    return std::pair {
-        o.get_vector(1),
-        index
-    };
-}
-
-std::vector<std::pair<Hash, std::vector<uint8_t>>> ChainDB::lookupHistoryRange(HistoryId lower, HistoryId upper)
-{
-    std::vector<std::pair<Hash, std::vector<uint8_t>>> out;
-    int64_t l = lower.value();
-    int64_t u = (upper == HistoryId{0} ? std::numeric_limits<int64_t>::max() : upper.value());
-    stmtHistoryLookupRange.for_each([&](Statement2::Row& r) {
-        out.push_back(
-            { r.get_array<32>(0),
-                r.get_vector(1) });
-    },
-        l, u);
-    return out;
-}
-
 void ChainDB::insertAccountHistory(AccountId accountId, HistoryId historyId)
 {
-    stmtAccountHistoryInsert.run(accountId, historyId);
+    if (indexing_deferred())
+        stmtAccountHistoryLogInsert->run(historyId, accountId);
+    else
+        stmtAccountHistoryInsert.run(accountId, historyId);
+}
+
+void ChainDB::insert_account_history(const std::vector<std::pair<AccountId, HistoryId>>& rows)
+{
+    if (bulkWrites == BulkWrites::PerRow) {
+        for (auto& [accountId, historyId] : rows)
+            insertAccountHistory(accountId, historyId);
+    } else if (indexing_deferred()) {
+        stmtAccountHistoryLogInserts->run(rows, [](Statement2& st, int i, auto& r) {
+            st.bind(i, r.second);
+            st.bind(i + 1, r.first);
+        });
+    } else if (bulkWrites == BulkWrites::MultiRow) {
+        stmtAccountHistoryInserts.run(rows, [](Statement2& st, int i, auto& r) {
+            st.bind(i, r.first);
+            st.bind(i + 1, r.second);
+        });
+    } else {
+        stmtAccountHistoryInsertsJson.run(json_pairs(
+            rows, [](auto& r) { return r.first.value(); }, [](auto& r) { return r.second.value(); }));
+    }
 }
 
 std::optional<AccountFunds> ChainDB::lookup_address(const AddressView address) const
 {
+    if (auto c { accountCache.lookup(address) })
+        return c;
     auto p = stmtAddressLookup.one(address);
     if (!p.has_value())
         return {};
-    return AccountFunds{
+    AccountFunds res {
         p.get<AccountId>(0),
         p.get<Funds>(1)
     };
-}
-
-std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> ChainDB::lookup_history_100_desc(
-    AccountId accountId, int64_t beforeId)
-{
-    std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> out;
-    stmtHistoryById.for_each(
-        [&](Statement2::Row& row) {
-            out.push_back({ HistoryId{row.get<uint64_t>(0)},
-                row.get_array<32>(1),
-                row.get_vector(2) });
-        },
-        accountId, beforeId);
-    return out;
+    accountCache.insert(res.accointId, { Address(address), res.funds });
+    return res;
 }
 
 AddressFunds ChainDB::fetch_account(AccountId id) const
@@ -437,24 +762,29 @@ AddressFunds ChainDB::fetch_account(AccountId id) const
 
 std::optional<AddressFunds> ChainDB::lookup_account(AccountId id) const
 {
+    if (auto c { accountCache.lookup(id) })
+        return c;
     auto o { stmtAccountLookup.one(id) };
     if (!o.has_value())
         return {};
-    return AddressFunds {
+    AddressFunds res {
         .address = o.get_array<20>(0),
         .funds = o.get<Funds>(1)
     };
+    accountCache.insert(id, res);
+    return res;
 }
 
-API::Richlist ChainDB::lookup_richlist(uint32_t N) const
+std::vector<std::pair<AccountId, AddressFunds>> ChainDB::lookup_richlist(size_t N) const
 {
-    API::Richlist out;
+    std::vector<std::pair<AccountId, AddressFunds>> out;
     stmtRichlistLookup.for_each([&](Statement2::Row& r) {
-        out.entries.push_back(
-            { Address { r.get_array<20>(0) },
-                r.get<Funds>(1) });
+        out.push_back({ r.get<AccountId>(0),
+            AddressFunds {
+                .address = r.get_array<20>(1),
+                .funds = r.get<Funds>(2) } });
     },
-        N);
+        int64_t(N));
     return out;
 }
 
@@ -463,18 +793,6 @@ std::optional<BlockId> ChainDB::lookup_block_id(const HashView hash) const
     return stmtBlockIdSelect.one(hash);
 }
 
-std::optional<NonzeroHeight> ChainDB::lookup_block_height(const HashView hash) const
-{
-    auto o { stmtBlockHeightSelect.one(hash) };
-    if (!o.has_value())
-        return {};
-    auto h{o.get<Height>(0)};
-    if (h == 0) {
-        throw std::runtime_error("Database corrupted, block " +serialize_hex(hash) + " has invalid height 0.");
-    }
-    return h.nonzero_assert();
-}
-
 void ChainDB::delete_bad_block(HashView blockhash)
 {
     auto o = stmtBlockIdSelect.one(blockhash);
@@ -489,10 +807,10 @@ void ChainDB::delete_bad_block(HashView blockhash)
 }
 
 namespace {
-std::vector<TransactionId> read_tx_ids(const BodyContainer& body,
-    NonzeroHeight height)
+std::vector<TransactionId> read_tx_ids(const StoredBlock& b)
 {
-    BodyView bv(body.view(height));
+    const NonzeroHeight height { b.height };
+    BodyView bv(b.body_view());
     if (!bv.valid())
         throw std::runtime_error(
             "Database corrupted (invalid block body at height " + std::to_string(height) + ".");
@@ -524,7 +842,7 @@ chainserver::TransactionIds ChainDB::fetch_tx_ids(Height height) const
         }
         assert(height == b->height);
         assert(b->body.size() > 0);
-        for (auto& tid : read_tx_ids(b->body, b->height)) {
+        for (auto& tid : read_tx_ids(*b)) {
             if (out.emplace(tid).second == false) {
                 throw std::runtime_error(
                     "Database corrupted (duplicate transaction id in chain)");
@@ -1,22 +1,25 @@
 #pragma once
 
 #include "SQLiteCpp/SQLiteCpp.h"
+#include "account_state_cache.hpp"
 #include "block/block.hpp"
 #include "block/chain/offsts.hpp"
 #include "block/id.hpp"
+#include "block_store.hpp"
+#include "header_file.hpp"
 #include "chain/deletion_key.hpp"
 #include "chainserver/transaction_ids.hpp"
 #include "general/address_funds.hpp"
 #include "general/filelock/filelock.hpp"
 #include "api/types/forward_declarations.hpp"
+#include <deque>
 class ChainDBTransaction;
 class Batch;
 struct SignedSnapshot;
 class Headerchain;
-struct RawBody : public std::vector<uint8_t> {
-};
-struct RawUndo : public std::vector<uint8_t> {
-};
+namespace history {
+struct Entry;
+}
 
 struct Column2 : public SQLite::Column {
 
@@ -227,23 +230,121 @@ public:
     }
 };
 
+// Writes many rows with few statement executions: full chunks of 64
+// rows go through one multi-row statement, the remainder through
+// statements of 8 and 1 rows. The statement is prefix, the row
+// placeholders separated by commas and suffix.
+class MultiRowStatement {
+public:
+    MultiRowStatement(SQLite::Database& db, const std::string& prefix, size_t columns, const std::string& suffix = "")
+        : columns(columns)
+    {
+        std::string row { "(?" };
+        for (size_t i = 1; i < columns; ++i)
+            row += ",?";
+        row += ")";
+        for (auto n : CHUNKS) {
+            std::string sql { prefix + row };
+            for (size_t i = 1; i < n; ++i)
+                sql += "," + row;
+            statements.emplace_back(db, sql + suffix);
+        }
+    }
+    // bind(statement, firstIndex, row) binds the columns of one row
+    template <typename Range, typename Bind>
+    void run(const Range& rows, Bind bind)
+    {
+        auto iter { rows.begin() };
+        size_t remaining { rows.size() };
+        for (size_t k = 0; k < CHUNKS.size(); ++k) {
+            auto& st { statements[k] };
+            for (; remaining >= CHUNKS[k]; remaining -= CHUNKS[k]) {
+                for (size_t j = 0; j < CHUNKS[k]; ++j, ++iter)
+                    bind(st, int(j * columns + 1), *iter);
+                st.exec();
+                st.reset();
+            }
+        }
+    }
+
+private:
+    static constexpr std::array<size_t, 3> CHUNKS { 64, 8, 1 };
+    size_t columns;
+    std::deque<Statement2> statements;
+};
+
+// Block as read from the database, the body is viewed in the block
+// store instead of being copied.
+struct StoredBlock {
+    NonzeroHeight height;
+    Header header;
+    BlockStore::View body;
+    BodyView body_view() const { return { body.span(), height }; }
+    Block copy() const { return { height, header, BodyContainer(body.span()) }; }
+};
+
 class ChainDB {
 private:
     friend class ChainDBTransaction;
     // ids to save additional information in tables
     static constexpr int64_t WORKSUMID = -1;
     static constexpr int64_t SIGNEDPINID = -2;
+    static constexpr size_t ACCOUNTCACHESIZE = 100000;
 
 public:
     ChainDB(const std::string& path);
+    const std::string& path() const { return db.getFilename(); }
     [[nodiscard]] ChainDBTransaction transaction();
+
+    // Group commit: while a group is open, transactions are nested into
+    // one database transaction which is made durable by commit_group().
+    void begin_group();
+    void commit_group();
+    bool group_open() const { return groupOpen; }
+    // With relaxed durability (synchronous=NORMAL) the WAL is only synced
+    // on checkpoints. The database stays consistent after power loss but
+    // the most recent commits may be lost.
+    void set_relaxed_durability(bool relaxed);
+
+    // Deferred indexing for initial sync: the hash index of History is
+    // dropped and account history rows are appended to a log table in
+    // history order instead of being inserted into the AccountHistory
+    // B-tree. build_indices_step() moves the log rows of the lowest
+    // history ids, about `rows` of them, sorted into AccountHistory
+    // and returns the history id indexed up to. The last step recreates
+    // the hash index and returns nullopt. Unlike the other steps it is
+    // not bounded, it sorts the whole History table. The state survives
+    // restarts.
+    bool indexing_deferred() const { return stmtAccountHistoryLogInsert.has_value(); }
+    void defer_indexing();
+    std::optional<HistoryId> build_indices_step(size_t rows);
     void set_balance(AccountId stateId, Funds newbalance)
     {
         stmtStateSetBalance.run(newbalance, stateId);
+        accountCache.set_balance(stateId, newbalance);
     };
     void insertStateEntry(const AddressView address, Funds balance,
         AccountId verifyNextStateId);
 
+    // Bulk versions of set_balance, insertStateEntry, insertHistory and
+    // insertAccountHistory used when applying and rolling back blocks.
+    // How they reach SQLite is chosen by set_bulk_writes(): per-row
+    // statements, multi-row VALUES statements or one json_each() batch
+    // per table. json_each() only covers the integer tables, our SQLite
+    // has no unhex() to pass blobs as JSON text. Per-row statements are
+    // the default because the batches were slower in bench-bulk-write.
+    enum class BulkWrites {
+        PerRow,
+        MultiRow,
+        JsonEach
+    };
+    void set_bulk_writes(BulkWrites w) { bulkWrites = w; }
+    void set_balances(const std::vector<std::pair<AccountId, Funds>>& balances);
+    void insert_state_entries(const std::vector<std::tuple<AddressView, Funds, AccountId>>& entries);
+    // returns the history id of the first entry
+    HistoryId insert_history(const std::vector<history::Entry>& entries);
+    void insert_account_history(const std::vector<std::pair<AccountId, HistoryId>>& rows);
+
     void delete_state_from(AccountId fromAccountId);
     // void setStateBalance(AccountId accountId, Funds balance);
     void insert_consensus(NonzeroHeight height, BlockId blockId, HistoryId historyCursor, AccountId accountCursor);
@@ -261,6 +362,9 @@ public:
     // delete schedule functiosn
     [[nodiscard]] DeletionKey delete_consensus_from(NonzeroHeight height);
 
+    // Compaction deletes segment files right after the commit, so this
+    // must not run inside a group or with relaxed durability: the WAL
+    // could lose the commit and still reference the deleted segments.
     void garbage_collect_blocks(DeletionKey);
     [[nodiscard]] DeletionKey schedule_protected_all();
     [[nodiscard]] DeletionKey schedule_protected_part(Headerchain hc, NonzeroHeight fromHeight);
@@ -270,10 +374,10 @@ public:
     // Block functions
     // get
     [[nodiscard]] std::optional<BlockId> lookup_block_id(const HashView hash) const;
-    [[nodiscard]] std::optional<NonzeroHeight> lookup_block_height(const HashView hash) const;
-    [[nodiscard]] std::optional<std::tuple<Header, RawBody, RawUndo>> get_block_undo(BlockId id) const;
-    [[nodiscard]] std::optional<Block> get_block(BlockId id) const;
-    [[nodiscard]] std::optional<std::pair<BlockId, Block>> get_block(HashView hash) const;
+    // body and undo views keep their segment mapped while held
+    [[nodiscard]] std::optional<std::tuple<Header, BlockStore::View, BlockStore::View>> get_block_undo(BlockId id) const;
+    [[nodiscard]] std::optional<StoredBlock> get_block(BlockId id) const;
+    [[nodiscard]] std::optional<std::pair<BlockId, StoredBlock>> get_block(HashView hash) const;
     // set
     std::pair<BlockId, bool> insert_protect(const Block&);
     void set_block_undo(BlockId id, const std::vector<uint8_t>& undo);
@@ -282,12 +386,9 @@ public:
     // Account functions
     // get
     [[nodiscard]] std::optional<AddressFunds> lookup_account(AccountId id) const;
-    [[nodiscard]] API::Richlist lookup_richlist(uint32_t N) const;
     [[nodiscard]] AddressFunds fetch_account(AccountId id) const;
-
-    /////////////////////
-    // Transactions functions
-    [[nodiscard]] API::Richlist look(size_t N) const;
+    [[nodiscard]] AccountCacheStats account_cache_stats() const { return accountCache.stats(); }
+    [[nodiscard]] std::vector<std::pair<AccountId, AddressFunds>> lookup_richlist(size_t N) const;
 
     ///////////////
     // Deleteschedule functions
@@ -312,23 +413,30 @@ public:
     HistoryId insertHistory(const HashView hash,
         const std::vector<uint8_t>& data);
     void delete_history_from(NonzeroHeight);
-    std::optional<std::pair<std::vector<uint8_t>, HistoryId>> lookup_history(const HashView hash);
-
-    std::vector<std::pair<Hash, std::vector<uint8_t>>>
-    lookupHistoryRange(HistoryId lower, HistoryId upper);
     void insertAccountHistory(AccountId accountId, HistoryId historyId);
     HistoryId next_history_id() const { return cache.nextHistoryId; }
 
     //////////////////////////////
     // BELOW METHODS REQUIRED FOR INDEXING NODES
     std::optional<AccountFunds> lookup_address(const AddressView address) const; // for indexing nodes
-    std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> lookup_history_100_desc(AccountId account_id, int64_t beforeId);
 
 
 
 private:
     [[nodiscard]] bool schedule_exists(BlockId dk);
     [[nodiscard]] bool consensus_exists(Height h, BlockId dk);
+    void compact_segment(int64_t segment);
+    void prepare_account_history_log();
+    [[nodiscard]] bool matches_consensus_head(const HeaderFile::Consensus&) const;
+    [[nodiscard]] HeaderFile::Consensus load_consensus_headers() const;
+    static std::string blocks_table_schema(const std::string& name)
+    {
+        return "CREATE TABLE IF NOT EXISTS `" + name + "` ( `height` INTEGER "
+               "NOT NULL, `header` BLOB NOT NULL, `hash` BLOB NOT NULL UNIQUE, "
+               "`body_file` INTEGER NOT NULL, `body_offset` INTEGER NOT NULL, "
+               "`body_length` INTEGER NOT NULL, `undo_file` INTEGER DEFAULT null, "
+               "`undo_offset` INTEGER DEFAULT null, `undo_length` INTEGER DEFAULT null )";
+    }
 
 private:
     SQLite::Database db;
@@ -337,14 +445,14 @@ private:
         CreateTables(SQLite::Database& db)
         {
             db.exec("PRAGMA foreign_keys = ON");
+            // WAL allows API readers to run concurrently with the writer
+            db.exec("PRAGMA journal_mode = WAL");
             db.exec("CREATE TABLE IF NOT EXISTS `AccountHistory` (`account_id` "
                     "INTEGER, `history_id` INTEGER, PRIMARY "
                     "KEY(`account_id`,`history_id`)) "
                     "WITHOUT ROWID");
 
-            db.exec("CREATE TABLE IF NOT EXISTS `Blocks` ( `height` INTEGER "
-                    "NOT NULL, `header` BLOB NOT NULL, `body` BLOB NOT NULL, "
-                    "`undo` BLOB DEFAULT null, `hash` BLOB NOT NULL UNIQUE )");
+            db.exec(blocks_table_schema("Blocks"));
             db.exec("CREATE TABLE IF NOT EXISTS \"Consensus\" ( `height` INTEGER NOT "
                     "NULL, `block_id` INTEGER NOT NULL, `history_cursor` INTEGER NOT "
                     "NULL, `account_cursor` INTEGER NOT NULL, PRIMARY KEY(`height`) )");
@@ -368,16 +476,29 @@ private:
                     "`AccountHistory` (`history_id` ASC)");
             db.exec("CREATE TABLE IF NOT EXISTS `History` ( `id` INTEGER NOT NULL, "
                     "`hash` BLOB NOT NULL, `data` BLOB NOT NULL, PRIMARY KEY(`id`))");
-            db.exec("CREATE INDEX IF NOT EXISTS `history_index` ON "
-                    "`History` (`hash` ASC)");
+            if (!db.tableExists("AccountHistoryLog"))
+                db.exec("CREATE INDEX IF NOT EXISTS `history_index` ON "
+                        "`History` (`hash` ASC)");
         }
     } createTables;
+    BlockStore blockStore;
+    struct InitBlockStore {
+        // moves legacy BLOB columns into the block store and
+        // restores the write position
+        InitBlockStore(SQLite::Database& db, BlockStore& bs);
+        static void migrate_legacy(SQLite::Database& db, BlockStore& bs);
+    } initBlockStore;
+    mutable HeaderFile headerFile;
     struct Cache {
         AccountId maxStateId;
         HistoryId nextHistoryId;
         DeletionKey deletionKey;
         static Cache init(SQLite::Database& db);
     } cache;
+    mutable AccountStateCache accountCache { ACCOUNTCACHESIZE };
+    bool groupOpen { false };
+    bool relaxedDurability { false };
+    BulkWrites bulkWrites { BulkWrites::PerRow };
     Statement2 stmtBlockInsert;
     Statement2 stmtUndoSet;
     mutable Statement2 stmtBlockGetUndo;
@@ -386,6 +507,8 @@ private:
 
     // Consensus table functions
     mutable Statement2 stmtConsensusHeaders;
+    mutable Statement2 stmtConsensusHeadHeader;
+    mutable Statement2 stmtBlockHeader;
     Statement2 stmtConsensusInsert;
     // Statement2 stmtConsensusSet;
     Statement2 stmtConsensusSetProperty;
@@ -401,47 +524,86 @@ private:
     Statement2 stmtScheduleProtected;
     Statement2 stmtScheduleDelete2;
     Statement2 stmtScheduleConsensus;
+    mutable Statement2 stmtGCSegments;
     Statement2 stmtDeleteGCBlocks;
     Statement2 stmtDeleteGCRefs;
+    Statement2 stmtSegmentLive;
+    Statement2 stmtSegmentBodies;
+    Statement2 stmtSegmentUndos;
+    Statement2 stmtBodyMove;
+    Statement2 stmtUndoMove;
 
     Statement2 stmtStateInsert;
     Statement2 stmtStateDeleteFrom;
     Statement2 stmtStateSetBalance;
+    MultiRowStatement stmtStateSetBalances;
+    MultiRowStatement stmtStateInserts;
+    Statement2 stmtStateSetBalancesJson;
     Statement2 stmtBadblockInsert;
     mutable Statement2 stmtBadblockGet;
     mutable Statement2 stmtAccountLookup;
     mutable Statement2 stmtRichlistLookup;
     Statement2 stmtHistoryInsert;
     Statement2 stmtHistoryDeleteFrom;
-    mutable Statement2 stmtHistoryLookup;
-    mutable Statement2 stmtHistoryLookupRange;
     Statement2 stmtAccountHistoryInsert;
+    MultiRowStatement stmtHistoryInserts;
+    MultiRowStatement stmtAccountHistoryInserts;
+    Statement2 stmtAccountHistoryInsertsJson;
     Statement2 stmtAccountHistoryDeleteFrom;
+    std::optional<Statement2> stmtAccountHistoryLogInsert; // while indexing is deferred
+    std::optional<MultiRowStatement> stmtAccountHistoryLogInserts;
+    std::optional<Statement2> stmtAccountHistoryLogDeleteFrom;
+    std::optional<Statement2> stmtAccountHistoryLogCutoff;
+    std::optional<Statement2> stmtAccountHistoryLogMoveBelow;
+    std::optional<Statement2> stmtAccountHistoryLogDeleteBelow;
 
     mutable Statement2 stmtBlockIdSelect;
-    mutable Statement2 stmtBlockHeightSelect;
     Statement2 stmtBlockDelete;
 
     mutable Statement2 stmtAddressLookup;
-    mutable Statement2 stmtHistoryById;
 };
+// Inside an open group (see ChainDB::begin_group) the transaction is a
+// savepoint and its changes become durable when the group commits.
 class ChainDBTransaction {
 public:
     void commit()
     {
-        tx.commit();
+        if (!tx) {
+            parent->db.exec("RELEASE chaindb");
+            commited = true;
+            return;
+        }
+        parent->blockStore.sync();
+        tx->commit();
         commited = true;
+        parent->accountCache.on_commit();
+        parent->blockStore.on_commit();
+        parent->headerFile.on_commit();
     }
     ~ChainDBTransaction()
     {
         if (parent != nullptr && !commited) {
             parent->cache = c;
+            parent->accountCache.on_rollback();
+            parent->blockStore.rollback_to(blockStore);
+            if (tx) {
+                parent->headerFile.on_rollback();
+            } else {
+                try {
+                    parent->db.exec("ROLLBACK TO chaindb");
+                    parent->db.exec("RELEASE chaindb");
+                } catch (SQLite::Exception&) {
+                }
+                parent->headerFile.rollback_to(std::move(*headerFile));
+            }
         }
     }
     ChainDBTransaction(const ChainDBTransaction&) = delete;
     ChainDBTransaction(ChainDBTransaction&& other)
         : parent(other.parent)
         , tx(std::move(other.tx))
+        , blockStore(other.blockStore)
+        , headerFile(std::move(other.headerFile))
         , c(std::move(other.c))
     {
         other.commited = true;
@@ -451,12 +613,20 @@ private:
     friend class ChainDB;
     ChainDBTransaction(ChainDB& parent)
         : parent(&parent)
-        , tx(parent.db)
+        , blockStore(parent.blockStore.savepoint())
         , c(parent.cache)
     {
+        if (parent.groupOpen) {
+            headerFile = parent.headerFile.savepoint();
+            parent.db.exec("SAVEPOINT chaindb");
+        } else {
+            tx.emplace(parent.db);
+        }
     }
     bool commited = false;
     ChainDB* parent;
-    SQLite::Transaction tx;
+    std::optional<SQLite::Transaction> tx;
+    BlockStore::Savepoint blockStore;
+    std::optional<HeaderFile::Savepoint> headerFile; // inside a group
     ChainDB::Cache c;
 };
@@ -0,0 +1,144 @@
+#include "chain_db_reader.hpp"
+#include "api/types/all.hpp"
+#include "general/hex.hpp"
+
+ChainDBReader::ReadTransaction::ReadTransaction(SQLite::Database& db)
+    : db(db)
+{
+    db.exec("BEGIN");
+}
+
+ChainDBReader::ReadTransaction::~ReadTransaction()
+{
+    try {
+        db.exec("COMMIT");
+    } catch (...) {
+    }
+}
+
+ChainDBReader::ChainDBReader(const std::string& path)
+    : db(path, SQLite::OPEN_READONLY, 5000)
+    , stmtConsensusHead(db, "SELECT c.height, b.hash FROM `Consensus` c JOIN `Blocks` b "
+                            "ON b.ROWID=c.block_id WHERE c.height>0 ORDER BY c.height DESC LIMIT 1")
+    , stmtBlockHeightSelect(db, "SELECT `height` FROM `Blocks` WHERE `hash`=?")
+    , stmtAccountLookup(db, "SELECT `Address`, `Balance` FROM `State` WHERE ROWID=?")
+    , stmtAddressLookup(db, "SELECT `ROWID`,`balance` FROM `State` WHERE `address`=?")
+    , stmtNextHistoryId(db, "SELECT coalesce(max(id)+1,1) FROM `History`")
+    , stmtIndexingDeferred(db, "SELECT count(*) FROM `sqlite_master` WHERE `type`='table' AND `name`='AccountHistoryLog'")
+    , stmtHistoryLookup(db, "SELECT `id`, `data` FROM `History` WHERE `hash`=?")
+    , stmtHistoryLookupRange(db, "SELECT `hash`, `data` FROM `History` WHERE `id`>=? AND`id`<?")
+    , stmtHistoryById(db, "SELECT h.id, `hash`,`data` FROM `History` `h` JOIN "
+                          "`AccountHistory` `ah` ON h.id=`ah`.history_id WHERE "
+                          "ah.`account_id`=? AND h.id<? ORDER BY h.id DESC LIMIT 100")
+{
+}
+
+auto ChainDBReader::read_transaction() -> ReadTransaction
+{
+    return ReadTransaction(db);
+}
+
+std::optional<std::pair<NonzeroHeight, Hash>> ChainDBReader::consensus_head() const
+{
+    auto o { stmtConsensusHead.one() };
+    if (!o.has_value())
+        return {};
+    auto h { o.get<Height>(0) };
+    if (h == 0)
+        throw std::runtime_error("Database corrupted, consensus head has height 0.");
+    return std::pair<NonzeroHeight, Hash> { h.nonzero_assert(), o.get_array<32>(1) };
+}
+
+std::optional<NonzeroHeight> ChainDBReader::lookup_block_height(const HashView hash) const
+{
+    auto o { stmtBlockHeightSelect.one(hash) };
+    if (!o.has_value())
+        return {};
+    auto h { o.get<Height>(0) };
+    if (h == 0) {
+        throw std::runtime_error("Database corrupted, block " + serialize_hex(hash) + " has invalid height 0.");
+    }
+    return h.nonzero_assert();
+}
+
+std::optional<AddressFunds> ChainDBReader::lookup_account(AccountId id) const
+{
+    auto o { stmtAccountLookup.one(id) };
+    if (!o.has_value())
+        return {};
+    return AddressFunds {
+        .address = o.get_array<20>(0),
+        .funds = o.get<Funds>(1)
+    };
+}
+
+AddressFunds ChainDBReader::fetch_account(AccountId id) const
+{
+    auto p = lookup_account(id);
+    if (!p) {
+        throw std::runtime_error("Database corrupted (fetch_account(" + std::to_string(id.value()) + ")");
+    }
+    return *p;
+}
+
+std::optional<AccountFunds> ChainDBReader::lookup_address(const AddressView address) const
+{
+    auto p = stmtAddressLookup.one(address);
+    if (!p.has_value())
+        return {};
+    return AccountFunds {
+        p.get<AccountId>(0),
+        p.get<Funds>(1)
+    };
+}
+
+HistoryId ChainDBReader::next_history_id() const
+{
+    return stmtNextHistoryId.one().get<HistoryId>(0);
+}
+
+bool ChainDBReader::indexing_deferred() const
+{
+    return stmtIndexingDeferred.one().get<int64_t>(0) != 0;
+}
+
+std::optional<std::pair<std::vector<uint8_t>, HistoryId>> ChainDBReader::lookup_history(const HashView hash) const
+{
+    auto o = stmtHistoryLookup.one(hash);
+    if (!o.has_value())
+        return {};
+    auto index { HistoryId { o.get<int64_t>(0) } };
+    assert(index > HistoryId { 0 });
+    return std::pair {
+        o.get_vector(1),
+        index
+    };
+}
+
+std::vector<std::pair<Hash, std::vector<uint8_t>>> ChainDBReader::lookup_history_range(HistoryId lower, HistoryId upper) const
+{
+    std::vector<std::pair<Hash, std::vector<uint8_t>>> out;
+    int64_t l = lower.value();
+    int64_t u = (upper == HistoryId { 0 } ? std::numeric_limits<int64_t>::max() : upper.value());
+    stmtHistoryLookupRange.for_each([&](Statement2::Row& r) {
+        out.push_back(
+            { r.get_array<32>(0),
+                r.get_vector(1) });
+    },
+        l, u);
+    return out;
+}
+
+std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> ChainDBReader::lookup_history_100_desc(
+    AccountId accountId, int64_t beforeId) const
+{
+    std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> out;
+    stmtHistoryById.for_each(
+        [&](Statement2::Row& row) {
+            out.push_back({ HistoryId { row.get<uint64_t>(0) },
+                row.get_array<32>(1),
+                row.get_vector(2) });
+        },
+        accountId, beforeId);
+    return out;
+}
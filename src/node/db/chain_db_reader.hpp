@@ -0,0 +1,50 @@
+#pragma once
+#include "chain_db.hpp"
+
+// Read-only connection to the chain database. Several readers can
+// query concurrently with the writing ChainDB connection because the
+// database runs in WAL mode. Each reader must only be used by one
+// thread at a time.
+class ChainDBReader {
+public:
+    // Queries within a read transaction observe a consistent state
+    // of the database even if the writer commits meanwhile.
+    class ReadTransaction {
+    public:
+        ReadTransaction(const ReadTransaction&) = delete;
+        ~ReadTransaction();
+
+    private:
+        friend class ChainDBReader;
+        ReadTransaction(SQLite::Database& db);
+        SQLite::Database& db;
+    };
+
+    ChainDBReader(const std::string& path);
+    [[nodiscard]] ReadTransaction read_transaction();
+
+    [[nodiscard]] std::optional<std::pair<NonzeroHeight, Hash>> consensus_head() const;
+    [[nodiscard]] std::optional<NonzeroHeight> lookup_block_height(const HashView hash) const;
+    [[nodiscard]] std::optional<AddressFunds> lookup_account(AccountId id) const;
+    [[nodiscard]] AddressFunds fetch_account(AccountId id) const;
+    [[nodiscard]] std::optional<AccountFunds> lookup_address(const AddressView address) const;
+    [[nodiscard]] HistoryId next_history_id() const;
+    // lookups by transaction hash and by account are unavailable while
+    // the writer defers indexing
+    [[nodiscard]] bool indexing_deferred() const;
+    [[nodiscard]] std::optional<std::pair<std::vector<uint8_t>, HistoryId>> lookup_history(const HashView hash) const;
+    [[nodiscard]] std::vector<std::pair<Hash, std::vector<uint8_t>>> lookup_history_range(HistoryId lower, HistoryId upper) const;
+    [[nodiscard]] std::vector<std::tuple<HistoryId, Hash, std::vector<uint8_t>>> lookup_history_100_desc(AccountId accountId, int64_t beforeId) const;
+
+private:
+    SQLite::Database db;
+    mutable Statement2 stmtConsensusHead;
+    mutable Statement2 stmtBlockHeightSelect;
+    mutable Statement2 stmtAccountLookup;
+    mutable Statement2 stmtAddressLookup;
+    mutable Statement2 stmtNextHistoryId;
+    mutable Statement2 stmtIndexingDeferred;
+    mutable Statement2 stmtHistoryLookup;
+    mutable Statement2 stmtHistoryLookupRange;
+    mutable Statement2 stmtHistoryById;
+};
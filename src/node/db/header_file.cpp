@@ -0,0 +1,149 @@
+#include "header_file.hpp"
+#include "block/header/view_inline.hpp"
+#include "crypto/sha256_batch.hpp"
+#include "general/mapped_file/mapped_file.hpp"
+#include "general/reader.hpp"
+#include "general/writer.hpp"
+#include <filesystem>
+
+namespace {
+constexpr size_t CHECKEDSIZE = HeaderFile::RECORDSIZE - 4;
+
+void encode(uint8_t* out, HeaderView header, HistoryId historyCursor, AccountId accountCursor)
+{
+    Writer w(out, HeaderFile::RECORDSIZE);
+    w << Range(header.data(), 80) << historyCursor.value() << accountCursor.value();
+    auto h { sha256::hash(out, CHECKEDSIZE) };
+    memcpy(out + CHECKEDSIZE, h.data(), 4);
+}
+}
+
+HeaderFile::HeaderFile(const std::string& dbPath)
+{
+    if (dbPath.empty())
+        return;
+    path = std::filesystem::path(dbPath).replace_extension("headers").string();
+    file = std::make_unique<WritableFile>(path);
+    auto size { std::filesystem::file_size(path) };
+    length = keep = size / RECORDSIZE;
+}
+
+HeaderFile::~HeaderFile() = default;
+
+auto HeaderFile::load() const -> std::optional<Consensus>
+{
+    if (!file || length == 0)
+        return {};
+    MappedFile m(path);
+    if (m.size() != length * RECORDSIZE)
+        return {};
+
+    // Verify checksums and header links in chunks. Records are written
+    // without sync, after a crash stale records from another fork can
+    // remain before the tip, which is checked against the database.
+    // Linked headers ending in that tip are the consensus headers.
+    constexpr size_t CHUNK = 4096;
+    std::vector<Hash> hashes(CHUNK);
+    Hash prev { Hash::genesis() };
+    for (size_t i = 0; i < length; i += CHUNK) {
+        const size_t n { std::min(CHUNK, length - i) };
+        const uint8_t* p { m.data() + i * RECORDSIZE };
+        sha256::hash_batch(p, RECORDSIZE, CHECKEDSIZE, n, hashes.data());
+        for (size_t j = 0; j < n; ++j) {
+            if (memcmp(hashes[j].data(), p + j * RECORDSIZE + CHECKEDSIZE, 4) != 0)
+                return {};
+        }
+        // header hashes are double SHA256
+        sha256::hash_batch(p, RECORDSIZE, 80, n, hashes.data());
+        sha256::hash_batch(hashes[0].data(), 32, 32, n, hashes.data());
+        for (size_t j = 0; j < n; ++j) {
+            if (HeaderView(p + j * RECORDSIZE).prevhash() != prev)
+                return {};
+            prev = hashes[j];
+        }
+    }
+
+    std::vector<Batch> batches;
+    HistoryHeights historyHeights;
+    AccountHeights accountHeights;
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i < length; ++i) {
+        const uint8_t* p { m.data() + i * RECORDSIZE };
+        if (bytes.size() == HEADERBATCHSIZE * 80)
+            batches.push_back(Batch(std::move(bytes)));
+        if (bytes.empty())
+            bytes.reserve(HEADERBATCHSIZE * 80);
+        bytes.insert(bytes.end(), p, p + 80);
+        historyHeights.append(HistoryId(readuint64(p + 80)));
+        accountHeights.append(AccountId(readuint64(p + 88)));
+    }
+    if (bytes.size() > 0)
+        batches.push_back(Batch(std::move(bytes)));
+    return Consensus { std::move(batches), std::move(historyHeights), std::move(accountHeights) };
+}
+
+void HeaderFile::rewrite(const Consensus& c)
+{
+    if (!file)
+        return;
+    auto& [batches, historyHeights, accountHeights] { c };
+    std::vector<uint8_t> out;
+    out.reserve(historyHeights.size() * RECORDSIZE);
+    NonzeroHeight h { 1u };
+    for (auto& b : batches) {
+        for (auto hv : b) {
+            out.resize(out.size() + RECORDSIZE);
+            encode(out.data() + out.size() - RECORDSIZE, hv,
+                historyHeights.at(h), accountHeights.at(h));
+            ++h;
+        }
+    }
+    length = 0;
+    pending.clear();
+    write(out.data(), out.size() / RECORDSIZE);
+}
+
+void HeaderFile::append(HeaderView header, HistoryId historyCursor, AccountId accountCursor)
+{
+    if (!file)
+        return;
+    pending.resize(pending.size() + RECORDSIZE);
+    encode(pending.data() + pending.size() - RECORDSIZE, header, historyCursor, accountCursor);
+}
+
+void HeaderFile::shrink(Height newlength)
+{
+    if (!file)
+        return;
+    const size_t n { newlength.value() };
+    if (n <= keep) {
+        keep = n;
+        pending.clear();
+    } else if (n < keep + pending.size() / RECORDSIZE) {
+        pending.resize((n - keep) * RECORDSIZE);
+    }
+}
+
+void HeaderFile::on_commit()
+{
+    if (!file || (keep == length && pending.empty()))
+        return;
+    length = keep;
+    write(pending.data(), pending.size() / RECORDSIZE);
+    pending.clear();
+}
+
+void HeaderFile::on_rollback()
+{
+    keep = length;
+    pending.clear();
+}
+
+void HeaderFile::write(const uint8_t* data, size_t nRecords)
+{
+    // no sync needed, the file is validated against the database on load
+    file->resize(length * RECORDSIZE);
+    file->write(length * RECORDSIZE, data, nRecords * RECORDSIZE);
+    length += nRecords;
+    keep = length;
+}
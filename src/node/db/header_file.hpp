@@ -0,0 +1,57 @@
+#pragma once
+#include "block/chain/offsts.hpp"
+#include "block/header/batch.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class WritableFile;
+
+// Flat file mirroring the consensus headers together with their history
+// and account cursors. It is read at startup instead of scanning the
+// database and is validated against the database tip before use.
+// Changes are buffered and written when the database transaction commits.
+class HeaderFile {
+public:
+    // header, history cursor, account cursor and a 4 byte checksum
+    static constexpr size_t RECORDSIZE = 80 + 8 + 8 + 4;
+    using Consensus = std::tuple<std::vector<Batch>, HistoryHeights, AccountHeights>;
+
+    // an empty path disables the file
+    HeaderFile(const std::string& dbPath);
+    HeaderFile(const HeaderFile&) = delete;
+    ~HeaderFile();
+
+    // returns nothing if the file is missing, truncated or corrupted
+    [[nodiscard]] std::optional<Consensus> load() const;
+    void rewrite(const Consensus&);
+
+    void append(HeaderView header, HistoryId historyCursor, AccountId accountCursor);
+    void shrink(Height newlength);
+    void on_commit();
+    void on_rollback();
+
+    // rolling back to a savepoint inside an open database transaction
+    struct Savepoint {
+        size_t keep;
+        std::vector<uint8_t> pending;
+    };
+    Savepoint savepoint() const { return { keep, pending }; }
+    void rollback_to(Savepoint&& sp)
+    {
+        keep = sp.keep;
+        pending = std::move(sp.pending);
+    }
+
+private:
+    void write(const uint8_t* data, size_t nRecords);
+
+private:
+    std::string path;
+    std::unique_ptr<WritableFile> file;
+    size_t length { 0 }; // committed records
+    size_t keep { 0 }; // committed records kept by the pending change
+    std::vector<uint8_t> pending;
+};
@@ -0,0 +1,114 @@
+#include "compact_blocks.hpp"
+#include "block/body/parse.hpp"
+#include "eventloop/types/peer_requests.hpp"
+#include "mempool/mempool.hpp"
+
+namespace {
+constexpr size_t SIGOFFSET = CompactBody::STUBSIZE;
+uint8_t* signature_pos(std::vector<uint8_t>& body, size_t transferOffset, size_t j)
+{
+    return body.data() + transferOffset + j * BodyView::TransferSize + SIGOFFSET;
+}
+}
+
+CompactBlocks::CompactBlocks(BlockrepCompactMsg&& m, const Blockrequest& req, const mempool::Mempool& mempool)
+    : nonce(m.nonce)
+    , range(req.range)
+    , merkleroots(req.merkleroots)
+{
+    if (m.blocks.size() != req.range.length() || m.blocks.size() != req.merkleroots.size())
+        throw Error(EINV_BLOCKREPSIZE);
+    for (size_t i = 0; i < m.blocks.size(); ++i) {
+        auto& cb { m.blocks[i] };
+        const NonzeroHeight height { req.range.lower + i };
+        const size_t n { cb.n_transfers() };
+        std::vector<uint8_t> bytes(std::move(cb.prefix));
+        const size_t offset { bytes.size() };
+        bytes.resize(offset + n * BodyView::TransferSize);
+        for (size_t j = 0; j < n; ++j)
+            memcpy(bytes.data() + offset + j * BodyView::TransferSize,
+                cb.stubs.data() + j * CompactBody::STUBSIZE, CompactBody::STUBSIZE);
+        BodyContainer body(std::move(bytes));
+
+        BodyView bv(body.view(height));
+        if (!bv.valid())
+            throw Error(EINV_BODY);
+        const PinFloor pinFloor { PrevHeight(height) };
+        const size_t missingBefore { missing.size() };
+        for (size_t j = 0; j < n; ++j) {
+            auto tv { bv.get_transfer(j) };
+            auto tx { mempool[tv.txid(tv.pinHeight(pinFloor))] };
+            if (!tx || tx->amount != tv.amount_throw()
+                || tx->compactFee != tv.compact_fee_trow()) {
+                missing.push_back({ uint32_t(i), uint32_t(j) });
+                continue;
+            }
+            tx->signature.serialize(signature_pos(body.data(), offset, j));
+        }
+
+        bodies.push_back(std::move(body));
+        transferOffsets.push_back(offset);
+        fromPeer.push_back(n > 0 && missing.size() - missingBefore == n);
+
+        // a mempool transfer with the same id but different content
+        // must not make the peer look like it sent an invalid block
+        if (missing.size() == missingBefore)
+            check_root(i, missing);
+    }
+}
+
+void CompactBlocks::check_root(size_t i, std::vector<Position>& out)
+{
+    if (fromPeer[i])
+        return;
+    const NonzeroHeight height { range.lower + i };
+    BodyView bv(bodies[i].view(height));
+    if (bv.merkle_root(height) == merkleroots[i])
+        return;
+    for (size_t j = 0; j < bv.getNTransfers(); ++j)
+        out.push_back({ uint32_t(i), uint32_t(j) });
+    fromPeer[i] = 1;
+}
+
+void CompactBlocks::fill(const BlocktxnrepMsg& m)
+{
+    if (m.nonce != nonce)
+        throw Error(EUNREQUESTED);
+    if (m.signatures.size() != missing.size())
+        throw Error(EINV_BLOCKREPSIZE);
+    for (size_t k = 0; k < missing.size(); ++k) {
+        auto [i, j] { missing[k] };
+        memcpy(signature_pos(bodies[i].data(), transferOffsets[i], j), m.signatures[k].data(), 65);
+    }
+
+    // mempool signatures in filled bodies might still be wrong
+    std::vector<Position> again;
+    for (size_t k = 0; k < missing.size(); ++k) {
+        if (size_t i { missing[k].first }; k == 0 || i != missing[k - 1].first)
+            check_root(i, again);
+    }
+    missing = std::move(again);
+}
+
+std::vector<BlocktxnrepMsg::Signature> signatures_at(
+    const std::vector<BodyContainer>& blocks, NonzeroHeight lower,
+    const std::vector<BlocktxnreqMsg::Position>& positions)
+{
+    std::vector<BlocktxnrepMsg::Signature> out;
+    std::vector<std::optional<BodyView>> views(blocks.size());
+    for (auto [i, j] : positions) {
+        if (i >= blocks.size())
+            return {};
+        auto& bv { views[i] };
+        if (!bv)
+            bv.emplace(blocks[i].view(lower + i));
+        if (!bv->valid())
+            return {};
+        if (j >= bv->getNTransfers())
+            return {};
+        auto sig { bv->get_transfer(j).signature() };
+        auto& s { out.emplace_back() };
+        memcpy(s.data(), sig.data(), 65);
+    }
+    return out;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "communication/messages.hpp"
+
+namespace mempool {
+class Mempool;
+}
+struct Blockrequest;
+
+// Rebuilds the bodies of a BlockrepCompactMsg from transfers in our
+// mempool. Signatures that cannot be found or bodies that do not match
+// the requested merkle root are requested from the peer. A body that
+// still does not match after filling gets all its signatures requested
+// once more, only then the peer is responsible for the merkle root.
+class CompactBlocks {
+public:
+    using Position = BlocktxnreqMsg::Position;
+    CompactBlocks(BlockrepCompactMsg&&, const Blockrequest&, const mempool::Mempool&);
+
+    [[nodiscard]] bool complete() const { return missing.empty(); }
+    [[nodiscard]] const std::vector<Position>& missing_signatures() const { return missing; }
+    void fill(const BlocktxnrepMsg&); // missing signatures might be requested again
+    [[nodiscard]] std::vector<BodyContainer> extract_bodies() { return std::move(bodies); }
+
+    uint32_t nonce;
+    DescriptedBlockRange range;
+
+private:
+    // requests all signatures of body i unless this was done before
+    void check_root(size_t i, std::vector<Position>& out);
+
+private:
+    std::vector<Hash> merkleroots;
+    std::vector<BodyContainer> bodies;
+    std::vector<size_t> transferOffsets; // per body
+    std::vector<uint8_t> fromPeer; // per body, all signatures requested
+    std::vector<Position> missing;
+};
+
+// signatures of the requested transfers, empty if a position is invalid
+[[nodiscard]] std::vector<BlocktxnrepMsg::Signature> signatures_at(
+    const std::vector<BodyContainer>&, NonzeroHeight lower,
+    const std::vector<BlocktxnreqMsg::Position>&);
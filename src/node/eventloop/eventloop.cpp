@@ -1,4 +1,5 @@
 #include "eventloop.hpp"
+#include "compact_blocks.hpp"
 #include "../asyncio/connection.hpp"
 #include "address_manager/address_manager_impl.hpp"
 #include "api/types/all.hpp"
@@ -15,16 +16,17 @@
 #include <algorithm>
 #include <future>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 using namespace std::chrono_literals;
-Eventloop::Eventloop(PeerServer& ps, ChainServer& cs, const Config& config)
+Eventloop::Eventloop(PeerServer& ps, ChainServer& cs, WorkerPool& verifierPool, const Config& config)
     : stateServer(cs)
     , chains(cs.get_chainstate())
-    , mempool(false)
+    , mempool(false, config.node.mempoolMaxSize)
     , connections(ps, config.peers.connect)
     // , signedSnapshot(chains.signed_snapshot())
-    , headerDownload(chains, consensus().total_work())
+    , headerDownload(chains, consensus().total_work(), verifierPool)
     , blockDownload(*this)
 {
     auto& ss = consensus().get_signed_snapshot();
@@ -226,7 +228,7 @@ void Eventloop::handle_event(StateUpdate&& e)
 
 void Eventloop::update_chain(Append&& m)
 {
-    const auto msg = chains.update_consensus(std::move(m));
+    const SharedSndbuffer msg { chains.update_consensus(std::move(m)) };
     log_chain_length();
     for (auto c : connections.all()) {
         try {
@@ -249,11 +251,12 @@ void Eventloop::update_chain(Fork&& fork)
 {
     const auto msg { chains.update_consensus(std::move(fork)) };
     log_chain_length();
+    const SharedSndbuffer buf { msg };
     for (auto c : connections.all()) {
         try {
             if (c.initialized())
                 c->chain.on_consensus_fork(msg.forkHeight, chains);
-            c.send(msg);
+            c.send(buf);
         } catch (ChainError e) {
             close(c, e);
         }
@@ -269,10 +272,11 @@ void Eventloop::update_chain(RollbackData&& rd)
     const auto msg { chains.update_consensus(rd) };
     if (msg) {
         log_chain_length();
+        const SharedSndbuffer buf { *msg };
         for (auto c : connections.all()) {
             if (c.initialized())
                 c->chain.on_consensus_shrink(chains);
-            c.send(*msg);
+            c.send(buf);
         }
     }
     headerDownload.on_signed_snapshot_update();
@@ -340,6 +344,7 @@ void Eventloop::handle_event(PeersCb&& cb)
             .theirSnapshotPriority = cr->theirSnapshotPriority,
             .acknowledgedSnapshotPriority = cr->acknowledgedSnapshotPriority,
             .since = cr->c->connected_since,
+            .sendStats = cr->c->send_stats(),
         });
     }
     cb(out);
@@ -376,6 +381,22 @@ void Eventloop::handle_event(OnForwardBlockrep&& m)
     }
 }
 
+void Eventloop::handle_event(OnForwardBlockrepCompact&& m)
+{
+    if (auto cr { connections.find(m.conId) }; cr) {
+        std::vector<CompactBody> blocks;
+        for (size_t i = 0; i < m.blocks.size(); ++i)
+            blocks.push_back({ m.blocks[i], m.lower + i });
+        cr.send(BlockrepCompactMsg(m.nonce, std::move(blocks)));
+    }
+}
+
+void Eventloop::handle_event(OnForwardBlocktxn&& m)
+{
+    if (auto cr { connections.find(m.conId) }; cr)
+        cr.send(BlocktxnrepMsg(m.nonce, signatures_at(m.blocks, m.lower, m.positions)));
+}
+
 void Eventloop::handle_event(OnFailedAddressEvent&& e)
 {
     if (connections.on_failed_outbound(e.a))
@@ -448,9 +469,14 @@ void Eventloop::handle_event(mempool::Log&& log)
         }
     finished:
 
-        // send subscription individually
-        for (auto& [end, cr] : bounds) {
-            cr.send(TxnotifyMsg::direct_send(entries.begin(), end));
+        // send subscription individually, subscribers with
+        // equal bounds share the serialized message
+        std::optional<SharedSndbuffer> buf;
+        for (size_t i = 0; i < bounds.size(); ++i) {
+            auto& [end, cr] { bounds[i] };
+            if (i == 0 || bounds[i - 1].first != end)
+                buf.emplace(TxnotifyMsg::direct_send(entries.begin(), end));
+            cr.send(*buf);
         }
     }
 }
@@ -550,7 +576,7 @@ void Eventloop::process_connection(std::shared_ptr<Connection> c)
     Conref cr { c->dataiter };
     for (auto& msg : messages) {
         try {
-            dispatch_message(cr, msg);
+            dispatch_message(cr, std::move(msg));
             // active
         } catch (Error e) {
             close(cr, e.e);
@@ -570,9 +596,26 @@ void Eventloop::send_ping_await_pong(Conref c)
     auto t = timer.insert(
         (config().localDebug ? 10min : 1min),
         Timer::CloseNoPong { c.id() });
-    PingMsg p(signed_snapshot() ? signed_snapshot()->priority : SignedSnapshot::Priority {});
+    const bool recon { c->c->peer_supports(Connection::FEATURE_TXRECON) };
+    // reconciling peers exchange mempool differences instead of samples
+    PingMsg p(signed_snapshot() ? signed_snapshot()->priority : SignedSnapshot::Priority {}, 5, recon ? 0 : 100);
     c.ping().await_pong(p, t);
     c.send(p);
+    if (recon)
+        send_reconreq(c);
+}
+
+void Eventloop::send_reconreq(Conref c)
+{
+    auto& r { c->txRecon };
+    if (r.pendingNonce) // previous round unanswered
+        r.on_failure();
+    mempool::TxSketch sketch(r.capacity);
+    ReconreqMsg msg(std::move(sketch));
+    for (auto& t : mempool.txids())
+        msg.sketch.insert(mempool::short_id(t, msg.salt()));
+    r.pendingNonce = msg.nonce;
+    c.send(msg);
 }
 
 void Eventloop::received_pong_sleep_ping(Conref c)
@@ -628,9 +671,15 @@ void Eventloop::send_request(Conref c, const T& req)
     auto t = timer.insert(req.expiry_time, Timer::Expire { c.id() });
     c.job().assign(t, timer, req);
     if (req.isActiveRequest) {
-        assert(activeRequests < maxRequests);
+        assert(activeRequests < max_requests());
         activeRequests += 1;
     }
+    if constexpr (std::is_same_v<T, Blockrequest>) {
+        if (req.prefer_compact() && c->c->peer_supports(Connection::FEATURE_COMPACTBLOCK)) {
+            c.send(BlockreqCompactMsg(req.nonce, req.range));
+            return;
+        }
+    }
     c.send(req);
 }
 
@@ -712,13 +761,9 @@ void Eventloop::handle_timeout(Timer::Connect&&)
     update_wakeup();
 }
 
-void Eventloop::dispatch_message(Conref cr, Rcvbuffer& msg)
+void Eventloop::dispatch_message(Conref cr, messages::Msg&& m)
 {
     using namespace messages;
-    if (msg.verify() == false)
-        throw Error(ECHECKSUM);
-
-    auto m = msg.parse();
     // first message must be of type INIT (is_init() is only initially true)
     if (cr.job().awaiting_init()) {
         if (!std::holds_alternative<InitMsg>(m)) {
@@ -829,6 +874,10 @@ void Eventloop::handle_msg(Conref cr, BatchreqMsg&& m)
         }
     }();
 
+    if (cr->c->peer_supports(Connection::FEATURE_COMPACTBATCH)) {
+        cr.send(BatchrepCompactMsg(m.nonce, std::move(batch)));
+        return;
+    }
     BatchrepMsg rep(m.nonce, std::move(batch));
     rep.nonce = m.nonce;
     cr.send(rep);
@@ -858,6 +907,11 @@ void Eventloop::handle_msg(Conref cr, BatchrepMsg&& m)
     do_requests();
 }
 
+void Eventloop::handle_msg(Conref cr, BatchrepCompactMsg&& m)
+{
+    handle_msg(cr, BatchrepMsg(m.nonce, std::move(m.batch)));
+}
+
 void Eventloop::handle_msg(Conref cr, ProbereqMsg&& m)
 {
     if (config().node.logCommunication)
@@ -917,6 +971,64 @@ void Eventloop::handle_msg(Conref cr, BlockrepMsg&& m)
     do_requests();
 }
 
+void Eventloop::handle_msg(Conref cr, BlockreqCompactMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle_blockreq_compact [{},{}]", cr.str(), m.range.lower.value(), m.range.upper.value());
+    stateServer.async_get_blocks(m.range,
+        [this, conId = cr.id(), nonce = m.nonce, lower = m.range.lower](std::vector<BodyContainer>&& blocks) {
+            defer(OnForwardBlockrepCompact { conId, nonce, lower, std::move(blocks) });
+        });
+}
+
+void Eventloop::handle_msg(Conref cr, BlockrepCompactMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle blockrep_compact", cr.str());
+    // the request is answered already, only its missing signatures are due
+    if (cr->compactBlocks)
+        throw Error(EUNREQUESTED);
+    if (m.blocks.empty()) {
+        handle_msg(cr, BlockrepMsg(m.nonce, {}));
+        return;
+    }
+    auto& req { cr.job().peek_req(m) };
+    CompactBlocks cb(std::move(m), req, mempool);
+    if (cb.complete()) {
+        handle_msg(cr, BlockrepMsg(cb.nonce, cb.extract_bodies()));
+        return;
+    }
+    cr.send(BlocktxnreqMsg(cb.nonce, req.range, cb.missing_signatures()));
+    cr->compactBlocks = std::move(cb);
+}
+
+void Eventloop::handle_msg(Conref cr, BlocktxnreqMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle blocktxnreq ({} signatures)", cr.str(), m.missing.size());
+    stateServer.async_get_blocks(m.range,
+        [this, conId = cr.id(), nonce = m.nonce, lower = m.range.lower, positions = std::move(m.missing)](std::vector<BodyContainer>&& blocks) mutable {
+            defer(OnForwardBlocktxn { conId, nonce, lower, std::move(positions), std::move(blocks) });
+        });
+}
+
+void Eventloop::handle_msg(Conref cr, BlocktxnrepMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle blocktxnrep", cr.str());
+    auto& cb { cr->compactBlocks };
+    if (!cb)
+        throw Error(EUNREQUESTED);
+    cb->fill(m);
+    if (!cb->complete()) {
+        cr.send(BlocktxnreqMsg(cb->nonce, cb->range, cb->missing_signatures()));
+        return;
+    }
+    BlockrepMsg rep(cb->nonce, cb->extract_bodies());
+    cb.reset();
+    handle_msg(cr, std::move(rep));
+}
+
 void Eventloop::handle_msg(Conref cr, TxnotifyMsg&& m)
 {
     if (config().node.logCommunication)
@@ -952,6 +1064,63 @@ void Eventloop::handle_msg(Conref cr, TxrepMsg&& m)
     do_requests();
 }
 
+void Eventloop::handle_msg(Conref cr, ReconreqMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle ReconreqMsg", cr.str());
+    cr->ratelimit.recon();
+    std::map<uint64_t, TxidWithFee> ours;
+    mempool::TxSketch sketch(m.sketch.size());
+    for (auto& t : mempool.txids()) {
+        auto id { mempool::short_id(t, m.salt()) };
+        ours.emplace(id, t);
+        sketch.insert(id);
+    }
+    m.sketch.subtract(sketch);
+    auto diff { m.sketch.decode() };
+    if (!diff || diff->ours.size() > ReconrepMsg::MAXENTRIES || diff->theirs.size() > ReconrepMsg::MAXENTRIES) {
+        cr.send(ReconrepMsg(m.nonce, false));
+        return;
+    }
+    std::vector<TxidWithFee> missing;
+    for (auto id : diff->theirs) {
+        if (auto iter { ours.find(id) }; iter != ours.end())
+            missing.push_back(iter->second);
+    }
+    cr.send(ReconrepMsg(m.nonce, true, std::move(missing), std::move(diff->ours)));
+}
+
+void Eventloop::handle_msg(Conref cr, ReconrepMsg&& m)
+{
+    if (config().node.logCommunication)
+        spdlog::info("{} handle ReconrepMsg", cr.str());
+    auto& r { cr->txRecon };
+    if (r.pendingNonce != m.nonce)
+        throw Error(EUNREQUESTED);
+    r.pendingNonce.reset();
+    if (!m.decoded) {
+        r.on_failure();
+        return;
+    }
+    r.on_decoded(m.missing.size() + m.wanted.size());
+
+    auto txids { mempool.filter_new(m.missing) };
+    if (txids.size() > 0)
+        cr.send(TxreqMsg(txids));
+
+    if (m.wanted.size() > 0) {
+        std::set<uint64_t> wanted(m.wanted.begin(), m.wanted.end());
+        std::vector<std::optional<TransferTxExchangeMessage>> out;
+        for (auto& t : mempool.txids()) {
+            if (wanted.contains(mempool::short_id(t, m.nonce)))
+                out.push_back(mempool[t.txid]);
+        }
+        if (out.size() > 0)
+            cr.send(TxrepMsg(out));
+    }
+    do_requests();
+}
+
 void Eventloop::handle_msg(Conref cr, LeaderMsg&& msg)
 {
     if (config().node.logCommunication)
@@ -25,7 +25,6 @@
 #include <algorithm>
 
 class Connection;
-class Rcvbuffer;
 class Reader;
 class Eventprocessor;
 class EndAttorney;
@@ -47,7 +46,7 @@ class Eventloop {
 
 public:
     friend struct Inspector;
-    Eventloop(PeerServer&, ChainServer& ss, const Config& config);
+    Eventloop(PeerServer&, ChainServer& ss, WorkerPool& verifierPool, const Config& config);
     ~Eventloop();
 
     // API callbacks
@@ -102,15 +101,20 @@ private:
 
     ////////////////////////
     // Handling incoming messages
-    void dispatch_message(Conref cr, Rcvbuffer& rb);
+    void dispatch_message(Conref cr, messages::Msg&& m);
     void handle_msg(Conref cr, PingMsg&&);
     void handle_msg(Conref cr, PongMsg&&);
     void handle_msg(Conref cr, BatchreqMsg&&);
     void handle_msg(Conref cr, BatchrepMsg&&);
+    void handle_msg(Conref cr, BatchrepCompactMsg&&);
     void handle_msg(Conref cr, ProbereqMsg&&);
     void handle_msg(Conref cr, ProberepMsg&&);
     void handle_msg(Conref cr, BlockreqMsg&&);
     void handle_msg(Conref cr, BlockrepMsg&&);
+    void handle_msg(Conref cr, BlockreqCompactMsg&&);
+    void handle_msg(Conref cr, BlockrepCompactMsg&&);
+    void handle_msg(Conref cr, BlocktxnreqMsg&&);
+    void handle_msg(Conref cr, BlocktxnrepMsg&&);
     void handle_msg(Conref cr, InitMsg&&);
     void handle_msg(Conref cr, AppendMsg&&);
     void handle_msg(Conref cr, SignedPinRollbackMsg&&);
@@ -119,6 +123,8 @@ private:
     void handle_msg(Conref cr, TxreqMsg&&);
     void handle_msg(Conref cr, TxrepMsg&&);
     void handle_msg(Conref cr, LeaderMsg&&);
+    void handle_msg(Conref cr, ReconreqMsg&&);
+    void handle_msg(Conref cr, ReconrepMsg&&);
 
     ////////////////////////
     // convenience functions
@@ -148,6 +154,7 @@ private:
     // Timer functions
     void cancel_timer(Timer::iterator& ref);
     void send_ping_await_pong(Conref cr);
+    void send_reconreq(Conref cr);
     void received_pong_sleep_ping(Conref cr);
     void update_wakeup();
 
@@ -186,6 +193,19 @@ private:
         uint64_t conId;
         std::vector<BodyContainer> blocks;
     };
+    struct OnForwardBlockrepCompact {
+        uint64_t conId;
+        uint32_t nonce;
+        NonzeroHeight lower;
+        std::vector<BodyContainer> blocks;
+    };
+    struct OnForwardBlocktxn {
+        uint64_t conId;
+        uint32_t nonce;
+        NonzeroHeight lower;
+        std::vector<BlocktxnreqMsg::Position> positions;
+        std::vector<BodyContainer> blocks;
+    };
     struct OnFailedAddressEvent {
         EndpointAddress a;
     };
@@ -208,7 +228,7 @@ private:
     // event queue
     using Event = std::variant<OnRelease, OnProcessConnection,
         StateUpdate, SignedSnapshotCb, PeersCb, SyncedCb, stage_operation::Result,
-        OnForwardBlockrep, OnFailedAddressEvent, InspectorCb, GetHashrate, GetHashrateChart,
+        OnForwardBlockrep, OnForwardBlockrepCompact, OnForwardBlocktxn, OnFailedAddressEvent, InspectorCb, GetHashrate, GetHashrateChart,
         OnPinAddress, OnUnpinAddress, mempool::Log>;
 
 public:
@@ -224,6 +244,8 @@ private:
     void handle_event(SignedSnapshotCb&&);
     void handle_event(stage_operation::Result&&);
     void handle_event(OnForwardBlockrep&&);
+    void handle_event(OnForwardBlockrepCompact&&);
+    void handle_event(OnForwardBlocktxn&&);
     void handle_event(OnFailedAddressEvent&&);
     void handle_event(InspectorCb&&);
     void handle_event(GetHashrate&&);
@@ -273,7 +295,8 @@ private: // private data
 
     // Request related
     size_t activeRequests = 0;
-    size_t maxRequests = 10;
+    size_t maxRequests = 10; // lower bound, every peer may have one request
+    size_t max_requests() const { return std::max(maxRequests, connections.size()); }
 
     //
     auto signed_snapshot() const { return chains.signed_snapshot(); };
@@ -302,5 +325,5 @@ void RequestSender::send(Conref cr, const T& req)
 }
 inline bool RequestSender::finished()
 {
-    return e.maxRequests <= e.activeRequests;
+    return e.max_requests() <= e.activeRequests;
 }
@@ -23,9 +23,10 @@ auto Downloader::connections()
     return attorney.connections();
 }
 
-Downloader::Downloader(Attorney attorney, size_t windowLength)
+Downloader::Downloader(Attorney attorney, size_t minWindowLength)
     : attorney(attorney)
-    , focus(*this, windowLength)
+    , minWindowLength(minWindowLength)
+    , focus(*this, minWindowLength)
 {
 }
 
@@ -254,33 +255,51 @@ void Downloader::do_block_requests(RequestSender s) // OK?
     assert(reachable_length() <= headers().length());
     assert(!stageState.pendingOperation.is_stage_set());
 
-    BlockSlot downloadSlot(focus.height_begin());
-    Height minHeight { std::min(downloadSlot.upper_height(), headers().length()) };
-    auto forkIter = forks.lower_bound((minHeight + 1).nonzero_assert());
-    if (forkIter == forks.end())
-        return;
+    // keep about two block batches in flight per peer
+    focus.set_width(std::clamp(2 * forks.size(), minWindowLength, MAXWINDOWLENGTH));
+
+    const auto now { std::chrono::steady_clock::now() };
+    bool first { true };
     for (auto n : focus) {
-        if (!n.has_value() || n->iter->second.activeRequest())
+        bool head { std::exchange(first, false) };
+        if (!n.has_value())
             continue;
+        auto& node { n->iter->second };
+        if (node.activeRequest()) {
+            // the window waits for the head batch, request it
+            // again from another peer if its download is stuck
+            if (!head || node.refs.size() > 1 || !data(node.conref()).stats.overdue(now))
+                continue;
+        }
 
-        // found request
-        auto& range { n->r };
-        if (forkIter->first <= range.upper)
-            forkIter = forks.lower_bound(range.upper + 1);
-        while (true) {
-            if (forkIter == forks.end())
-                return;
-            if (!forkIter->second.job()) {
-                Conref& cr = forkIter->second;
-                auto req { n->link_request(cr) };
-                s.send(cr, req);
-                if (s.finished())
-                    return;
-                break;
-            }
-            ++forkIter;
+        // found request, higher batches cannot be served if no idle peer has this one
+        auto cr { fastest_idle(n->r.upper) };
+        if (!cr)
+            return;
+        auto& stats { data(*cr).stats };
+        auto req { n->link_request(*cr, stats.request_length()) };
+        stats.on_request(req.range.length());
+        s.send(*cr, req);
+        if (s.finished())
+            return;
+    }
+}
+
+std::optional<Conref> Downloader::fastest_idle(Height upper)
+{
+    std::optional<Conref> best;
+    double bestScore { -1 };
+    for (auto iter { forks.lower_bound((upper + 1).nonzero_assert()) }; iter != forks.end(); ++iter) {
+        auto& cr { iter->second };
+        if (cr.job())
+            continue;
+        auto score { data(cr).stats.score() };
+        if (score > bestScore) {
+            best = cr;
+            bestScore = score;
         }
     }
+    return best;
 }
 
 std::optional<stage_operation::Operation> Downloader::pop_stage()
@@ -320,6 +339,11 @@ void Downloader::on_blockreq_reply(Conref cr, BlockrepMsg&& rep, Blockrequest& r
     if (rep.blocks.size() != req.range.length())
         throw Error(EINV_BLOCKREPSIZE);
 
+    size_t bytes { 0 };
+    for (auto& b : rep.blocks)
+        bytes += b.size();
+    data(cr).stats.on_reply(rep.blocks.size(), bytes);
+
     // discard old replies
     if (req.range.upper < focus.height_begin())
         return;
@@ -375,6 +399,7 @@ bool Downloader::erase(Conref cr)
 
 void Downloader::on_blockreq_expire(Conref cr)
 { // OK
+    data(cr).stats.on_expire();
     focus.erase(cr);
 }
 
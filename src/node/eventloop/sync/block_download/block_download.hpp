@@ -16,6 +16,7 @@
 namespace HeaderDownload {
 class LeaderInfo;
 }
+struct Inspector;
 
 namespace BlockDownload {
 enum class ServerCall {
@@ -26,9 +27,10 @@ enum class ServerCall {
 
 class Downloader {
     friend struct Focus;
+    friend struct ::Inspector;
 
 public:
-    Downloader(Attorney, size_t windowLength = 10);
+    Downloader(Attorney, size_t minWindowLength = 10);
 
     //////////////////////////////
     // Control functions
@@ -77,6 +79,7 @@ private:
     bool can_do_requests();
 
     void check_upgrade_descripted(Conref cr);
+    std::optional<Conref> fastest_idle(Height upper); // among peers having blocks up to upper
     std::optional<Height> reachable_length();
 
 private:
@@ -89,6 +92,8 @@ private:
     Forks forks;
 
     // download focus related
+    static constexpr size_t MAXWINDOWLENGTH = 40; // in block batches
+    const size_t minWindowLength;
     Focus focus;
 
     // state helper variables
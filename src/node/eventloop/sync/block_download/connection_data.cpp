@@ -3,6 +3,9 @@
 #include "eventloop/types/conref_declaration.hpp"
 #include "eventloop/types/conref_impl.hpp"
 #include "focus.hpp"
+#include "general/params.hpp"
+#include <algorithm>
+#include <limits>
 class Focus;
 namespace BlockDownload {
 
@@ -31,4 +34,65 @@ void ConnectionData::ForkData::ForkData::udpate_iter_range(ForkIter iter, ForkRa
     assert(iterRange._range.lower() <= _descripted->chain_length() + 1);
 }
 
+namespace {
+constexpr double ALPHA = 0.25; // weight of new samples
+void smooth(double& avg, double sample, bool first)
+{
+    avg = first ? sample : avg + ALPHA * (sample - avg);
+}
+}
+
+void PeerStats::on_request(uint32_t nBlocks)
+{
+    pendingSince = sc::now();
+    pendingBlocks = nBlocks;
+}
+
+void PeerStats::on_reply(uint32_t nBlocks, size_t bytes)
+{
+    if (!pendingSince)
+        return;
+    using namespace std::chrono;
+    auto seconds { std::max(duration<double>(sc::now() - *pendingSince).count(), 0.001) };
+    pendingSince.reset();
+    bool first { replies == 0 };
+    smooth(latencyMillis, seconds * 1000, first);
+    smooth(blocksPerSecond, nBlocks / seconds, first);
+    smooth(bytesPerSecond, bytes / seconds, first);
+    replies += 1;
+    blocksReceived += nBlocks;
+}
+
+void PeerStats::on_expire()
+{
+    pendingSince.reset();
+    expired += 1;
+    blocksPerSecond /= 2;
+}
+
+uint32_t PeerStats::request_length() const
+{
+    if (!measured())
+        return BLOCKBATCHSIZE;
+    auto n { blocksPerSecond * std::chrono::duration<double>(TARGETDURATION).count() };
+    return uint32_t(std::clamp(n, double(MINREQUEST), double(BLOCKBATCHSIZE)));
+}
+
+bool PeerStats::overdue(sc::time_point now) const
+{
+    if (!pendingSince)
+        return false;
+    using namespace std::chrono;
+    duration<double> expected { 3 * TARGETDURATION };
+    if (blocksPerSecond > 0)
+        expected = std::max(duration<double>(2 * pendingBlocks / blocksPerSecond), duration<double>(TARGETDURATION));
+    return now > *pendingSince + duration_cast<sc::duration>(expected);
+}
+
+double PeerStats::score() const
+{
+    if (!measured())
+        return std::numeric_limits<double>::max();
+    return blocksPerSecond;
+}
 }
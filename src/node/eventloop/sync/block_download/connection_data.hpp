@@ -1,7 +1,9 @@
 #pragma once
 #include "block/chain/fork_range.hpp"
 #include "block/chain/height.hpp"
+#include <chrono>
 #include <map>
+#include <optional>
 class Conref;
 namespace BlockDownload {
 using Forkmap = std::multimap<NonzeroHeight, Conref>;
@@ -12,6 +14,44 @@ using FocusMap = std::map<BlockSlot, FocusNode>; // indexed by batch index
 class Downloader;
 class Forks;
 class Focus;
+
+// Block download performance of a peer. Requests are sized such that
+// they complete within TARGETDURATION and the blocks the focus window
+// waits for are requested from the fastest peers.
+class PeerStats {
+public:
+    using sc = std::chrono::steady_clock;
+    static constexpr uint32_t MINREQUEST = 3;
+    static constexpr auto TARGETDURATION = std::chrono::seconds(4);
+
+    void on_request(uint32_t nBlocks);
+    void on_reply(uint32_t nBlocks, size_t bytes);
+    void on_expire();
+
+    [[nodiscard]] uint32_t request_length() const;
+    [[nodiscard]] bool overdue(sc::time_point now) const; // pending request should be duplicated
+    [[nodiscard]] double score() const; // expected blocks per second, unmeasured peers first
+
+    bool measured() const { return replies > 0 || expired > 0; }
+    double latency_millis() const { return latencyMillis; }
+    double blocks_per_second() const { return blocksPerSecond; }
+    double bytes_per_second() const { return bytesPerSecond; }
+    size_t replies_count() const { return replies; }
+    size_t expired_count() const { return expired; }
+    size_t blocks_received() const { return blocksReceived; }
+    size_t pending_blocks() const { return pendingSince ? pendingBlocks : 0; }
+
+private:
+    std::optional<sc::time_point> pendingSince;
+    uint32_t pendingBlocks { 0 };
+    double latencyMillis { 0 };
+    double blocksPerSecond { 0 };
+    double bytesPerSecond { 0 };
+    size_t replies { 0 };
+    size_t expired { 0 };
+    size_t blocksReceived { 0 };
+};
+
 class ConnectionData {
     friend class Forks;
 
@@ -34,6 +74,7 @@ private:
 
 public:
     FocusMap::iterator focusIter;
+    PeerStats stats;
 
 public:
     ConnectionData(FocusMap::iterator focusEnd)
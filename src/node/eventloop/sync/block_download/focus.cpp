@@ -1,8 +1,13 @@
 #include "focus.hpp"
 #include "block_download.hpp"
+#include "general/now.hpp"
 #include "spdlog/spdlog.h"
 
 namespace BlockDownload {
+namespace {
+// blocks younger than this are requested in compact form
+constexpr uint32_t COMPACTBLOCKAGE = 60 * 60;
+}
 struct __attribute__((visibility("hidden"))) Node {
 private:
 public:
@@ -39,9 +44,11 @@ const Headerchain& Focus::headers()
     return downloader.headers();
 }
 
-Blockrequest Focus::FocusSlot::link_request(Conref cr)
+Blockrequest Focus::FocusSlot::link_request(Conref cr, uint32_t maxLength)
 {
     assert(data(cr).focusIter == focus.map.end());
+    assert(maxLength > 0);
+    BlockRange r { this->r.lower, NonzeroHeight(std::min(this->r.upper.value(), this->r.lower.value() + maxLength - 1)) };
 
     // establish link
     data(cr).focusIter = iter;
@@ -50,7 +57,13 @@ Blockrequest Focus::FocusSlot::link_request(Conref cr)
 
     // craft block request
     auto& descripted = data(cr).descripted();
-    return Blockrequest(descripted, r, focus.headers().hash_at(r.upper));
+    auto& headers { focus.headers() };
+    std::vector<Hash> merkleroots;
+    if (headers[r.upper].timestamp() + COMPACTBLOCKAGE > now_timestamp()) {
+        for (auto h { r.lower }; h <= r.upper; ++h)
+            merkleroots.push_back(headers[h].merkleroot());
+    }
+    return Blockrequest(descripted, r, headers.hash_at(r.upper), std::move(merkleroots));
 }
 
 bool Focus::has_data()
@@ -78,12 +78,14 @@ struct Focus {
     void erase(Conref cr);
     void set_offset(Height);
     void set_blocks(BlockSlot, Height reqBegin, std::vector<BodyContainer>&& blocks);
+    void set_width(size_t w) { width = w; }
+    size_t get_width() const { return width; }
 
     struct FocusSlot {
         FocusMap::iterator iter;
         BlockRange r;
         Focus& focus;
-        Blockrequest link_request(Conref cr);
+        Blockrequest link_request(Conref cr, uint32_t maxLength = BLOCKBATCHSIZE);
     };
     struct EndIterator {
     };
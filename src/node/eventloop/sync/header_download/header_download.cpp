@@ -477,7 +477,7 @@ void Downloader::process_final(Lead_iter li, std::vector<Offender>& out)
         }()
     };
 
-    auto o { parent.copy_apply(chains.signed_snapshot(), hrange.sub_range(parent.height() + 1)) };
+    auto o { parent.copy_apply(chains.signed_snapshot(), hrange.sub_range(parent.height() + 1), powPool) };
     if (!o.has_value()) {
         out.push_back({ o.error(), li->cr });
         return;
@@ -508,7 +508,7 @@ bool Downloader::advance_verifier(const Ver_iter* vi, const Lead_set& leaders, c
 
     auto a {
         (vi ? (*vi)->second.verifier : HeaderVerifier {})
-            .copy_apply(chains.signed_snapshot(), HeaderRange((vi ? (*vi)->second.sb.next_slot() : Batchslot(0)), b))
+            .copy_apply(chains.signed_snapshot(), HeaderRange((vi ? (*vi)->second.sb.next_slot() : Batchslot(0)), b), powPool)
     };
     if (!a.has_value()) {
         for (const Lead_iter& li : leaders) {
@@ -722,6 +722,13 @@ void Downloader::insert(Conref cr)
     consider_insert_leader(cr);
 }
 
+Downloader::Downloader(const StageAndConsensus& cache, Worksum minWork, WorkerPool& powPool)
+    : chains(cache)
+    , minWork(minWork)
+    , powPool(powPool)
+{
+}
+
 void Downloader::set_min_worksum(const Worksum& ws)
 {
     if (minWork != ws) {
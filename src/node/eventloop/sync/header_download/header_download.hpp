@@ -4,6 +4,7 @@
 #include "block/chain/offender.hpp"
 #include "eventloop/types/conndata.hpp"
 #include "eventloop/types/peer_requests.hpp"
+#include "general/worker_pool.hpp"
 #include <deque>
 #include <set>
 
@@ -225,11 +226,7 @@ public:
         return leaderList.size() > 0;
     }
     size_t size() const { return connections.size(); }
-    Downloader(const StageAndConsensus& cache, Worksum minWork)
-        : chains(cache)
-        , minWork(minWork)
-    {
-    }
+    Downloader(const StageAndConsensus& cache, Worksum minWork, WorkerPool& powPool);
     void set_min_worksum(const Worksum& ws);
 
     // peer message callbacks
@@ -298,5 +295,6 @@ private: // data
     std::vector<Conref> connectionsWithProbeJob;
     const StageAndConsensus& chains;
     Worksum minWork;
+    WorkerPool& powPool; // proof of work checks of header batches, shared with the chain server
 };
 }
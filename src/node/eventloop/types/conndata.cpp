@@ -24,6 +24,13 @@ void Conref::send(Sndbuffer b)
     }
 };
 
+void Conref::send(const SharedSndbuffer& b)
+{
+    if (!(*this)->c->eventloop_erased) {
+        data.iter->second.c->asyncsend(b);
+    }
+}
+
 Usage::Usage(HeaderDownload::Downloader& h, BlockDownload::Downloader& b)
     : data_headerdownload(h)
     , data_blockdownload(b.focus_end()) {};
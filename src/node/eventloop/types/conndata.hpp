@@ -1,5 +1,6 @@
 #pragma once
 
+#include "eventloop/compact_blocks.hpp"
 #include "eventloop/peer_chain.hpp"
 #include "eventloop/sync/block_download/connection_data.hpp"
 #include "eventloop/sync/header_download/connection_data.hpp"
@@ -119,6 +120,19 @@ struct ConnectionJob : public Timerref {
         reset_notexpired<type>(t);
         return out;
     }
+    // like pop_req but keeps the request pending
+    template <typename T>
+    requires std::derived_from<T, WithNonce>
+    auto& peek_req(const T& rep) const
+    {
+        using type = typename typemap<T>::type;
+        if (!std::holds_alternative<type>(data_v))
+            throw Error(EUNREQUESTED);
+        auto& out = std::get<type>(data_v);
+        if (rep.nonce != out.nonce)
+            throw Error(EUNREQUESTED);
+        return out;
+    }
     void unref_active_requests(size_t& activeRequests)
     {
         assert(!data_v.valueless_by_exception());
@@ -150,6 +164,10 @@ private:
     struct typemap<T> {
         using type = Blockrequest;
     };
+    template <std::same_as<BlockrepCompactMsg> T>
+    struct typemap<T> {
+        using type = Blockrequest;
+    };
 };
 
 struct Ping : public Timerref {
@@ -187,10 +205,23 @@ private:
     std::optional<PingMsg> data;
 };
 
+// mempool set reconciliation state, the sketch capacity adapts to the
+// size of the differences seen so far
+struct TxReconciliation {
+    std::optional<uint32_t> pendingNonce;
+    size_t capacity { mempool::TxSketch::MINCELLS };
+    void on_decoded(size_t differences)
+    {
+        capacity = std::max(mempool::TxSketch::MINCELLS, 2 * differences + differences / 2);
+    }
+    void on_failure() { capacity = std::min(2 * capacity, mempool::TxSketch::MAXCELLS); }
+};
+
 struct Ratelimit {
     using sc = std::chrono::steady_clock;
     void update() { valid_rate(lastUpdate, std::chrono::minutes(2)); }
     void ping() { return valid_rate(lastUpdate, std::chrono::seconds(5)); }
+    void recon() { return valid_rate(lastRecon, std::chrono::seconds(5)); }
 
 private:
     void valid_rate(sc::time_point& last, auto duration)
@@ -203,6 +234,7 @@ private:
     }
     sc::time_point lastUpdate = sc::time_point::min();
     sc::time_point lastPing = sc::time_point::min();
+    sc::time_point lastRecon = sc::time_point::min();
 };
 
 struct Usage {
@@ -225,6 +257,8 @@ struct PeerState {
     SignedSnapshot::Priority acknowledgedSnapshotPriority;
     SignedSnapshot::Priority theirSnapshotPriority;
     uint32_t lastNonce;
+    std::optional<CompactBlocks> compactBlocks; // awaiting missing signatures
+    TxReconciliation txRecon;
     bool verifiedEndpoint = false;
     Ping ping;
     Usage usage;
@@ -36,14 +36,19 @@ struct AwaitInit {
 struct Blockrequest : public BlockreqMsg, public IsRequest {
     Blockrequest(std::shared_ptr<Descripted> pdescripted,
         BlockRange range,
-        Hash upperHash)
+        Hash upperHash,
+        std::vector<Hash> merkleroots = {})
         : BlockreqMsg(DescriptedBlockRange { pdescripted->descriptor, range.lower, range.upper })
         , descripted(std::move(pdescripted))
         , upperHash(std::move(upperHash))
+        , merkleroots(std::move(merkleroots))
     {
     }
+    // recent blocks are likely to consist of transfers in our mempool
+    bool prefer_compact() const { return !merkleroots.empty(); }
     std::shared_ptr<Descripted> descripted;
     Hash upperHash;
+    std::vector<Hash> merkleroots; // only set if compact relay is preferred
 };
 
 struct Batchrequest : public BatchreqMsg, public IsRequest {
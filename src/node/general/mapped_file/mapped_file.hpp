@@ -0,0 +1,5 @@
+#if defined(_WIN32)
+# include "mapped_file_windows.hpp"
+#else
+# include "mapped_file_unix.hpp"
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. The file descriptor
+// is closed after mapping, the mapping stays valid until destruction.
+class MappedFile {
+public:
+    MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file \"" + path + "\": " + strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat file \"" + path + "\": " + strerror(errno));
+        }
+        len = st.st_size;
+        if (len > 0) {
+            void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map file \"" + path + "\": " + strerror(errno));
+            }
+            ptr = static_cast<const uint8_t*>(p);
+        }
+        close(fd);
+    };
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile()
+    {
+        if (ptr != nullptr)
+            munmap(const_cast<uint8_t*>(ptr), len);
+    };
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const uint8_t* ptr = nullptr;
+    size_t len = 0;
+};
+
+// File with positioned writes and explicit flush to disk.
+class WritableFile {
+public:
+    WritableFile(const std::string& path)
+        : path(path)
+    {
+        fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file \"" + path + "\": " + strerror(errno));
+        }
+    };
+    WritableFile(const WritableFile&) = delete;
+    ~WritableFile()
+    {
+        if (fd >= 0)
+            close(fd);
+    };
+    void resize(size_t size)
+    {
+        if (ftruncate(fd, size) < 0)
+            throw std::runtime_error("Cannot resize file \"" + path + "\": " + strerror(errno));
+    }
+    void write(size_t offset, const uint8_t* data, size_t len)
+    {
+        while (len > 0) {
+            auto n = pwrite(fd, data, len, offset);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("Cannot write file \"" + path + "\": " + strerror(errno));
+            }
+            data += n;
+            offset += n;
+            len -= n;
+        }
+    }
+    void sync()
+    {
+#ifdef __APPLE__
+        int r = fsync(fd);
+#else
+        int r = fdatasync(fd);
+#endif
+        if (r < 0)
+            throw std::runtime_error("Cannot sync file \"" + path + "\": " + strerror(errno));
+    }
+
+private:
+    std::string path;
+    int fd = -1;
+};
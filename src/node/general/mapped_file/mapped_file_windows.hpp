@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <windows.h>
+
+// Read-only memory mapping of a whole file. The file handle
+// is closed after mapping, the mapping stays valid until destruction.
+class MappedFile {
+public:
+    MappedFile(const std::string& path)
+    {
+        HANDLE f = CreateFileA(path.c_str(), GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (f == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open file \"" + path + "\": error " + std::to_string(GetLastError()));
+        LARGE_INTEGER s;
+        if (!GetFileSizeEx(f, &s)) {
+            CloseHandle(f);
+            throw std::runtime_error("Cannot get size of file \"" + path + "\": error " + std::to_string(GetLastError()));
+        }
+        len = s.QuadPart;
+        if (len > 0) {
+            HANDLE m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (m != NULL) {
+                ptr = static_cast<const uint8_t*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(m);
+            }
+            if (ptr == nullptr) {
+                CloseHandle(f);
+                throw std::runtime_error("Cannot map file \"" + path + "\": error " + std::to_string(GetLastError()));
+            }
+        }
+        CloseHandle(f);
+    };
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile()
+    {
+        if (ptr != nullptr)
+            UnmapViewOfFile(ptr);
+    };
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const uint8_t* ptr = nullptr;
+    size_t len = 0;
+};
+
+// File with positioned writes and explicit flush to disk.
+class WritableFile {
+public:
+    WritableFile(const std::string& path)
+        : path(path)
+    {
+        h = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (h == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Cannot open file \"" + path + "\": error " + std::to_string(GetLastError()));
+    };
+    WritableFile(const WritableFile&) = delete;
+    ~WritableFile()
+    {
+        if (h != INVALID_HANDLE_VALUE)
+            CloseHandle(h);
+    };
+    void resize(size_t size)
+    {
+        LARGE_INTEGER s;
+        s.QuadPart = size;
+        if (!SetFilePointerEx(h, s, NULL, FILE_BEGIN) || !SetEndOfFile(h))
+            throw std::runtime_error("Cannot resize file \"" + path + "\": error " + std::to_string(GetLastError()));
+    }
+    void write(size_t offset, const uint8_t* data, size_t len)
+    {
+        while (len > 0) {
+            OVERLAPPED o {};
+            o.Offset = DWORD(offset);
+            o.OffsetHigh = DWORD(uint64_t(offset) >> 32);
+            DWORD n;
+            if (!WriteFile(h, data, DWORD(len), &n, &o))
+                throw std::runtime_error("Cannot write file \"" + path + "\": error " + std::to_string(GetLastError()));
+            data += n;
+            offset += n;
+            len -= n;
+        }
+    }
+    void sync()
+    {
+        if (!FlushFileBuffers(h))
+            throw std::runtime_error("Cannot sync file \"" + path + "\": error " + std::to_string(GetLastError()));
+    }
+
+private:
+    std::string path;
+    HANDLE h = INVALID_HANDLE_VALUE;
+};
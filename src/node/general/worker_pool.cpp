@@ -0,0 +1,90 @@
+#include "worker_pool.hpp"
+
+void WorkerPool::Job::work(WorkerPool& pool)
+{
+    size_t count { 0 };
+    for (size_t i; (i = next.fetch_add(1)) < n; ++count) {
+        try {
+            f(i);
+        } catch (...) {
+            std::unique_lock l(pool.mutex);
+            if (!exception)
+                exception = std::current_exception();
+        }
+    }
+    std::unique_lock l(pool.mutex);
+    if (!pool.jobs.empty() && pool.jobs.front().get() == this)
+        pool.jobs.pop(); // all indices are claimed
+    if (count > 0) {
+        done += count;
+        if (done == n)
+            pool.cvDone.notify_all();
+    }
+}
+
+WorkerPool::WorkerPool(size_t nThreads)
+{
+    if (nThreads == 0) {
+        auto hc { std::thread::hardware_concurrency() };
+        nThreads = (hc > 1 ? hc - 1 : 0);
+    }
+    for (size_t i = 0; i < nThreads; ++i)
+        workers.emplace_back(&WorkerPool::workerfun, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::unique_lock l(mutex);
+        closing = true;
+        cv.notify_all();
+    }
+    for (auto& t : workers)
+        t.join();
+}
+
+void WorkerPool::parallel_for(size_t n, std::function<void(size_t)> f)
+{
+    if (workers.size() == 0 || n <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            f(i);
+        return;
+    }
+
+    parallel_for_async(n, std::move(f)).wait();
+}
+
+auto WorkerPool::parallel_for_async(size_t n, std::function<void(size_t)> f) -> Pending
+{
+    auto job { std::make_shared<Job>(n, std::move(f)) };
+    if (workers.size() > 0 && n > 0) {
+        std::unique_lock l(mutex);
+        jobs.push(job);
+        cv.notify_all();
+    }
+    return { *this, std::move(job) };
+}
+
+void WorkerPool::Pending::wait()
+{
+    job->work(*pool);
+    std::unique_lock l(pool->mutex);
+    pool->cvDone.wait(l, [&]() { return job->done == job->n; });
+    if (job->exception)
+        std::rethrow_exception(job->exception);
+}
+
+void WorkerPool::workerfun()
+{
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock l(mutex);
+            cv.wait(l, [&]() { return closing || !jobs.empty(); });
+            if (closing)
+                return;
+            job = jobs.front();
+        }
+        job->work(*this);
+    }
+}
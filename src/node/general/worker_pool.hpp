@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed size pool of worker threads for CPU bound jobs
+// like signature recovery or proof of work checks.
+class WorkerPool {
+    struct Job {
+        Job(size_t n, std::function<void(size_t)> f)
+            : n(n)
+            , f(std::move(f))
+        {
+        }
+        const size_t n;
+        const std::function<void(size_t)> f;
+        std::atomic<size_t> next { 0 };
+        size_t done { 0 }; // protected by WorkerPool::mutex
+        std::exception_ptr exception; // protected by WorkerPool::mutex
+        void work(WorkerPool&);
+    };
+
+public:
+    // handle of work started by parallel_for_async
+    class Pending {
+        friend class WorkerPool;
+        Pending(WorkerPool& pool, std::shared_ptr<Job> job)
+            : pool(&pool)
+            , job(std::move(job))
+        {
+        }
+
+    public:
+        // takes part in the remaining work and blocks until all calls
+        // have returned, rethrows like parallel_for
+        void wait();
+
+    private:
+        WorkerPool* pool;
+        std::shared_ptr<Job> job;
+    };
+
+    // nThreads == 0 means one thread less than hardware concurrency
+    WorkerPool(size_t nThreads = 0);
+    WorkerPool(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    size_t size() const { return workers.size(); }
+
+    // Calls f(i) for every i in [0,n) and blocks until all calls have
+    // returned. The calling thread takes part in the work. If some call
+    // throws, the first exception observed is rethrown.
+    void parallel_for(size_t n, std::function<void(size_t)> f);
+
+    // Like parallel_for but returns immediately. Without pool threads
+    // all work is done in Pending::wait().
+    [[nodiscard]] Pending parallel_for_async(size_t n, std::function<void(size_t)> f);
+
+private:
+    void workerfun();
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable cvDone;
+    std::queue<std::shared_ptr<Job>> jobs;
+    bool closing { false };
+    std::vector<std::thread> workers;
+};
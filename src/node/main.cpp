@@ -99,13 +99,15 @@ int main(int argc, char** argv)
 
     spdlog::debug("Opening chain database \"{}\"", config().data.chaindb);
     ChainDB db(config().data.chaindb);
-    auto cs = ChainServer::make_chain_server(db, breg, config().node.snapshotSigner);
+    // one pool for signature and proof of work checks of all threads
+    WorkerPool verifierPool(config().node.verificationThreads);
+    auto cs = ChainServer::make_chain_server(db, breg, verifierPool, config().node.snapshotSigner);
 
     std::optional<StratumServer> stratumServer;
     if (config().stratumPool) {
-        stratumServer.emplace(config().stratumPool->bind);
+        stratumServer.emplace(*config().stratumPool);
     }
-    Eventloop el(ps, *cs, config());
+    Eventloop el(ps, *cs, verifierPool, config());
     Conman cm(&l, ps, config());
 
     // setup signals
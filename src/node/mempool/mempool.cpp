@@ -32,12 +32,12 @@ std::vector<TransferTxExchangeMessage> Mempool::get_payments(size_t n, NonzeroHe
     constexpr uint32_t fivedaysBlocks = 5 * 24 * 60 * 3;
     constexpr uint32_t unblockXeggexHeight = 2576442 + fivedaysBlocks;
 
-    for (auto txiter : byFee) {
-        if (height.value() <= unblockXeggexHeight && txiter->first.accountId.value() == 1910)
+    for (auto slot : txs.by_fee()) {
+        auto& [txid, entry] { txs[slot] };
+        if (height.value() <= unblockXeggexHeight && txid.accountId.value() == 1910)
             continue;
         if (res.size() >= n)
             break;
-        auto& [txid, entry] { *txiter };
         res.push_back({ txid, entry });
         if (hashes)
             hashes->emplace_back(entry.hash);
@@ -58,11 +58,7 @@ void Mempool::apply_log(const Log& log)
 void Mempool::apply_logevent(const Put& a)
 {
     erase(a.entry.first);
-    auto p = txs().emplace(a.entry);
-    assert(p.second);
-    assert(byPin.insert(p.first).second);
-    assert(byFee.insert(p.first));
-    assert(byHash.insert(p.first).second);
+    txs.insert(a.entry);
 }
 
 void Mempool::apply_logevent(const Erase& e)
@@ -72,36 +68,30 @@ void Mempool::apply_logevent(const Erase& e)
 
 std::optional<TransferTxExchangeMessage> Mempool::operator[](const TransactionId& id) const
 {
-    auto iter = txs().find(id);
-    if (iter == txs().end())
+    auto slot { txs.find(id) };
+    if (!slot)
         return {};
-    return TransferTxExchangeMessage { iter->first, iter->second };
+    auto& [txid, entry] { txs[*slot] };
+    return TransferTxExchangeMessage { txid, entry };
 }
 
 std::optional<TransferTxExchangeMessage> Mempool::operator[](const HashView txHash) const
 {
-    auto iter = byHash.find(txHash);
-    if (iter == byHash.end())
+    auto slot { txs.find(txHash) };
+    if (!slot)
         return {};
-    assert((*iter)->second.hash == txHash);
-    return TransferTxExchangeMessage { (*iter)->first, (*iter)->second };
+    auto& [txid, entry] { txs[*slot] };
+    assert(entry.hash == txHash);
+    return TransferTxExchangeMessage { txid, entry };
 }
 
-bool Mempool::erase_internal(Txmap::const_iterator iter, BalanceEntries::iterator b_iter, bool gc)
+bool Mempool::erase_internal(Slot slot, BalanceEntries::iterator b_iter, bool gc)
 {
-    assert(size() == byFee.size());
-    assert(size() == byPin.size());
-    assert(size() == byHash.size());
-
     // copy before erase
-    const TransactionId id { iter->first };
-    Funds spend { iter->second.spend_assert() };
+    const TransactionId id { txs[slot].first };
+    Funds spend { txs[slot].second.spend_assert() };
 
-    // erase iter and its references
-    assert(byPin.erase(iter) == 1);
-    assert(byFee.erase(iter) == 1);
-    assert(byHash.erase(iter) == 1);
-    txs().erase(iter);
+    txs.erase(slot);
 
     if (master)
         log.push_back(Erase { id });
@@ -118,40 +108,57 @@ bool Mempool::erase_internal(Txmap::const_iterator iter, BalanceEntries::iterato
     return false;
 }
 
-void Mempool::erase_internal(Txmap::const_iterator iter)
+void Mempool::erase_internal(Slot slot)
 {
-    auto b_iter = balanceEntries.find(iter->first.accountId);
-    erase_internal(iter, b_iter);
+    auto b_iter = balanceEntries.find(txs[slot].first.accountId);
+    erase_internal(slot, b_iter);
 }
 
 void Mempool::erase_from_height(Height h)
 {
-    auto iter = byPin.lower_bound(h);
-    while (iter != byPin.end())
-        erase_internal(*(iter++));
+    for (auto slot : txs.pinned_from(h))
+        erase_internal(slot);
 }
 
 void Mempool::erase_before_height(Height h)
 {
-    auto end = byPin.lower_bound(h);
-    for (auto iter = byPin.begin(); iter != end;)
-        erase_internal(*(iter++));
+    for (auto slot : txs.pinned_before(h))
+        erase_internal(slot);
 }
 
 void Mempool::erase(TransactionId id)
 {
-    auto& t { txs() };
-    if (auto iter = t.find(id); iter != t.end())
-        erase_internal(iter);
+    if (auto slot { txs.find(id) })
+        erase_internal(*slot);
 }
 
 std::vector<TxidWithFee> Mempool::sample(size_t N) const
 {
-    auto sampled { byFee.sample(800, N) };
+    // sample from the 800 highest fee transactions
+    std::vector<Slot> top;
+    for (auto slot : txs.by_fee()) {
+        if (top.size() >= 800)
+            break;
+        top.push_back(slot);
+    }
+    std::vector<Slot> sampled;
+    std::sample(top.begin(), top.end(), std::back_inserter(sampled), std::min(N, top.size()),
+        std::mt19937 { std::random_device {}() });
+    std::vector<TxidWithFee> out;
+    for (auto slot : sampled) {
+        auto& [txid, e] { txs[slot] };
+        out.push_back({ txid, e.fee });
+    }
+    return out;
+}
+
+std::vector<TxidWithFee> Mempool::txids() const
+{
     std::vector<TxidWithFee> out;
-    for (auto iter : sampled) {
-        auto& p { *iter };
-        out.push_back({ p.first, p.second.fee });
+    out.reserve(txs.size());
+    for (auto slot : txs.by_fee()) {
+        auto& [txid, e] { txs[slot] };
+        out.push_back({ txid, e.fee });
     }
     return out;
 }
@@ -160,11 +167,11 @@ std::vector<TransactionId> Mempool::filter_new(const std::vector<TxidWithFee>& v
 {
     std::vector<TransactionId> out;
     for (auto& t : v) {
-        auto iter = txs().find(t.txid);
-        if (iter == txs().end()) {
+        auto slot { txs.find(t.txid) };
+        if (!slot) {
             if (t.fee >= min_fee())
                 out.push_back(t.txid);
-        } else if (t.fee > iter->second.fee)
+        } else if (t.fee > txs[*slot].second.fee)
             out.push_back(t.txid);
     }
     return out;
@@ -179,11 +186,11 @@ void Mempool::set_balance(AccountId accId, Funds newBalance)
     if (balanceEntry.set_avail(newBalance))
         return;
 
-    auto iterators { txs.by_fee_inc(accId) };
+    auto slots { txs.by_fee_inc(accId) };
 
-    for (size_t i = 0; i < iterators.size(); ++i) {
-        bool allErased = erase_internal(iterators[i], b_iter);
-        bool lastIteration = (i == iterators.size() - 1);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        bool allErased = erase_internal(slots[i], b_iter);
+        bool lastIteration = (i == slots.size() - 1);
         assert(allErased == lastIteration);
         if (allErased || balanceEntry.set_avail(newBalance))
             return;
@@ -221,27 +228,27 @@ void Mempool::insert_tx_throw(const TransferTxExchangeMessage& pm,
     const Funds spend { pm.spend_throw() };
 
     { // check if we can delete enough old entries to insert new entry
-        std::vector<Txmap::const_iterator> clear;
-        std::optional<Txmap::const_iterator> match;
-        const auto& t { txs };
-        if (auto iter = t().find(pm.txid); iter != t().end()) {
-            if (iter->second.fee >= pm.compactFee) {
+        std::vector<Slot> clear;
+        std::optional<Slot> match;
+        if (auto slot { txs.find(pm.txid) }) {
+            if (txs[*slot].second.fee >= pm.compactFee) {
                 throw Error(ENONCE);
             }
-            clear.push_back(iter);
-            match = iter;
+            clear.push_back(*slot);
+            match = slot;
         }
         const auto remaining { e.remaining() };
         if (remaining < spend) {
             Funds clearSum { Funds::zero() };
-            auto iterators { txs.by_fee_inc(pm.txid.accountId) };
-            for (auto iter : iterators) {
-                if (iter == match)
+            auto slots { txs.by_fee_inc(pm.txid.accountId) };
+            for (auto slot : slots) {
+                if (slot == match)
                     continue;
-                if (iter->second.fee >= pm.compactFee)
+                auto& entry { txs[slot].second };
+                if (entry.fee >= pm.compactFee)
                     break;
-                clear.push_back(iter);
-                clearSum.add_assert(iter->second.spend_assert());
+                clear.push_back(slot);
+                clearSum.add_assert(entry.spend_assert());
                 if (Funds::sum_assert(remaining, clearSum) >= spend) {
                     goto candelete;
                 }
@@ -249,19 +256,15 @@ void Mempool::insert_tx_throw(const TransferTxExchangeMessage& pm,
             throw Error(EBALANCE);
         candelete:;
         }
-        for (auto& iter : clear)
-            erase_internal(iter, balanceIter, false); // make sure we don't delete balanceIter
+        for (auto slot : clear)
+            erase_internal(slot, balanceIter, false); // make sure we don't delete balanceIter
     }
 
     e.lock(spend);
-    auto [iter, inserted] = txs().try_emplace(pm.txid,
-        pm.reserved, pm.compactFee, pm.toAddr, pm.amount, pm.signature, txhash, txh);
-    assert(inserted);
+    Entry entry { pm.txid, EntryValue { pm.reserved, pm.compactFee, pm.toAddr, pm.amount, pm.signature, txhash, txh } };
+    txs.insert(entry);
     if (master)
-        log.push_back(Put { *iter });
-    assert(byPin.insert(iter).second);
-    assert(byFee.insert(iter));
-    assert(byHash.insert(iter).second);
+        log.push_back(Put { std::move(entry) });
     prune();
 }
 
@@ -269,10 +272,11 @@ size_t Mempool::on_constraint_update()
 {
     size_t deleted { 0 };
     auto minFee { config().node.minMempoolFee.load() };
-    while (byFee.size() != 0) {
-        if (byFee.smallest()->second.fee >= minFee)
+    while (txs.size() != 0) {
+        auto smallest { txs.smallest() };
+        if (txs[smallest].second.fee >= minFee)
             break;
-        erase_internal(byFee.smallest());
+        erase_internal(smallest);
         deleted += 1;
     }
     return deleted;
@@ -281,7 +285,7 @@ size_t Mempool::on_constraint_update()
 void Mempool::prune()
 {
     while (size() > maxSize)
-        erase_internal(byFee.smallest()); // delete smallest element
+        erase_internal(txs.smallest()); // delete smallest element
 }
 
 CompactUInt Mempool::min_fee() const
@@ -289,7 +293,7 @@ CompactUInt Mempool::min_fee() const
     auto minFromMempool { [&]() {
         if (size() < maxSize)
             return CompactUInt::smallest();
-        return byFee.smallest()->second.fee.next();
+        return txs[txs.smallest()].second.fee.next();
     }() };
     return std::max(config().node.minMempoolFee.load(), minFromMempool);
 }
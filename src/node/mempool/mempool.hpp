@@ -1,8 +1,7 @@
 #pragma once
-#include "comparators.hpp"
 #include "general/address_funds.hpp"
 #include "mempool/log.hpp"
-#include <set>
+#include "txmap.hpp"
 namespace chainserver {
 struct TransactionIds;
 }
@@ -26,9 +25,6 @@ private:
 };
 
 class Mempool {
-    using iter_t = Txmap::iterator;
-    using const_iter_t = Txmap::const_iterator;
-
 public:
     Mempool(bool master = true, size_t maxSize = 10000)
         : master(master)
@@ -55,6 +51,7 @@ public:
     [[nodiscard]] auto get_payments(size_t n, NonzeroHeight height, std::vector<Hash>* hashes = nullptr) const
         -> std::vector<TransferTxExchangeMessage>;
     [[nodiscard]] auto sample(size_t) const -> std::vector<TxidWithFee>;
+    [[nodiscard]] auto txids() const -> std::vector<TxidWithFee>;
     [[nodiscard]] auto filter_new(const std::vector<TxidWithFee>&) const
         -> std::vector<TransactionId>;
 
@@ -70,16 +67,13 @@ private:
     using BalanceEntries = std::map<AccountId, BalanceEntry>;
     void apply_logevent(const Put&);
     void apply_logevent(const Erase&);
-    void erase_internal(Txmap::const_iterator);
-    bool erase_internal(Txmap::const_iterator, BalanceEntries::iterator, bool gc = true);
+    void erase_internal(Slot);
+    bool erase_internal(Slot, BalanceEntries::iterator, bool gc = true);
     void prune();
 
 private:
     Log log;
     Txmap txs;
-    std::set<const_iter_t, ComparatorPin> byPin;
-    ByFeeDesc byFee;
-    std::set<const_iter_t, ComparatorHash> byHash;
     BalanceEntries balanceEntries;
     bool master;
     size_t maxSize;
@@ -0,0 +1,128 @@
+#include "tx_sketch.hpp"
+#include "general/errors.hpp"
+#include "general/reader.hpp"
+#include "general/writer.hpp"
+#include <algorithm>
+
+namespace mempool {
+namespace {
+uint64_t mix(uint64_t x)
+{ // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+uint32_t check(uint64_t key)
+{
+    return uint32_t(mix(key ^ 0x5bd1e9955bd1e995ull));
+}
+}
+
+uint64_t short_id(const TxidWithFee& t, uint64_t salt)
+{
+    uint64_t h { mix(salt ^ t.txid.accountId.value()) };
+    h = mix(h ^ ((uint64_t(t.txid.pinHeight.value()) << 32) | t.txid.nonceId.value()));
+    return mix(h ^ t.fee.value());
+}
+
+bool TxSketch::Cell::pure() const
+{
+    return (count == 1 || count == -1) && checkSum == check(keySum);
+}
+
+TxSketch::TxSketch(size_t capacity)
+{
+    capacity = std::clamp(capacity, MINCELLS, MAXCELLS);
+    cells.resize((capacity + HASHES - 1) / HASHES * HASHES);
+}
+
+TxSketch::TxSketch(Reader& r)
+{
+    size_t n { r.uint16() };
+    if (n < MINCELLS || n > MAXCELLS || n % HASHES != 0)
+        throw Error(EMSGINTEGRITY);
+    cells.resize(n);
+    for (auto& c : cells) {
+        c.count = int32_t(r.uint32());
+        c.keySum = r.uint64();
+        c.checkSum = r.uint32();
+    }
+}
+
+Writer& operator<<(Writer& w, const TxSketch& s)
+{
+    w << uint16_t(s.cells.size());
+    for (auto& c : s.cells)
+        w << uint32_t(c.count) << c.keySum << c.checkSum;
+    return w;
+}
+
+size_t TxSketch::position(uint64_t key, size_t i) const
+{ // one cell in each of the HASHES subtables
+    const size_t sub { cells.size() / HASHES };
+    return i * sub + mix(key + i) % sub;
+}
+
+void TxSketch::toggle(uint64_t key, int32_t count)
+{
+    const uint32_t chk { check(key) };
+    for (size_t i = 0; i < HASHES; ++i) {
+        auto& c { cells[position(key, i)] };
+        c.count += count;
+        c.keySum ^= key;
+        c.checkSum ^= chk;
+    }
+}
+
+void TxSketch::subtract(const TxSketch& other)
+{
+    if (other.cells.size() != cells.size())
+        throw Error(EMSGINTEGRITY);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        cells[i].count -= other.cells[i].count;
+        cells[i].keySum ^= other.cells[i].keySum;
+        cells[i].checkSum ^= other.cells[i].checkSum;
+    }
+}
+
+auto TxSketch::decode() const -> std::optional<Difference>
+{
+    TxSketch s(*this);
+    Difference d;
+    std::vector<size_t> pure;
+    for (size_t i = 0; i < s.cells.size(); ++i)
+        if (s.cells[i].pure())
+            pure.push_back(i);
+    while (!pure.empty()) {
+        const size_t j { pure.back() };
+        auto c { s.cells[j] };
+        pure.pop_back();
+        if (!c.pure())
+            continue;
+        // a cell can look pure without the key hashing to it (crafted by
+        // a peer or by chance), peeling it would corrupt other cells
+        bool own { false };
+        for (size_t i = 0; i < HASHES; ++i)
+            own |= s.position(c.keySum, i) == j;
+        if (!own)
+            continue;
+        auto& keys { c.count == 1 ? d.ours : d.theirs };
+        keys.push_back(c.keySum);
+        if (d.ours.size() + d.theirs.size() > s.cells.size())
+            return {};
+        s.toggle(c.keySum, -c.count);
+        for (size_t i = 0; i < HASHES; ++i) {
+            const size_t k { s.position(c.keySum, i) };
+            if (s.cells[k].pure())
+                pure.push_back(k);
+        }
+    }
+    for (auto& c : s.cells)
+        if (!c.empty())
+            return {};
+    return d;
+}
+}
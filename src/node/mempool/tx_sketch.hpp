@@ -0,0 +1,51 @@
+#pragma once
+#include "block/body/transaction_id.hpp"
+#include <optional>
+#include <vector>
+
+class Reader;
+class Writer;
+namespace mempool {
+
+// 64 bit id of a mempool entry for set reconciliation, the fee is
+// included such that fee bumps show up as differences
+[[nodiscard]] uint64_t short_id(const TxidWithFee&, uint64_t salt);
+
+// Invertible Bloom lookup table of short ids. Subtracting the sketch of
+// another set yields a sketch of the symmetric difference which can be
+// decoded if it has noticeably fewer elements than the sketch has cells.
+class TxSketch {
+public:
+    static constexpr size_t HASHES = 3;
+    static constexpr size_t MINCELLS = 24;
+    static constexpr size_t MAXCELLS = 4095;
+    static constexpr size_t CELLSIZE = 4 + 8 + 4;
+    struct Difference {
+        std::vector<uint64_t> ours; // only in the minuend
+        std::vector<uint64_t> theirs; // only in the subtrahend
+    };
+
+    // capacity is rounded to a multiple of HASHES in [MINCELLS, MAXCELLS]
+    TxSketch(size_t capacity);
+    TxSketch(Reader& r);
+    friend Writer& operator<<(Writer&, const TxSketch&);
+    size_t serialized_size() const { return 2 + cells.size() * CELLSIZE; }
+    size_t size() const { return cells.size(); }
+
+    void insert(uint64_t shortId) { toggle(shortId, 1); }
+    void subtract(const TxSketch&);
+    [[nodiscard]] std::optional<Difference> decode() const;
+
+private:
+    struct Cell {
+        int32_t count { 0 };
+        uint64_t keySum { 0 };
+        uint32_t checkSum { 0 };
+        bool empty() const { return count == 0 && keySum == 0 && checkSum == 0; }
+        bool pure() const;
+    };
+    size_t position(uint64_t key, size_t i) const;
+    void toggle(uint64_t key, int32_t count);
+    std::vector<Cell> cells;
+};
+}
@@ -1,44 +1,278 @@
 #include "txmap.hpp"
+#include "crypto/hash.hpp"
 #include <algorithm>
+#include <bit>
+#include <cstring>
 #include <random>
-#include <ranges>
+
 namespace mempool {
-auto Txmap::by_fee_inc(AccountId id) const -> std::vector<const_iterator>
-{
-    auto lb { _map.lower_bound(id) };
-    auto ub { _map.upper_bound(id) };
-    std::vector<const_iterator> iterators;
-    for (auto iter { lb }; iter != ub; ++iter)
-        iterators.push_back(iter);
-    std::sort(iterators.begin(), iterators.end(), [](auto iter1, auto iter2) {
-        return iter1->second.fee < iter2->second.fee;
-    });
-    return iterators;
-};
+namespace {
+uint64_t mix(uint64_t h)
+{
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+// keys are chosen by peers, without a secret seed they could grind
+// transactions into long probe sequences
+const uint64_t seed { (uint64_t(std::random_device {}()) << 32) ^ std::random_device {}() };
+
+uint64_t hash_of(const TransactionId& id)
+{
+    return mix(mix(seed ^ id.accountId.value()) ^ ((uint64_t(id.pinHeight.value()) << 32) | id.nonceId.value()));
+}
+
+uint64_t hash_of(HashView h)
+{
+    uint64_t v;
+    memcpy(&v, h.data(), sizeof(v));
+    return mix(seed ^ v);
+}
+
+uint64_t hash_of(AccountId id)
+{
+    return mix(seed ^ id.value());
+}
+}
+
+Slot& Txmap::FeeBuckets::head(uint16_t fee)
+{
+    if (heads.empty())
+        heads.assign(N, NOSLOT);
+    return heads[fee];
+}
 
-bool ByFeeDesc::insert(const_iter_t iter)
+void Txmap::FeeBuckets::set(uint16_t fee, bool nonempty)
 {
-    auto pos = std::lower_bound(data.begin(), data.end(), iter, [](const_iter_t i1, const_iter_t i2) { return i1->second.fee > i2->second.fee; });
-    if (pos != data.end() && *pos == iter)
-        return false;
-    data.insert(pos, iter);
-    return true;
+    auto& w { words[fee >> 6] };
+    const uint64_t bit { uint64_t(1) << (fee & 63) };
+    if (nonempty)
+        w |= bit;
+    else
+        w &= ~bit;
+    auto& s { summary[fee >> 12] };
+    const uint64_t sbit { uint64_t(1) << ((fee >> 6) & 63) };
+    if (w != 0)
+        s |= sbit;
+    else
+        s &= ~sbit;
 }
 
-size_t ByFeeDesc::erase(const_iter_t iter)
+std::optional<uint16_t> Txmap::FeeBuckets::highest_below(size_t end) const
 {
-    return std::erase(data, iter);
+    if (end == 0)
+        return {};
+    const size_t v { end - 1 };
+    size_t w { v >> 6 };
+    if (uint64_t bits { words[w] & (~uint64_t(0) >> (63 - (v & 63))) })
+        return w * 64 + 63 - std::countl_zero(bits);
+    if (w == 0)
+        return {};
+    w -= 1;
+    size_t s { w >> 6 };
+    uint64_t bits { summary[s] & (~uint64_t(0) >> (63 - (w & 63))) };
+    while (bits == 0) {
+        if (s == 0)
+            return {};
+        bits = summary[--s];
+    }
+    w = s * 64 + 63 - std::countl_zero(bits);
+    return w * 64 + 63 - std::countl_zero(words[w]);
 }
 
-auto ByFeeDesc::sample(size_t n, size_t k) const -> std::vector<const_iter_t>
+std::optional<uint16_t> Txmap::FeeBuckets::lowest() const
 {
-    n = std::min(n, data.size());
-    k = std::min(n, k);
+    for (size_t s = 0; s < summary.size(); ++s) {
+        if (summary[s] != 0) {
+            size_t w { s * 64 + std::countr_zero(summary[s]) };
+            return w * 64 + std::countr_zero(words[w]);
+        }
+    }
+    return {};
+}
+
+uint64_t Txmap::txid_hash(Slot s) const
+{
+    return hash_of(nodes[s].entry.first);
+}
+
+uint64_t Txmap::hash_hash(Slot s) const
+{
+    return hash_of(nodes[s].entry.second.hash);
+}
+
+uint64_t Txmap::account_hash(Slot s) const
+{
+    return hash_of(nodes[s].entry.first.accountId);
+}
 
-    std::vector<const_iter_t> res;
-    std::sample(data.begin(), data.begin() + n, std::back_inserter(res), k,
-        std::mt19937 { std::random_device {}() });
-    return res;
+template <Txmap::Link Txmap::Node::*L>
+void Txmap::link_front(Slot& head, Slot s)
+{
+    auto& l { nodes[s].*L };
+    if (head == NOSLOT) {
+        l = { s, s };
+    } else {
+        auto& h { nodes[head].*L };
+        l = { h.prev, head };
+        (nodes[h.prev].*L).next = s;
+        h.prev = s;
+    }
+    head = s;
+}
+
+template <Txmap::Link Txmap::Node::*L>
+void Txmap::unlink(Slot& head, Slot s)
+{
+    auto& l { nodes[s].*L };
+    if (l.next == s) {
+        head = NOSLOT;
+        return;
+    }
+    (nodes[l.prev].*L).next = l.next;
+    (nodes[l.next].*L).prev = l.prev;
+    if (head == s)
+        head = l.next;
 }
 
+template <Txmap::Link Txmap::Node::*L>
+void Txmap::collect(Slot head, std::vector<Slot>& out) const
+{
+    if (head == NOSLOT)
+        return;
+    Slot s { head };
+    do {
+        out.push_back(s);
+        s = (nodes[s].*L).next;
+    } while (s != head);
+}
+
+std::optional<Slot> Txmap::find(const TransactionId& id) const
+{
+    auto p { byTxid.find(hash_of(id), [&](Slot s) { return nodes[s].entry.first == id; }) };
+    if (!p)
+        return {};
+    return *p;
+}
+
+std::optional<Slot> Txmap::find(HashView hash) const
+{
+    auto p { byHash.find(hash_of(hash), [&](Slot s) { return nodes[s].entry.second.hash == hash; }) };
+    if (!p)
+        return {};
+    return *p;
+}
+
+Slot Txmap::insert(const Entry& e)
+{
+    assert(!find(e.first) && !find(e.second.hash));
+    Slot s;
+    if (freeSlots.empty()) {
+        s = nodes.size();
+        nodes.push_back({ e, {}, {}, {} });
+    } else {
+        s = freeSlots.back();
+        freeSlots.pop_back();
+        nodes[s].entry = e;
+    }
+
+    const auto fee { e.second.fee.value() };
+    auto& feeHead { feeBuckets.head(fee) };
+    if (feeHead == NOSLOT)
+        feeBuckets.set(fee, true);
+    link_front<&Node::fee>(feeHead, s);
+    link_front<&Node::pin>(pinHeads.try_emplace(e.first.pinHeight.value(), NOSLOT).first->second, s);
+
+    const AccountId accountId { e.first.accountId };
+    if (auto p { accountHeads.find(hash_of(accountId), [&](Slot a) { return nodes[a].entry.first.accountId == accountId; }) }) {
+        link_front<&Node::account>(*p, s);
+    } else {
+        Slot head { NOSLOT };
+        link_front<&Node::account>(head, s);
+        accountHeads.insert(hash_of(accountId), s, [&](Slot a) { return account_hash(a); });
+    }
+    byTxid.insert(hash_of(e.first), s, [&](Slot a) { return txid_hash(a); });
+    byHash.insert(hash_of(e.second.hash), s, [&](Slot a) { return hash_hash(a); });
+    _cacheValidity += 1;
+    return s;
+}
+
+void Txmap::erase(Slot s)
+{
+    const auto& e { nodes[s].entry };
+    auto is_s { [&](Slot a) { return a == s; } };
+    byTxid.erase(byTxid.find(hash_of(e.first), is_s), [&](Slot a) { return txid_hash(a); });
+    byHash.erase(byHash.find(hash_of(e.second.hash), is_s), [&](Slot a) { return hash_hash(a); });
+
+    const auto fee { e.second.fee.value() };
+    auto& feeHead { feeBuckets.head(fee) };
+    unlink<&Node::fee>(feeHead, s);
+    if (feeHead == NOSLOT)
+        feeBuckets.set(fee, false);
+
+    auto pinIter { pinHeads.find(e.first.pinHeight.value()) };
+    unlink<&Node::pin>(pinIter->second, s);
+    if (pinIter->second == NOSLOT)
+        pinHeads.erase(pinIter);
+
+    const AccountId accountId { e.first.accountId };
+    auto accountHead { accountHeads.find(hash_of(accountId), [&](Slot a) { return nodes[a].entry.first.accountId == accountId; }) };
+    unlink<&Node::account>(*accountHead, s);
+    if (*accountHead == NOSLOT)
+        accountHeads.erase(accountHead, [&](Slot a) { return account_hash(a); });
+
+    freeSlots.push_back(s);
+    _cacheValidity += 1;
+}
+
+Slot Txmap::first_by_fee() const
+{
+    auto fee { feeBuckets.highest_below(FeeBuckets::N) };
+    return fee ? feeBuckets.head(*fee) : NOSLOT;
+}
+
+Slot Txmap::next_by_fee(Slot s) const
+{
+    auto& n { nodes[s] };
+    const auto fee { n.entry.second.fee.value() };
+    if (n.fee.next != feeBuckets.head(fee))
+        return n.fee.next;
+    auto lower { feeBuckets.highest_below(fee) };
+    return lower ? feeBuckets.head(*lower) : NOSLOT;
+}
+
+Slot Txmap::smallest() const
+{
+    auto fee { feeBuckets.lowest() };
+    assert(fee.has_value());
+    return nodes[feeBuckets.head(*fee)].fee.prev;
+}
+
+auto Txmap::by_fee_inc(AccountId id) const -> std::vector<Slot>
+{
+    std::vector<Slot> slots;
+    if (auto p { accountHeads.find(hash_of(id), [&](Slot a) { return nodes[a].entry.first.accountId == id; }) })
+        collect<&Node::account>(*p, slots);
+    std::sort(slots.begin(), slots.end(), [&](Slot s1, Slot s2) {
+        return nodes[s1].entry.second.fee < nodes[s2].entry.second.fee;
+    });
+    return slots;
+}
+
+auto Txmap::pinned_from(Height h) const -> std::vector<Slot>
+{
+    std::vector<Slot> slots;
+    for (auto iter { pinHeads.lower_bound(h.value()) }; iter != pinHeads.end(); ++iter)
+        collect<&Node::pin>(iter->second, slots);
+    return slots;
+}
+
+auto Txmap::pinned_before(Height h) const -> std::vector<Slot>
+{
+    std::vector<Slot> slots;
+    for (auto iter { pinHeads.begin() }; iter != pinHeads.lower_bound(h.value()); ++iter)
+        collect<&Node::pin>(iter->second, slots);
+    return slots;
+}
 }
@@ -2,43 +2,176 @@
 
 #include "block/body/transaction_id.hpp"
 #include "entry.hpp"
+#include <array>
 #include <map>
+#include <optional>
+#include <vector>
 
 class HashView;
-class TransferTxExchangeMessageView;
 namespace mempool {
-class Txmap {
-public:
-    using map_t = std::map<TransactionId, EntryValue, std::less<>>;
-    using const_iterator = map_t::const_iterator;
-    using iterator = map_t::iterator;
+using Slot = uint32_t;
+constexpr Slot NOSLOT { Slot(-1) };
 
-private:
-    map_t _map;
-    int _cacheValidity { 0 }; // incremented on mempool change
+// Open addressing table of slots with linear probing. Keys are not
+// stored, callers pass the key's hash and compare the key through the
+// slot. Erasing uses backward shifting, there are no tombstones.
+class SlotTable {
 public:
-    auto cache_validity() const { return _cacheValidity; }
+    size_t size() const { return n; }
+    Slot* find(uint64_t hash, auto matches)
+    {
+        if (cells.empty())
+            return nullptr;
+        for (size_t i = hash & mask();; i = (i + 1) & mask()) {
+            if (cells[i] == NOSLOT)
+                return nullptr;
+            if (matches(cells[i]))
+                return &cells[i];
+        }
+    }
+    const Slot* find(uint64_t hash, auto matches) const
+    {
+        return const_cast<SlotTable*>(this)->find(hash, matches);
+    }
+    void insert(uint64_t hash, Slot s, auto hashOf)
+    {
+        if ((n + 1) * 4 > cells.size() * 3)
+            grow(hashOf);
+        size_t i { hash & mask() };
+        while (cells[i] != NOSLOT)
+            i = (i + 1) & mask();
+        cells[i] = s;
+        n += 1;
+    }
+    void erase(Slot* cell, auto hashOf)
+    {
+        size_t i = cell - cells.data();
+        for (size_t j = (i + 1) & mask(); cells[j] != NOSLOT; j = (j + 1) & mask()) {
+            size_t home { hashOf(cells[j]) & mask() };
+            if (((j - home) & mask()) >= ((j - i) & mask())) {
+                cells[i] = cells[j];
+                i = j;
+            }
+        }
+        cells[i] = NOSLOT;
+        n -= 1;
+    }
 
-    auto size() const{return _map.size();}
-    auto& operator()()
+private:
+    size_t mask() const { return cells.size() - 1; }
+    void grow(auto hashOf)
     {
-        _cacheValidity += 1;
-        return _map;
+        std::vector<Slot> old(std::max(size_t(16), cells.size() * 2), NOSLOT);
+        std::swap(old, cells);
+        n = 0;
+        for (auto s : old) {
+            if (s != NOSLOT)
+                insert(hashOf(s), s, hashOf);
+        }
     }
-    auto& operator()() const { return _map; }
-    [[nodiscard]] std::vector<const_iterator> by_fee_inc(AccountId) const;
+    std::vector<Slot> cells;
+    size_t n { 0 };
 };
-struct ByFeeDesc {
-    using const_iter_t = Txmap::const_iterator;
-    bool insert(const_iter_t iter);
-    [[nodiscard]] size_t erase(const_iter_t iter);
-    const_iter_t smallest() const { return data.back(); }
-    std::vector<const_iter_t> sample(size_t n, size_t k) const;
-    size_t size() const { return data.size(); }
-    auto begin() const { return data.begin(); }
-    auto end() const { return data.end(); }
+
+// Mempool entries in a slab with intrusive indices:
+// - fee buckets, one per compact fee value, found through a bitmap,
+// - pin height buckets,
+// - per account lists,
+// - hash tables by transaction id and by transaction hash.
+// Slots stay valid until erased.
+class Txmap {
+    struct Link {
+        Slot prev;
+        Slot next;
+    };
+    struct Node {
+        Entry entry;
+        Link fee;
+        Link pin;
+        Link account;
+    };
+
+    // one circular list per compact fee value, newest first, and a
+    // two level bitmap of the nonempty ones
+    class FeeBuckets {
+    public:
+        static constexpr size_t N { 65536 };
+        Slot& head(uint16_t fee);
+        Slot head(uint16_t fee) const { return heads.empty() ? NOSLOT : heads[fee]; }
+        void set(uint16_t fee, bool nonempty);
+        std::optional<uint16_t> highest_below(size_t end) const;
+        std::optional<uint16_t> lowest() const;
+
+    private:
+        std::vector<Slot> heads; // allocated on first use
+        std::array<uint64_t, N / 64> words {};
+        std::array<uint64_t, N / 64 / 64> summary {};
+    };
+
+public:
+    class FeeOrder {
+    public:
+        struct iterator {
+            const Txmap* t;
+            Slot s;
+            Slot operator*() const { return s; }
+            iterator& operator++()
+            {
+                s = t->next_by_fee(s);
+                return *this;
+            }
+            bool operator==(const iterator&) const = default;
+        };
+        iterator begin() const { return { t, t->first_by_fee() }; }
+        iterator end() const { return { t, NOSLOT }; }
+
+    private:
+        friend class Txmap;
+        FeeOrder(const Txmap* t)
+            : t(t)
+        {
+        }
+        const Txmap* t;
+    };
+
+    auto cache_validity() const { return _cacheValidity; }
+    size_t size() const { return byTxid.size(); }
+    const Entry& operator[](Slot s) const { return nodes[s].entry; }
+    [[nodiscard]] std::optional<Slot> find(const TransactionId&) const;
+    [[nodiscard]] std::optional<Slot> find(HashView) const;
+
+    // the transaction id and hash must not be present
+    Slot insert(const Entry&);
+    void erase(Slot);
+
+    // highest fee first, among equal fees the most recently inserted first
+    FeeOrder by_fee() const { return { this }; }
+    Slot smallest() const; // last in fee order, requires size() > 0
+    [[nodiscard]] std::vector<Slot> by_fee_inc(AccountId) const;
+    [[nodiscard]] std::vector<Slot> pinned_from(Height) const;
+    [[nodiscard]] std::vector<Slot> pinned_before(Height) const;
 
 private:
-    std::vector<const_iter_t> data;
+    Slot first_by_fee() const;
+    Slot next_by_fee(Slot) const;
+    template <Link Node::*L>
+    void link_front(Slot& head, Slot);
+    template <Link Node::*L>
+    void unlink(Slot& head, Slot);
+    template <Link Node::*L>
+    void collect(Slot head, std::vector<Slot>& out) const;
+    uint64_t txid_hash(Slot s) const;
+    uint64_t hash_hash(Slot s) const;
+    uint64_t account_hash(Slot s) const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Slot> freeSlots;
+    FeeBuckets feeBuckets;
+    std::map<uint32_t, Slot> pinHeads;
+    SlotTable byTxid;
+    SlotTable byHash;
+    SlotTable accountHeads;
+    int _cacheValidity { 0 }; // incremented on mempool change
 };
 }
@@ -1,6 +1,7 @@
 #include "view.hpp"
 #include "crypto/crypto.hpp"
 #include "crypto/hasher_sha256.hpp"
+#include "crypto/sha256_batch.hpp"
 #include "general/hex.hpp"
 #include "general/is_testnet.hpp"
 #include "general/reader.hpp"
@@ -72,112 +73,71 @@ std::vector<Hash> BodyView::merkle_leaves() const
     std::vector<Hash> hashes(nAddresses + 1 + nTransfers);
 
     // hash addresses
-    size_t idx = 0;
-    for (size_t i = 0; i < nAddresses; ++i)
-        hashes[idx++] = hashSHA256(s.data() + offsetAddresses + i * AddressSize, AddressSize);
+    Hash* out { hashes.data() };
+    sha256::hash_batch(data() + offsetAddresses, AddressSize, AddressSize, nAddresses, out);
+    out += nAddresses;
 
     // hash rewards
-    for (size_t i = 0; i < 1; ++i)
-        hashes[idx++] = hashSHA256(data() + offsetReward + i * RewardSize, RewardSize);
+    sha256::hash_batch(data() + offsetReward, RewardSize, RewardSize, 1, out);
+    out += 1;
+
     // hash payments
-    for (size_t i = 0; i < nTransfers; ++i)
-        hashes[idx++] = hashSHA256(data() + offsetTransfers + i * TransferSize, TransferSize);
+    sha256::hash_batch(data() + offsetTransfers, TransferSize, TransferSize, nTransfers, out);
     return hashes;
 };
 
-std::vector<uint8_t> BodyView::merkle_prefix() const
+namespace {
+// replaces a merkle level with the next one in place,
+// an unpaired last node is hashed alone
+void merkle_level(std::vector<Hash>& hashes)
+{
+    const size_t n { hashes.size() / 2 };
+    sha256::hash_batch(hashes[0].data(), 64, 64, n, hashes.data());
+    if (hashes.size() % 2 != 0)
+        hashes[n] = hashSHA256(hashes.back());
+    hashes.resize((hashes.size() + 1) / 2);
+}
+}
+
+std::vector<Hash> BodyView::merkle_top() const
 {
     std::vector<Hash> hashes(merkle_leaves());
-    std::vector<Hash> tmp, *from, *to;
-    from = &hashes;
-    to = &tmp;
-
-    do {
-        to->resize((from->size() + 1) / 2);
-        size_t j = 0;
-        for (size_t i = 0; i < (from->size() + 1) / 2; ++i) {
-            if (to->size() == 1) {
-                std::vector<uint8_t> res;
-                std::copy((*from)[j].begin(), (*from)[j].end(), std::back_inserter(res));
-                if (j + 1 < from->size()) {
-                    std::copy((*from)[j + 1].begin(), (*from)[j + 1].end(), std::back_inserter(res));
-                }
-                return res;
-            }
-            HasherSHA256 hasher {};
-            hasher.write((*from)[j].data(), 32);
-            if (j + 1 < from->size()) {
-                hasher.write((*from)[j + 1].data(), 32);
-            }
-
-            (*to)[i] = std::move(hasher);
-            j += 2;
-        }
-        std::swap(from, to);
-    } while (from->size() > 1);
-    assert(false);
+    while (hashes.size() > 2)
+        merkle_level(hashes);
+    return hashes;
+}
+
+std::vector<uint8_t> BodyView::merkle_prefix() const
+{
+    std::vector<uint8_t> res;
+    for (auto& h : merkle_top())
+        std::copy(h.begin(), h.end(), std::back_inserter(res));
+    return res;
 }
 
 Hash BodyView::merkle_root(Height h) const
 {
     assert(isValid);
-    std::vector<Hash> hashes(merkle_leaves());
-    std::vector<Hash> tmp, *from, *to;
-    from = &hashes;
-    to = &tmp;
+    return seeded_merkle_root(merkle_top(), data(), h);
+}
 
+Hash BodyView::seeded_merkle_root(std::span<const Hash> topNodes, const uint8_t* seed, Height h)
+{
+    assert(topNodes.size() <= 2);
     bool new_root_type = is_testnet() || h.value() >= NEWMERKLEROOT;
     bool block_v2 = is_testnet() || h.value() >= NEWBLOCKSTRUCUTREHEIGHT;
+
+    // the seed bytes at the beginning of the body are
+    // included in the topmost merkle node
+    HasherSHA256 hasher {};
+    for (auto& node : topNodes)
+        hasher.write(node.data(), 32);
     if (new_root_type) {
-        do {
-            to->resize((from->size() + 1) / 2);
-            size_t j = 0;
-            for (size_t i = 0; i < (from->size() + 1) / 2; ++i) {
-                HasherSHA256 hasher {};
-                hasher.write((*from)[j].data(), 32);
-                if (j + 1 < from->size()) {
-                    hasher.write((*from)[j + 1].data(), 32);
-                }
-
-                if (to->size() == 1)
-                    hasher.write(data(), block_v2 ? 10 : 4);
-                (*to)[i] = std::move(hasher);
-                j += 2;
-            }
-            std::swap(from, to);
-        } while (from->size() > 1);
-        return from->front();
+        hasher.write(seed, block_v2 ? 10 : 4);
+        return hasher;
     } else {
-        bool includedSeed = false;
-        bool finish = false;
-        do {
-            to->resize((from->size() + 1) / 2);
-            if (from->size() <= 2 && !includedSeed) {
-
-                HasherSHA256 hasher {};
-                hasher.write((*from)[0].data(), 32);
-                if (1 < from->size()) {
-                    hasher.write((*from)[1].data(), 32);
-                }
-                hasher.write(data(), 4);
-                includedSeed = true;
-                (*to)[0] = std::move(hasher);
-            } else {
-                if (from->size() == 1)
-                    finish = true;
-                size_t j = 0;
-                for (size_t i = 0; i < (from->size() + 1) / 2; ++i) {
-                    HasherSHA256 hasher {};
-                    hasher.write((*from)[j].data(), 32);
-                    if (j + 1 < from->size()) {
-                        hasher.write((*from)[j + 1].data(), 32);
-                    }
-                    (*to)[i] = std::move(hasher);
-                    j += 2;
-                }
-            }
-            std::swap(from, to);
-        } while (!finish);
-        return from->front();
+        hasher.write(seed, 4);
+        Hash seeded { std::move(hasher) };
+        return hashSHA256(seeded); // old root type hashes once more
     }
 }
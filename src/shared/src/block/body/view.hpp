@@ -94,7 +94,11 @@ public:
     BodyView(std::span<const uint8_t>, NonzeroHeight h);
     std::vector<Hash> merkle_leaves() const;
     Hash merkle_root(Height h) const;
+    // root from the at most two topmost merkle nodes and the body seed bytes
+    static Hash seeded_merkle_root(std::span<const Hash> topNodes, const uint8_t* seed, Height h);
     std::vector<uint8_t> merkle_prefix() const;
+    // at most two topmost merkle nodes, they do not depend on the seed bytes
+    std::vector<Hash> merkle_top() const;
     bool valid() const { return isValid; }
     size_t size() const { return s.size(); }
     const uint8_t* data() const { return s.data(); }
@@ -103,14 +107,12 @@ public:
     auto transfers() const { return Transfers { *this }; }
     auto addresses() const { return Addresses { *this }; }
     size_t getNAddresses() const { return nAddresses; };
+    size_t getNTransfers() const { return nTransfers; };
     TransferView get_transfer(size_t i) const;
     RewardView reward() const;
     Funds fee_sum_assert() const;
     AddressView get_address(size_t i) const;
 
-private:
-    size_t getNTransfers() const { return nTransfers; };
-
 private:
     std::span<const uint8_t> s;
     size_t nAddresses;
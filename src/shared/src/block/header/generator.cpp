@@ -19,9 +19,16 @@ uint32_t header_version(NonzeroHeight h)
 HeaderGenerator::HeaderGenerator(std::array<uint8_t, 32> prevhash,
     const BodyView& bv, Target target,
     uint32_t timestamp, NonzeroHeight height)
+    : HeaderGenerator(prevhash, bv.merkle_root(height), target, timestamp, height)
+{
+}
+
+HeaderGenerator::HeaderGenerator(std::array<uint8_t, 32> prevhash,
+    const Hash& merkleroot, Target target,
+    uint32_t timestamp, NonzeroHeight height)
     : version(target.is_janushash() ? header_version(height) : 1)
     , prevhash(prevhash)
-    , merkleroot(bv.merkle_root(height))
+    , merkleroot(merkleroot)
     , timestamp(timestamp)
     , target(target)
     , nonce(0u) {
@@ -6,11 +6,15 @@
 #include <array>
 #include <cstdint>
 class BodyView;
+class Hash;
 class HeaderGenerator {
 public:
     HeaderGenerator(std::array<uint8_t, 32> prevhash, const BodyView& bv,
         Target target,
         uint32_t timestamp, NonzeroHeight height);
+    HeaderGenerator(std::array<uint8_t, 32> prevhash, const Hash& merkleroot,
+        Target target,
+        uint32_t timestamp, NonzeroHeight height);
     // member elements
     int32_t version = 1; // 4 bytes
     std::array<uint8_t, 32> prevhash; // 32 bytes
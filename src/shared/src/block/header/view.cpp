@@ -42,7 +42,7 @@ inline bool operator<(const CustomFloat& hashproduct, TargetV2 t)
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus6>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus6>(const Hash& h) const
 {
     auto verusFloat { CustomFloat(verus2_1_hash()) };
     auto sha256tFloat { CustomFloat(hashSHA256(h)) };
@@ -52,54 +52,52 @@ bool HeaderView::validPOW<POWVersion::Janus6>(const Hash& h) const
     }
     constexpr auto factor { CustomFloat(0, 3006477107) };
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
-    return hashProduct < target_v2();
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus7>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus7>(const Hash& h) const
 {
     auto verusFloat { CustomFloat(verus2_1_hash()) };
     auto sha256tFloat { CustomFloat(hashSHA256(h)) };
     {
         constexpr auto c = CustomFloat(-7, 2748779069); // 0.005
         if (sha256tFloat < c) {
-            return false;
+            return {};
         }
     }
     constexpr auto factor { CustomFloat(0, 3006477107) };
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
-    return hashProduct < target_v2();
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Original>(const Hash& h) const
-{
-    return target_v1().compatible(h);
-}
-
-template <>
-bool HeaderView::validPOW<POWVersion::Janus1>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus1>(const Hash& h) const
 {
     auto verusHash { verus2_1_hash() };
     auto verusFloat { CustomFloat(verusHash) };
     auto sha256tFloat { CustomFloat(hashSHA256(h)) };
     auto hashProduct { verusFloat * sha256tFloat };
-    return verusHash[0] == 0 && (hashProduct < target_v2());
+    if (verusHash[0] != 0)
+        return {};
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus2>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus2>(const Hash& h) const
 {
     auto verusHash { verus2_1_hash() };
     auto verusFloat { CustomFloat(verusHash) };
     auto sha256tFloat { CustomFloat(hashSHA256(h)) };
     constexpr auto factor { CustomFloat(0, 3006477107) }; // = 0.7 <-- this can be decreased if necessary
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
-    return verusHash[0] == 0 && (hashProduct < target_v2());
+    if (verusHash[0] != 0)
+        return {};
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus3>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus3>(const Hash& h) const
 {
     auto verusHash { verus2_1_hash() };
     auto verusFloat { CustomFloat(verusHash) };
@@ -108,13 +106,15 @@ bool HeaderView::validPOW<POWVersion::Janus3>(const Hash& h) const
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
     if (!(verusHash < CustomFloat(-30, 3496838790))) {
         // reject verushash with log_e not less than -21
-        return false;
+        return {};
     }
-    return verusHash[0] == 0 && (hashProduct < target_v2());
+    if (verusHash[0] != 0)
+        return {};
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus4>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus4>(const Hash& h) const
 {
     auto verusHash { verus2_1_hash() };
     auto verusFloat { CustomFloat(verusHash) };
@@ -123,13 +123,15 @@ bool HeaderView::validPOW<POWVersion::Janus4>(const Hash& h) const
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
     if (!(verusHash < CustomFloat(-33, 3785965345))) {
         // reject verushash with log_e not less than -23
-        return false;
+        return {};
     }
-    return verusHash[0] == 0 && (hashProduct < target_v2());
+    if (verusHash[0] != 0)
+        return {};
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus5>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus5>(const Hash& h) const
 {
     auto verusHash { verus2_1_hash() };
     auto verusFloat { CustomFloat(verusHash) };
@@ -138,34 +140,63 @@ bool HeaderView::validPOW<POWVersion::Janus5>(const Hash& h) const
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
     if (!(verusHash < CustomFloat(-33, 3785965345))) {
         // reject verushash with log_e less than -23
-        return false;
+        return {};
     }
     constexpr auto c = CustomFloat(-9, 3306097748); // CustomFloat::from_double(0.0015034391929775724)
     if (sha256tFloat < c)
-        return false;
-    return verusHash[0] == 0 && (hashProduct < target_v2());
+        return {};
+    if (verusHash[0] != 0)
+        return {};
+    return hashProduct;
 }
 
 template <>
-bool HeaderView::validPOW<POWVersion::Janus8>(const Hash& h) const
+std::optional<CustomFloat> HeaderView::hash_product<POWVersion::Janus8>(const Hash& h) const
 {
     auto verusFloat { CustomFloat(verus2_2_hash()) };
     auto sha256tFloat { CustomFloat(hashSHA256(h)) };
     {
         constexpr auto c = CustomFloat(-7, 2748779069); // 0.005
         if (sha256tFloat < c) {
-            return false;
+            return {};
         }
     }
     constexpr auto factor { CustomFloat(0, 3006477107) };
     auto hashProduct { verusFloat * pow(sha256tFloat, factor) };
-    return hashProduct < target_v2();
+    return hashProduct;
 }
 
 bool HeaderView::validPOW(const Hash& h, POWVersion version) const
 {
-    return version.visit([this, &h](auto version) -> bool {
-        return validPOW<std::remove_cv_t<decltype(version)>>(h);
+    return validPOW(h, version, target_v2());
+}
+
+bool HeaderView::validPOW(const Hash& h, POWVersion version, TargetV2 target) const
+{
+    return version.visit([this, &h, target](auto version) -> bool {
+        using T = std::remove_cv_t<decltype(version)>;
+        if constexpr (std::is_same_v<T, POWVersion::Original>) {
+            return target_v1().compatible(h);
+        } else {
+            auto hashProduct { hash_product<T>(h) };
+            return hashProduct && *hashProduct < target;
+        }
+    });
+}
+
+auto HeaderView::validPOW_share(const Hash& h, POWVersion version, TargetV2 shareTarget) const -> ShareCheck
+{
+    return version.visit([this, &h, shareTarget](auto version) -> ShareCheck {
+        using T = std::remove_cv_t<decltype(version)>;
+        if constexpr (std::is_same_v<T, POWVersion::Original>) {
+            bool valid { target_v1().compatible(h) };
+            return { .share = valid, .block = valid };
+        } else {
+            auto hashProduct { hash_product<T>(h) };
+            if (!hashProduct)
+                return {};
+            return { .share = *hashProduct < shareTarget, .block = *hashProduct < target_v2() };
+        }
     });
 }
 
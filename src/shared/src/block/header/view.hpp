@@ -8,6 +8,7 @@
 #include <optional>
 class HeaderGenerator;
 class HashView;
+class CustomFloat;
 class TargetV1;
 class TargetV2;
 class Target;
@@ -33,6 +34,16 @@ public:
     inline Target target(NonzeroHeight h, bool testnet) const;
 
     bool validPOW(const Hash& h, POWVersion v) const;
+    // Janus proof of work against another target, e.g. a pool share
+    // target, the original version always uses the header target
+    bool validPOW(const Hash& h, POWVersion v, TargetV2 target) const;
+    // pool share target and header target checked with one hash
+    // computation, the original version only knows the header target
+    struct ShareCheck {
+        bool share { false };
+        bool block { false };
+    };
+    ShareCheck validPOW_share(const Hash& h, POWVersion v, TargetV2 shareTarget) const;
 
     double janus_number() const;
     Hash verus2_1_hash() const;
@@ -60,8 +71,9 @@ public:
     };
 
 private:
+    // hash product of the Janus versions, empty if rejected for any target
     template <typename T>
-    bool validPOW(const Hash& h) const;
+    std::optional<CustomFloat> hash_product(const Hash& h) const;
 
 private:
     TargetV1 target_v1() const;
@@ -0,0 +1,391 @@
+#include "sha256_batch.hpp"
+#include "general/byte_order.hpp"
+#include "sha2.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA256_BATCH_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+static_assert(sizeof(Hash) == 32);
+
+namespace sha256 {
+namespace {
+constexpr uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+alignas(16) constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t load_be32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return ntoh32(v);
+}
+inline void store_be32(uint8_t* p, uint32_t v)
+{
+    v = hton32(v);
+    memcpy(p, &v, 4);
+}
+inline void store_be64(uint8_t* p, uint64_t v)
+{
+    v = hton64(v);
+    memcpy(p, &v, 8);
+}
+
+// writes the padded last one or two blocks of a message, returns their length
+inline size_t pad_tail(uint8_t tail[128], const uint8_t* data, size_t len)
+{
+    const size_t rem { len % 64 };
+    const size_t tailLen { rem + 9 > 64 ? size_t(128) : size_t(64) };
+    memcpy(tail, data + len - rem, rem);
+    tail[rem] = 0x80;
+    memset(tail + rem + 1, 0, tailLen - rem - 1 - 8);
+    store_be64(tail + tailLen - 8, uint64_t(len) * 8);
+    return tailLen;
+}
+}
+
+#ifdef SHA256_BATCH_X86
+////////////////////////////
+// SSE4.1, 4 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+namespace sse41 {
+namespace {
+struct V {
+    using T = __m128i;
+    static constexpr size_t lanes = 4;
+    static T set1(uint32_t v) { return _mm_set1_epi32(v); }
+    static T load(const uint32_t* p) { return _mm_load_si128((const __m128i*)p); }
+    static void store(uint32_t* p, T v) { _mm_store_si128((__m128i*)p, v); }
+    static T add(T a, T b) { return _mm_add_epi32(a, b); }
+    static T xor_(T a, T b) { return _mm_xor_si128(a, b); }
+    static T and_(T a, T b) { return _mm_and_si128(a, b); }
+    static T or_(T a, T b) { return _mm_or_si128(a, b); }
+    static T andnot(T a, T b) { return _mm_andnot_si128(a, b); }
+    static T shr(T a, int n) { return _mm_srli_epi32(a, n); }
+    static T shl(T a, int n) { return _mm_slli_epi32(a, n); }
+    static T rotr(T a, int n) { return or_(shr(a, n), shl(a, 32 - n)); }
+};
+#include "sha256_batch_lanes.hpp"
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+////////////////////////////
+// AVX2, 8 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+namespace {
+struct V {
+    using T = __m256i;
+    static constexpr size_t lanes = 8;
+    static T set1(uint32_t v) { return _mm256_set1_epi32(v); }
+    static T load(const uint32_t* p) { return _mm256_load_si256((const __m256i*)p); }
+    static void store(uint32_t* p, T v) { _mm256_store_si256((__m256i*)p, v); }
+    static T add(T a, T b) { return _mm256_add_epi32(a, b); }
+    static T xor_(T a, T b) { return _mm256_xor_si256(a, b); }
+    static T and_(T a, T b) { return _mm256_and_si256(a, b); }
+    static T or_(T a, T b) { return _mm256_or_si256(a, b); }
+    static T andnot(T a, T b) { return _mm256_andnot_si256(a, b); }
+    static T shr(T a, int n) { return _mm256_srli_epi32(a, n); }
+    static T shl(T a, int n) { return _mm256_slli_epi32(a, n); }
+    static T rotr(T a, int n) { return or_(shr(a, n), shl(a, 32 - n)); }
+};
+#include "sha256_batch_lanes.hpp"
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+////////////////////////////
+// AVX-512, 16 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized" // false positives in GCC 12 headers
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace avx512 {
+namespace {
+struct V {
+    using T = __m512i;
+    static constexpr size_t lanes = 16;
+    static T set1(uint32_t v) { return _mm512_set1_epi32(v); }
+    static T load(const uint32_t* p) { return _mm512_load_si512((const void*)p); }
+    static void store(uint32_t* p, T v) { _mm512_store_si512((void*)p, v); }
+    static T add(T a, T b) { return _mm512_add_epi32(a, b); }
+    static T xor_(T a, T b) { return _mm512_xor_si512(a, b); }
+    static T and_(T a, T b) { return _mm512_and_si512(a, b); }
+    static T or_(T a, T b) { return _mm512_or_si512(a, b); }
+    static T andnot(T a, T b) { return _mm512_andnot_si512(a, b); }
+    static T shr(T a, int n) { return _mm512_srli_epi32(a, n); }
+    static T shl(T a, int n) { return _mm512_slli_epi32(a, n); }
+    static T rotr(T a, int n)
+    {
+        // _mm512_ror_epi32 needs an immediate
+        switch (n) {
+        case 2:
+            return _mm512_ror_epi32(a, 2);
+        case 6:
+            return _mm512_ror_epi32(a, 6);
+        case 7:
+            return _mm512_ror_epi32(a, 7);
+        case 11:
+            return _mm512_ror_epi32(a, 11);
+        case 13:
+            return _mm512_ror_epi32(a, 13);
+        case 17:
+            return _mm512_ror_epi32(a, 17);
+        case 18:
+            return _mm512_ror_epi32(a, 18);
+        case 19:
+            return _mm512_ror_epi32(a, 19);
+        case 22:
+            return _mm512_ror_epi32(a, 22);
+        case 25:
+            return _mm512_ror_epi32(a, 25);
+        default:
+            return or_(shr(a, n), shl(a, 32 - n));
+        }
+    }
+};
+#include "sha256_batch_lanes.hpp"
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+////////////////////////////
+// SHA-NI, one message at a time
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sha,sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sha,sse4.1")
+#endif
+namespace shani {
+namespace {
+void compress(uint32_t state[8], const uint8_t* data, size_t blocks)
+{
+    const __m128i MASK { _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL) };
+
+    __m128i tmp { _mm_loadu_si128((const __m128i*)&state[0]) };
+    __m128i state1 { _mm_loadu_si128((const __m128i*)&state[4]) };
+    tmp = _mm_shuffle_epi32(tmp, 0xB1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B); // EFGH
+    __m128i state0 { _mm_alignr_epi8(tmp, state1, 8) }; // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    for (; blocks > 0; --blocks, data += 64) {
+        const __m128i abefSave { state0 };
+        const __m128i cdghSave { state1 };
+        __m128i m[4];
+        for (size_t i = 0; i < 16; ++i) {
+            __m128i& cur { m[i & 3] };
+            if (i < 4) {
+                cur = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), MASK);
+            } else {
+                const __m128i& prev1 { m[(i + 3) & 3] };
+                const __m128i& prev2 { m[(i + 2) & 3] };
+                cur = _mm_sha256msg1_epu32(cur, m[(i + 1) & 3]);
+                cur = _mm_add_epi32(cur, _mm_alignr_epi8(prev1, prev2, 4));
+                cur = _mm_sha256msg2_epu32(cur, prev1);
+            }
+            __m128i msg { _mm_add_epi32(cur, _mm_load_si128((const __m128i*)(K + 4 * i))) };
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+        }
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // ABEF
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+void hash(const uint8_t* data, size_t len, uint8_t* out)
+{
+    uint32_t state[8];
+    memcpy(state, IV, sizeof(state));
+    compress(state, data, len / 64);
+    alignas(16) uint8_t tail[128];
+    auto tailLen { pad_tail(tail, data, len) };
+    compress(state, tail, tailLen / 64);
+    for (size_t i = 0; i < 8; ++i)
+        store_be32(out + 4 * i, state[i]);
+}
+}
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+namespace {
+bool has_sha_extension()
+{
+    unsigned a, b, c, d;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d))
+        return false;
+    return (b & (1u << 29)) != 0;
+}
+}
+#endif // SHA256_BATCH_X86
+
+bool supported(Impl impl)
+{
+#ifdef SHA256_BATCH_X86
+    __builtin_cpu_init();
+    switch (impl) {
+    case Impl::Scalar:
+        return true;
+    case Impl::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case Impl::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case Impl::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2");
+    case Impl::SHANI:
+        return __builtin_cpu_supports("sse4.1") && has_sha_extension();
+    }
+    return false;
+#else
+    return impl == Impl::Scalar;
+#endif
+}
+
+Impl detected_impl()
+{
+    static const Impl best {
+        []() {
+            // 16 lanes outperform the dedicated SHA instructions
+            for (auto i : { Impl::AVX512, Impl::SHANI, Impl::AVX2, Impl::SSE41 }) {
+                if (supported(i))
+                    return i;
+            }
+            return Impl::Scalar;
+        }()
+    };
+    return best;
+}
+
+const char* impl_name(Impl impl)
+{
+    switch (impl) {
+    case Impl::Scalar:
+        return "scalar";
+    case Impl::SSE41:
+        return "SSE4.1 (4 lanes)";
+    case Impl::AVX2:
+        return "AVX2 (8 lanes)";
+    case Impl::AVX512:
+        return "AVX-512 (16 lanes)";
+    case Impl::SHANI:
+        return "SHA-NI";
+    }
+    return "unknown";
+}
+
+namespace {
+void hash_single(const uint8_t* data, size_t len, uint8_t* out)
+{
+#ifdef SHA256_BATCH_X86
+    static const bool shaExtension { supported(Impl::SHANI) };
+    if (shaExtension) {
+        shani::hash(data, len, out);
+        return;
+    }
+#endif
+    sha256_Raw(data, len, out);
+}
+}
+
+void hash_batch(Impl impl, const uint8_t* in, size_t stride, size_t len, size_t n, Hash* out)
+{
+    size_t i { 0 };
+#ifdef SHA256_BATCH_X86
+    auto run_lanes { [&](auto hash_lanes, size_t lanes) {
+        for (; i + lanes <= n; i += lanes)
+            hash_lanes(in + i * stride, stride, len, out + i);
+    } };
+    switch (impl) {
+    case Impl::SHANI:
+        for (; i < n; ++i)
+            shani::hash(in + i * stride, len, out[i].data());
+        return;
+    case Impl::AVX512:
+        run_lanes(avx512::hash_lanes, 16);
+        [[fallthrough]];
+    case Impl::AVX2:
+        run_lanes(avx2::hash_lanes, 8);
+        [[fallthrough]];
+    case Impl::SSE41:
+        run_lanes(sse41::hash_lanes, 4);
+        break;
+    case Impl::Scalar:
+        for (; i < n; ++i)
+            sha256_Raw(in + i * stride, len, out[i].data());
+        return;
+    }
+#else
+    (void)impl;
+#endif
+    for (; i < n; ++i)
+        hash_single(in + i * stride, len, out[i].data());
+}
+
+void hash_batch(const uint8_t* in, size_t stride, size_t len, size_t n, Hash* out)
+{
+    hash_batch(detected_impl(), in, stride, len, n, out);
+}
+
+Hash hash(const uint8_t* data, size_t len)
+{
+    Hash res;
+    hash_single(data, len, res.data());
+    return res;
+}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "hash.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// SHA256 engine for many independent messages of equal length.
+// The implementation is selected at runtime based on the CPU features:
+// SHA-NI, AVX-512 (16 lanes), AVX2 (8 lanes), SSE4.1 (4 lanes) or the
+// portable scalar code.
+namespace sha256 {
+enum class Impl {
+    Scalar,
+    SSE41,
+    AVX2,
+    AVX512,
+    SHANI
+};
+
+[[nodiscard]] bool supported(Impl);
+[[nodiscard]] Impl detected_impl();
+[[nodiscard]] const char* impl_name(Impl);
+
+// Hashes n messages of length len, message i starts at in + i * stride
+// and its hash is written to out[i]. The output may overlap the input
+// as long as out[i] does not lie behind message i (this allows in-place
+// reduction of merkle tree levels).
+void hash_batch(const uint8_t* in, size_t stride, size_t len, size_t n, Hash* out);
+void hash_batch(Impl, const uint8_t* in, size_t stride, size_t len, size_t n, Hash* out);
+
+// single message with the fastest available implementation
+[[nodiscard]] Hash hash(const uint8_t* data, size_t len);
+}
@@ -0,0 +1,87 @@
+// Multi-buffer SHA256 compression, generic over the vector type.
+//
+// This file has no include guard on purpose, it is included by
+// sha256_batch.cpp once per instruction set. Before inclusion a struct V
+// must be declared in the enclosing namespace providing
+//   T              vector type with V::lanes 32 bit lanes
+//   set1, load, store, add, xor_, and_, or_, andnot, shr, shl, rotr
+
+inline V::T Sigma0(V::T x) { return V::xor_(V::xor_(V::rotr(x, 2), V::rotr(x, 13)), V::rotr(x, 22)); }
+inline V::T Sigma1(V::T x) { return V::xor_(V::xor_(V::rotr(x, 6), V::rotr(x, 11)), V::rotr(x, 25)); }
+inline V::T sigma0(V::T x) { return V::xor_(V::xor_(V::rotr(x, 7), V::rotr(x, 18)), V::shr(x, 3)); }
+inline V::T sigma1(V::T x) { return V::xor_(V::xor_(V::rotr(x, 17), V::rotr(x, 19)), V::shr(x, 10)); }
+inline V::T ch(V::T e, V::T f, V::T g) { return V::xor_(V::and_(e, f), V::andnot(e, g)); }
+inline V::T maj(V::T a, V::T b, V::T c) { return V::or_(V::and_(a, b), V::and_(c, V::or_(a, b))); }
+
+// compresses one 64 byte block per lane into the state
+inline void compress(V::T s[8], const uint8_t* const blocks[V::lanes])
+{
+    using T = V::T;
+    T w[16];
+    for (size_t t = 0; t < 16; ++t) {
+        alignas(64) uint32_t tmp[V::lanes];
+        for (size_t l = 0; l < V::lanes; ++l)
+            tmp[l] = load_be32(blocks[l] + 4 * t);
+        w[t] = V::load(tmp);
+    }
+
+    T a { s[0] }, b { s[1] }, c { s[2] }, d { s[3] }, e { s[4] }, f { s[5] }, g { s[6] }, h { s[7] };
+    for (size_t i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            w[i & 15] = V::add(V::add(w[i & 15], sigma0(w[(i + 1) & 15])),
+                V::add(w[(i + 9) & 15], sigma1(w[(i + 14) & 15])));
+        }
+        T t1 { V::add(V::add(V::add(h, Sigma1(e)), V::add(ch(e, f, g), V::set1(K[i]))), w[i & 15]) };
+        T t2 { V::add(Sigma0(a), maj(a, b, c)) };
+        h = g;
+        g = f;
+        f = e;
+        e = V::add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = V::add(t1, t2);
+    }
+    s[0] = V::add(s[0], a);
+    s[1] = V::add(s[1], b);
+    s[2] = V::add(s[2], c);
+    s[3] = V::add(s[3], d);
+    s[4] = V::add(s[4], e);
+    s[5] = V::add(s[5], f);
+    s[6] = V::add(s[6], g);
+    s[7] = V::add(s[7], h);
+}
+
+// hashes exactly V::lanes messages, all input is read before output is written
+inline void hash_lanes(const uint8_t* in, size_t stride, size_t len, Hash* out)
+{
+    V::T s[8];
+    for (size_t i = 0; i < 8; ++i)
+        s[i] = V::set1(IV[i]);
+
+    const uint8_t* blocks[V::lanes];
+    const size_t nFull { len / 64 };
+    for (size_t b = 0; b < nFull; ++b) {
+        for (size_t l = 0; l < V::lanes; ++l)
+            blocks[l] = in + l * stride + b * 64;
+        compress(s, blocks);
+    }
+
+    // padding
+    alignas(64) uint8_t tail[V::lanes][128];
+    size_t tailLen { 0 };
+    for (size_t l = 0; l < V::lanes; ++l)
+        tailLen = pad_tail(tail[l], in + l * stride, len);
+    for (size_t b = 0; b < tailLen / 64; ++b) {
+        for (size_t l = 0; l < V::lanes; ++l)
+            blocks[l] = tail[l] + b * 64;
+        compress(s, blocks);
+    }
+
+    for (size_t i = 0; i < 8; ++i) {
+        alignas(64) uint32_t tmp[V::lanes];
+        V::store(tmp, s[i]);
+        for (size_t l = 0; l < V::lanes; ++l)
+            store_be32(out[l].data() + 4 * i, tmp[l]);
+    }
+}
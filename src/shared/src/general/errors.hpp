@@ -113,6 +113,8 @@
     XX(207, ECONNRATELIMIT, "connection rate limit exceeded")           \
     XX(208, EFROZENACC, "account is frozen and can't send")             \
     XX(209, EMINFEE, "transaction fee below threshold")                 \
+    XX(210, EINDEXING, "indexing in progress")                          \
+    XX(211, ECHAINBUSY, "chain state busy, try again")                  \
     XX(1000, ESIGTERM, "received SIGTERM")                              \
     XX(1001, ESIGHUP, "received SIGHUP")                                \
     XX(1002, ESIGINT, "received SIGINT")                                \
@@ -0,0 +1,95 @@
+// the checks below must also run in release builds
+#undef NDEBUG
+#include "db/block_store.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+vector<uint8_t> bytes(size_t n, uint8_t seed)
+{
+    vector<uint8_t> res(n);
+    for (size_t i = 0; i < n; ++i)
+        res[i] = uint8_t(seed + i * 7);
+    return res;
+}
+
+bool equals(const BlockStore::View& v, const vector<uint8_t>& b)
+{
+    return v.size() == b.size() && memcmp(v.span().data(), b.data(), b.size()) == 0;
+}
+
+void test_rollback_within_segment()
+{
+    BlockStore bs("");
+    bs.set_write_position(0, 0);
+    auto a { bytes(100, 1) };
+    auto la { bs.append(a) };
+    auto sp { bs.savepoint() };
+    auto lb { bs.append(bytes(50, 2)) };
+    bs.rollback_to(sp);
+    auto c { bytes(30, 3) };
+    auto lc { bs.append(c) };
+    assert(lc.segment == lb.segment && lc.offset == lb.offset);
+    assert(equals(bs.read(la), a));
+    assert(equals(bs.read(lc), c));
+}
+
+void test_rollback_across_segments()
+{
+    BlockStore bs("");
+    const int64_t nearEnd { int64_t(BlockStore::SEGMENTSIZE) - 10 };
+    bs.set_write_position(0, nearEnd - 100);
+    auto a { bytes(100, 4) };
+    auto la { bs.append(a) };
+    assert(la.segment == 0);
+
+    // the second append does not fit and opens segment 1, the third
+    // fills segment 1 and opens segment 2
+    auto sp { bs.savepoint() };
+    auto lb { bs.append(bytes(20, 5)) };
+    assert(lb.segment == 1 && lb.offset == 0);
+    auto b { bytes(BlockStore::SEGMENTSIZE - 10, 6) };
+    auto view { bs.read(lb) };
+    auto lc { bs.append(b) };
+    assert(lc.segment == 2);
+    assert((bs.segments() == vector<int64_t> { 0, 1, 2 }));
+
+    bs.rollback_to(sp);
+    assert(bs.write_segment() == 0);
+    assert((bs.segments() == vector<int64_t> { 0 }));
+    // views keep their mapping alive after the segment is removed
+    assert(view.size() == 20);
+    assert(equals(bs.read(la), a));
+
+    // writing continues where the savepoint was taken
+    auto d { bytes(10, 7) };
+    auto ld { bs.append(d) };
+    assert(ld.segment == 0 && ld.offset == nearEnd);
+    assert(equals(bs.read(ld), d));
+    auto le { bs.append(bytes(1, 8)) };
+    assert(le.segment == 1 && le.offset == 0);
+    assert((bs.segments() == vector<int64_t> { 0, 1 }));
+}
+
+void test_rollback_discards_removals()
+{
+    BlockStore bs("");
+    bs.set_write_position(0, 0);
+    (void)bs.append(bytes(10, 9));
+    bs.set_write_position(1, 0);
+    auto sp { bs.savepoint() };
+    bs.remove_after_commit(0);
+    bs.rollback_to(sp);
+    bs.on_commit();
+    assert((bs.segments() == vector<int64_t> { 0, 1 }));
+}
+
+int main()
+{
+    test_rollback_within_segment();
+    test_rollback_across_segments();
+    test_rollback_discards_removals();
+    cout << "block store tests passed" << endl;
+}
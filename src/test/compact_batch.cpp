@@ -0,0 +1,88 @@
+// the checks below must also run in release builds
+#undef NDEBUG
+#include "block/header/compact_batch.hpp"
+#include "block/header/view_inline.hpp"
+#include "crypto/hash.hpp"
+#include "general/byte_order.hpp"
+#include "general/reader.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace std;
+
+struct Fields {
+    uint32_t target;
+    uint32_t version;
+    uint32_t timestamp;
+};
+
+// builds a linked batch, prevhash is the hash of the previous header
+Batch batch_of(const vector<Fields>& fields, mt19937_64& rng)
+{
+    vector<uint8_t> bytes(fields.size() * HeaderView::bytesize);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        uint8_t* h { bytes.data() + i * HeaderView::bytesize };
+        for (size_t j = 0; j < HeaderView::bytesize; ++j)
+            h[j] = uint8_t(rng());
+        if (i > 0) {
+            auto prevhash { HeaderView(h - HeaderView::bytesize).hash() };
+            memcpy(h + HeaderView::offset_prevhash, prevhash.data(), 32);
+        }
+        auto put = [&](size_t offset, uint32_t v) {
+            v = hton32(v);
+            memcpy(h + offset, &v, 4);
+        };
+        put(HeaderView::offset_target, fields[i].target);
+        put(HeaderView::offset_version, fields[i].version);
+        put(HeaderView::offset_timestamp, fields[i].timestamp);
+    }
+    return Batch(std::move(bytes));
+}
+
+size_t round_trip(const Batch& b)
+{
+    auto encoded { encode_compact(b) };
+    Reader r(encoded);
+    auto decoded { decode_compact(r) };
+    assert(decoded == b);
+    return encoded.size();
+}
+
+int main()
+{
+    mt19937_64 rng { 42 };
+
+    // empty batch
+    assert(round_trip(Batch()) == 0);
+
+    // a single header is sent in full
+    assert(round_trip(batch_of({ { 0x1d00ffff, 3, 1700000000 } }, rng)) == HeaderView::bytesize);
+
+    // a batch spanning target changes, a version change, a timestamp jump
+    // too large for two bytes and a timestamp going backwards
+    vector<Fields> fields;
+    uint32_t t { 1700000000 };
+    for (uint32_t i = 0; i < 500; ++i) {
+        const uint32_t target { i < 200 ? 0x1d00ffffu : (i < 420 ? 0x1c7fffffu : 0x1c3fffffu) };
+        const uint32_t version { i < 300 ? 3u : 4u };
+        if (i == 250)
+            t += 0x20000;
+        else if (i == 260)
+            t -= 5;
+        else
+            t += uint32_t(rng() % 40);
+        fields.push_back({ target, version, t });
+    }
+    auto b { batch_of(fields, rng) };
+    auto size { round_trip(b) };
+    assert(size < b.raw().size());
+
+    // every header carries its own target
+    for (auto& f : fields)
+        f.target = uint32_t(rng());
+    round_trip(batch_of(fields, rng));
+
+    cout << "compact batch tests passed" << endl;
+}
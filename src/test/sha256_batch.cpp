@@ -0,0 +1,57 @@
+#include "crypto/sha256_batch.hpp"
+#include "sha2.hpp"
+#include <cassert>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+Hash reference(const uint8_t* data, size_t len)
+{
+    Hash h;
+    sha256_Raw(data, len, h.data());
+    return h;
+}
+
+void check_impl(sha256::Impl impl)
+{
+    // message lengths around the padding boundaries plus the lengths used
+    // for merkle leaves (20, 16, 99) and merkle nodes (64)
+    for (size_t len : { 0, 1, 16, 20, 55, 56, 63, 64, 65, 99, 119, 120, 128, 300 }) {
+        for (size_t n : { 1, 3, 4, 7, 8, 15, 16, 17, 33, 100 }) {
+            const size_t stride { len + 3 };
+            vector<uint8_t> in(stride * n);
+            for (size_t i = 0; i < in.size(); ++i)
+                in[i] = uint8_t(i * 131 + len);
+            vector<Hash> out(n);
+            sha256::hash_batch(impl, in.data(), stride, len, n, out.data());
+            for (size_t i = 0; i < n; ++i)
+                assert(out[i] == reference(in.data() + i * stride, len));
+        }
+    }
+
+    // in-place reduction of a merkle level
+    vector<Hash> level(37);
+    for (size_t i = 0; i < level.size(); ++i)
+        level[i] = reference((const uint8_t*)&i, sizeof(i));
+    vector<Hash> expected(level.size() / 2);
+    for (size_t i = 0; i < expected.size(); ++i)
+        expected[i] = reference(level[2 * i].data(), 64);
+    sha256::hash_batch(impl, level[0].data(), 64, 64, expected.size(), level.data());
+    for (size_t i = 0; i < expected.size(); ++i)
+        assert(level[i] == expected[i]);
+}
+
+int main()
+{
+    using sha256::Impl;
+    for (auto impl : { Impl::Scalar, Impl::SSE41, Impl::AVX2, Impl::AVX512, Impl::SHANI }) {
+        if (!sha256::supported(impl)) {
+            cout << "Skipping " << sha256::impl_name(impl) << " (not supported)" << endl;
+            continue;
+        }
+        check_impl(impl);
+        cout << "Checked " << sha256::impl_name(impl) << endl;
+    }
+    const uint8_t abc[] = { 'a', 'b', 'c' };
+    assert(sha256::hash(abc, 3) == reference(abc, 3));
+}
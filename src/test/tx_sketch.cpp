@@ -0,0 +1,130 @@
+// the checks below must also run in release builds
+#undef NDEBUG
+#include "general/reader.hpp"
+#include "general/writer.hpp"
+#include "mempool/tx_sketch.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+using namespace std;
+using mempool::TxSketch;
+
+struct RawCell {
+    uint32_t count;
+    uint64_t keySum;
+    uint32_t checkSum;
+};
+
+vector<RawCell> cells_of(const TxSketch& s)
+{
+    vector<uint8_t> bytes(s.serialized_size());
+    Writer w(bytes);
+    w << s;
+    Reader r(bytes);
+    vector<RawCell> res(r.uint16());
+    for (auto& c : res) {
+        c.count = r.uint32();
+        c.keySum = r.uint64();
+        c.checkSum = r.uint32();
+    }
+    return res;
+}
+
+TxSketch sketch_of(const vector<RawCell>& cells)
+{
+    vector<uint8_t> bytes(2 + cells.size() * TxSketch::CELLSIZE);
+    Writer w(bytes);
+    w << uint16_t(cells.size());
+    for (auto& c : cells)
+        w << c.count << c.keySum << c.checkSum;
+    Reader r(bytes);
+    return TxSketch(r);
+}
+
+bool round_trip(size_t common, size_t onlyOurs, size_t onlyTheirs, mt19937_64& rng)
+{
+    vector<uint64_t> ours, theirs;
+    TxSketch a(3 * (onlyOurs + onlyTheirs)), b(3 * (onlyOurs + onlyTheirs));
+    for (size_t i = 0; i < common; ++i) {
+        auto k { rng() };
+        a.insert(k);
+        b.insert(k);
+    }
+    for (size_t i = 0; i < onlyOurs; ++i)
+        a.insert(ours.emplace_back(rng()));
+    for (size_t i = 0; i < onlyTheirs; ++i)
+        b.insert(theirs.emplace_back(rng()));
+
+    // the subtrahend arrives serialized
+    a.subtract(sketch_of(cells_of(b)));
+    auto d { a.decode() };
+    if (!d)
+        return false;
+    sort(ours.begin(), ours.end());
+    sort(theirs.begin(), theirs.end());
+    sort(d->ours.begin(), d->ours.end());
+    sort(d->theirs.begin(), d->theirs.end());
+    assert(d->ours == ours);
+    assert(d->theirs == theirs);
+    return true;
+}
+
+void test_overfull(mt19937_64& rng)
+{
+    TxSketch s(TxSketch::MINCELLS);
+    for (size_t i = 0; i < 10 * TxSketch::MINCELLS; ++i)
+        s.insert(rng());
+    assert(!s.decode());
+}
+
+void test_crafted()
+{
+    const uint64_t key { 0x0123456789abcdefull };
+    TxSketch s(TxSketch::MINCELLS);
+    s.insert(key);
+    auto cells { cells_of(s) };
+    vector<size_t> positions;
+    for (size_t i = 0; i < cells.size(); ++i)
+        if (cells[i].count != 0)
+            positions.push_back(i);
+    assert(positions.size() == TxSketch::HASHES);
+    const auto filled { cells[positions[0]] };
+
+    // only the first hash position holds the key with count -1,
+    // peeling it toggles the key back and forth between its cells
+    vector<RawCell> crafted(cells.size(), RawCell { 0, 0, 0 });
+    crafted[positions[0]] = filled;
+    crafted[positions[0]].count = uint32_t(-1);
+    assert(!sketch_of(crafted).decode());
+
+    // a pure looking cell at a position the key does not hash to
+    size_t foreign { 0 };
+    while (find(positions.begin(), positions.end(), foreign) != positions.end())
+        ++foreign;
+    crafted.assign(cells.size(), RawCell { 0, 0, 0 });
+    crafted[foreign] = filled;
+    assert(!sketch_of(crafted).decode());
+}
+
+int main()
+{
+    mt19937_64 rng { 42 };
+    bool ok { round_trip(0, 0, 0, rng) };
+    assert(ok);
+    ok = round_trip(1000, 1, 0, rng);
+    assert(ok);
+    ok = round_trip(1000, 0, 1, rng);
+    assert(ok);
+    // decoding small differences fails when two keys share all cells
+    size_t decoded { 0 };
+    for (size_t i = 0; i < 100; ++i)
+        decoded += round_trip(500, rng() % 20, rng() % 20, rng);
+    assert(decoded >= 90);
+    ok = round_trip(5000, 300, 200, rng);
+    assert(ok);
+    test_overfull(rng);
+    test_crafted();
+    cout << "tx sketch tests passed" << endl;
+}